@@ -36,6 +36,14 @@ class PlayerController:
         self.path_recalculation_interval = 5.0  # seconds
         self.last_path_calculation = 0
         
+        # Search running in the background for the current destination; the
+        # rover follows its partial path until the final one arrives
+        self.plan_ticket = None
+        
+        # Replan running on the planner thread; the rover keeps following
+        # its current path until it finishes
+        self.replan_ticket = None
+        
         # Pathfinding visualization
         self.visualize_pathfinding = True
         self.explored_cells = []
@@ -43,6 +51,11 @@ class PlayerController:
         self.last_visualization_time = 0
         self.visualization_in_progress = False
         
+        # Background chunk prefetching; requests are only reissued when the
+        # rover's chunk, heading octant or path changes
+        self.prefetch_lookahead_chunks = 3
+        self.prefetch_state = None
+        
     def get_position(self):
         """Get the current player position."""
         return self.position
@@ -108,8 +121,31 @@ class PlayerController:
             # Only update direction if actually moving
             self.direction = math.atan2(dy, dx)
         
+        self.prefetch_ahead((dx, dy))
+        
         return True
     
+    def prefetch_ahead(self, velocity):
+        """
+        Queue the chunks ahead of the rover for background generation.
+        
+        Args:
+            velocity (tuple): Current movement vector (dx, dy)
+        """
+        chunk_size = self.terrain.chunk_size
+        current_chunk = (int(self.position[0]) // chunk_size, int(self.position[1]) // chunk_size)
+        octant = int(round(math.atan2(velocity[1], velocity[0]) / (math.pi / 4))) % 8
+        following_path = self.autopilot_enabled and self.path is not None
+        
+        state = (current_chunk, octant, id(self.path) if following_path else None)
+        if state == self.prefetch_state:
+            return
+        self.prefetch_state = state
+        
+        waypoints = self.path[self.current_path_index + 1:] if following_path else ()
+        self.terrain.prefetch_route(self.position, velocity, waypoints,
+                                    lookahead_chunks=self.prefetch_lookahead_chunks)
+    
     def toggle_first_person_mode(self):
         """Toggle between first-person and top-down modes."""
         self.first_person_mode = not self.first_person_mode
@@ -233,13 +269,27 @@ class PlayerController:
             # Don't block the main thread with a sleep
             # time.sleep(0.005)
     
-    def calculate_path(self, optimize_for_elevation=True):
+    def calculate_path(self, optimize_for_elevation=True, mode=None, deadline_ms=None, epsilon=None):
         """
-        Calculate the path to the current destination.
+        Start calculating the path to the current destination.
+        
+        The search runs in the background and any search still running for
+        a previous destination is cancelled. update_autopilot follows the
+        best partial path while it runs and switches to the final path when
+        it arrives.
         
         Args:
             optimize_for_elevation (bool): Whether to optimize for minimal elevation changes
+            mode (str): Search mode, one of PathFinder.MODES (default: the
+                pathfinder's mode)
+            deadline_ms (float): Time budget for an anytime search; giving
+                this or epsilon selects the "anytime" mode
+            epsilon (float or tuple): Heuristic inflation, or an (initial,
+                final, step) schedule lowered while time allows
         """
+        self.cancel_plan()
+        self.cancel_replan()
+        
         if self.destination is None:
             self.path = None
             return
@@ -247,6 +297,8 @@ class PlayerController:
         # Store that we're in the middle of path visualization
         self.visualization_in_progress = True
         self.explored_cells = []
+        self.path = None
+        self.current_path_index = 0
         
         # Use A* to find the path
         start = (int(self.position[0]), int(self.position[1]))
@@ -259,23 +311,68 @@ class PlayerController:
             self.pathfinder.disable_visualization()
         
         # Use the PathFinder's A* algorithm with enhanced elevation-based costs
+        original_elevation_weight = self.pathfinder.elevation_weight
         if optimize_for_elevation:
             # Set a higher weight on elevation differences in the pathfinder temporarily
-            original_elevation_weight = self.pathfinder.elevation_weight
             self.pathfinder.elevation_weight = 3.0  # Increase weight for elevation changes
-            self.path = self.pathfinder.a_star(start, goal)
-            self.pathfinder.elevation_weight = original_elevation_weight  # Restore original weight
-        else:
-            self.path = self.pathfinder.a_star(start, goal)
+        self.pathfinder.last_bound = None
+        self.plan_ticket = self.pathfinder.plan_async(start, goal, mode, deadline_ms, epsilon)
+        self.pathfinder.elevation_weight = original_elevation_weight  # Restore original weight
         
-        # Disable visualization after path is calculated
+        # Disable visualization after the search is submitted
         self.pathfinder.disable_visualization()
+        
+        # Without the native planner the result is already there
+        self.update_plan()
+    
+    def cancel_plan(self):
+        """Cancel the background search for the current destination, if any."""
+        if self.plan_ticket is not None:
+            self.pathfinder.cancel_plan(self.plan_ticket)
+            self.plan_ticket = None
+            self.visualization_in_progress = False
+    
+    def _adopt_path(self, path):
+        """
+        Switch to a new path, continuing from the point nearest the rover.
+        
+        Args:
+            path (list): Path positions, starting where the search started
+        """
+        if self.path is not None and len(path) == len(self.path) and path[-1] == self.path[-1]:
+            return
+        
+        px, py = self.position
+        self.current_path_index = min(
+            range(len(path)), key=lambda i: (path[i][0] - px) ** 2 + (path[i][1] - py) ** 2
+        )
+        self.path = path
+    
+    def update_plan(self):
+        """Pick up progress from the background search, if one is running."""
+        if self.plan_ticket is None:
+            return
+        
+        state, path = self.pathfinder.poll_plan(self.plan_ticket)
+        if state in ('queued', 'running'):
+            if path is not None and len(path) > 1:
+                self._adopt_path(path)
+            return
+        
+        self.pathfinder.cancel_plan(self.plan_ticket)
+        self.plan_ticket = None
         self.visualization_in_progress = False
-            
-        self.current_path_index = 0
+        
+        if path is None:
+            self.path = None
+        else:
+            self._adopt_path(path)
         self.last_path_calculation = time.time()
         
-        # Don't block the main thread with a sleep
+        # Chunks queued for the previous route are no longer needed
+        self.terrain.cancel_prefetch()
+        self.prefetch_state = None
+        
         # A brief moment where the explored cells are still visible before clearing
         self.explored_cells = self.pathfinder.get_explored_cells().copy()
         
@@ -292,7 +389,11 @@ class PlayerController:
                 next_elev = self.terrain.get_elevation(next_point[0], next_point[1])
                 total_elevation_changes += abs(current_elev - next_elev)
             
-            self.gui.add_status_message(f"Path found! Total elevation changes: {total_elevation_changes:.1f}", (0, 255, 0))
+            message = f"Path found! Total elevation changes: {total_elevation_changes:.1f}"
+            bound = self.pathfinder.last_bound
+            if bound is not None and bound != float('inf'):
+                message += f" (within {bound:.2f}x of optimal)"
+            self.gui.add_status_message(message, (0, 255, 0))
     
     def toggle_autopilot(self):
         """Toggle autopilot mode."""
@@ -327,6 +428,61 @@ class PlayerController:
         self.explored_cells = []
         self.visualization_in_progress = False
     
+    def replan_path(self, optimize_for_elevation=True):
+        """
+        Start repairing the current path from the rover's position.
+        
+        Unlike calculate_path this reuses the previous replan's search, so
+        following a path and replanning costs little while the goal stays
+        the same. The replan runs on the planner thread, and the rover keeps
+        following its current path until update_replan picks up the result.
+        
+        Args:
+            optimize_for_elevation (bool): Whether to optimize for minimal elevation changes
+        """
+        if self.destination is None:
+            self.path = None
+            return
+        
+        start = (int(self.position[0]), int(self.position[1]))
+        goal = (int(self.destination[0]), int(self.destination[1]))
+        
+        # Same weights as calculate_path, so the replanned route matches it
+        original_elevation_weight = self.pathfinder.elevation_weight
+        if optimize_for_elevation:
+            self.pathfinder.elevation_weight = 3.0
+        self.replan_ticket = self.pathfinder.replan_async(start, goal)
+        self.pathfinder.elevation_weight = original_elevation_weight
+        
+        # Without the native planner the result is already there
+        self.update_replan()
+    
+    def cancel_replan(self):
+        """Cancel the background replan, if any."""
+        if self.replan_ticket is not None:
+            self.pathfinder.cancel_plan(self.replan_ticket)
+            self.replan_ticket = None
+    
+    def update_replan(self):
+        """Switch to the replanned path once the background replan finishes."""
+        if self.replan_ticket is None:
+            return
+        
+        state, path = self.pathfinder.poll_plan(self.replan_ticket)
+        if state in ('queued', 'running'):
+            return
+        
+        self.pathfinder.cancel_plan(self.replan_ticket)
+        self.replan_ticket = None
+        self.last_path_calculation = time.time()
+        
+        if path is None:
+            self.path = None
+            self.autopilot_enabled = False
+            self.gui.add_status_message("No valid path found!", (255, 0, 0))
+        else:
+            self._adopt_path(path)
+    
     def update_autopilot(self):
         """
         Update autopilot navigation.
@@ -334,18 +490,26 @@ class PlayerController:
         Returns:
             bool: Whether the player moved
         """
+        self.update_plan()
+        self.update_replan()
+        
         if not self.autopilot_enabled or self.path is None:
             return False
         
-        # Check if we've reached the destination
+        # Check if we've reached the destination, or the end of a partial
+        # path whose search is still running
         if self.current_path_index >= len(self.path) - 1:
-            self.autopilot_enabled = False
+            if self.plan_ticket is None:
+                self.autopilot_enabled = False
             return False
         
         # Check if we need to recalculate the path
         current_time = time.time()
-        if current_time - self.last_path_calculation > self.path_recalculation_interval:
-            self.calculate_path()
+        if (self.plan_ticket is None and self.replan_ticket is None and
+                current_time - self.last_path_calculation > self.path_recalculation_interval):
+            self.replan_path()
+            if self.path is None:
+                return False
         
         # Get the next waypoint
         next_waypoint = self.path[self.current_path_index + 1]
@@ -469,6 +633,13 @@ class InputHandler:
                             pygame.mouse.set_visible(True)
                             pygame.event.set_grab(False)
                 
+                # Toggle the library stats overlay with I key
+                if event.key == pygame.K_i:
+                    current_time = time.time()
+                    if current_time - self.key_cooldown.get(pygame.K_i, 0) > self.key_cooldown_time:
+                        self.key_cooldown[pygame.K_i] = current_time
+                        self.gui.show_stats = not self.gui.show_stats
+                
                 # Clear visualization with P key
                 if event.key == pygame.K_p:
                     current_time = time.time()
@@ -2,6 +2,9 @@ import pygame
 import numpy as np
 import os
 import math
+import threading
+
+from mars_terrain.terrain import USING_CPP
 
 class Camera:
     def __init__(self, x=0, y=0, zoom=1.0):
@@ -83,8 +86,13 @@ class FirstPersonCamera:
         self.horizontal_fov = math.radians(90)
         self.vertical_fov = math.radians(60)
         
-        # View distance
+        # View distance of the Python ray marcher, and of the native
+        # raycaster, which reads distant terrain from coarse mip levels
         self.view_distance = 50
+        self.render_distance = 2048
+        
+        # Blocks of height drawn per elevation unit by the native raycaster
+        self.height_scale = 0.2
         
         # Camera movement smoothing
         self.target_position = position
@@ -251,6 +259,30 @@ class TerrainColors:
         else:
             return TerrainColors.VERY_HIGH
     
+    @staticmethod
+    def get_colors(elevations, max_elevation):
+        """
+        Get the colors for an array of elevations, matching get_color.
+        
+        Args:
+            elevations (numpy.ndarray): Elevation values
+            max_elevation (float): Maximum elevation
+            
+        Returns:
+            numpy.ndarray: uint8 array of RGB colors with one more axis than
+                elevations
+        """
+        palette = np.array([
+            TerrainColors.VERY_LOW, TerrainColors.LOW, TerrainColors.MEDIUM_LOW,
+            TerrainColors.MEDIUM, TerrainColors.MEDIUM_HIGH, TerrainColors.HIGH,
+            TerrainColors.VERY_HIGH, TerrainColors.OBSTACLE
+        ], dtype=np.uint8)
+        bounds = np.array([0.1, 0.25, 0.4, 0.6, 0.75, 0.9]) * max_elevation
+        
+        index = np.searchsorted(bounds, elevations, side='right')
+        index[elevations < 0] = len(palette) - 1
+        return palette[index]
+    
     @staticmethod
     def get_shaded_color(color, shade_factor):
         """
@@ -271,10 +303,16 @@ class TerrainColors:
 
 
 class Minimap:
+    # Samples per side of each tile the minimap is built from
+    TILE_SAMPLES = 64
+    
     def __init__(self, width, height, terrain, position=(0, 0), size=(200, 200)):
         """
         Initialize the minimap.
         
+        The minimap starts out blank and fills in tile by tile as
+        generate_minimap builds it in the background.
+        
         Args:
             width (int): World width
             height (int): World height
@@ -292,42 +330,100 @@ class Minimap:
         
         # Create the minimap surface
         self.surface = pygame.Surface(size)
+        self.surface.fill((0, 0, 0))
         
         # Destination marker
         self.destination = None
         self.player_pos = (0, 0)
         self.path = None
         
-        # Generate the minimap at a lower resolution
+        # Tiles finished by the builder, waiting to be copied into pixels
+        self._tile_lock = threading.Lock()
+        self._ready_tiles = []
+        self._pending_tiles = []
+        self._build_id = 0
+        
+        # Start building the minimap at a lower resolution
         self.generate_minimap()
     
     def generate_minimap(self):
-        """Generate a low-resolution version of the terrain for the minimap."""
-        # Clear the surface
+        """
+        Start building a low-resolution version of the terrain for the minimap.
+        
+        Samples come from the coarsest mip level that still has one sample
+        per minimap pixel, so no full-resolution chunks are generated. With
+        the C++ terrain the tiles are built on a background thread; otherwise
+        update builds one tile per frame.
+        """
+        # Sample the terrain at regular intervals, rounded down to a power
+        # of two so each sample is on the mip level's grid
+        sample_size = max(1, min(self.world_width // self.width, self.world_height // self.height))
+        self.level = sample_size.bit_length() - 1
+        sample_size = 1 << self.level
+        
+        samples_x = -(-self.world_width // sample_size)
+        samples_y = -(-self.world_height // sample_size)
+        self.pixels = np.zeros((samples_x, samples_y, 3), dtype=np.uint8)
+        self.map_surface = pygame.Surface((samples_x, samples_y))
         self.surface.fill((0, 0, 0))
         
-        # Calculate the scale factor
-        scale_x = self.width / self.world_width
-        scale_y = self.height / self.world_height
+        tile = self.TILE_SAMPLES
+        tiles = [(i, j) for i in range(0, samples_x, tile) for j in range(0, samples_y, tile)]
         
-        # Sample the terrain at regular intervals to generate the minimap
-        sample_size = max(1, min(self.world_width // self.width, self.world_height // self.height))
+        with self._tile_lock:
+            self._build_id += 1
+            self._ready_tiles = []
+            self._pending_tiles = tiles
         
-        for x in range(0, self.world_width, sample_size):
-            for y in range(0, self.world_height, sample_size):
-                # Get the elevation at this position
-                elevation = self.terrain.get_elevation(x, y)
-                
-                # Calculate the color based on elevation
-                color = TerrainColors.get_color(elevation, self.terrain.max_elevation)
-                
-                # Calculate the position on the minimap
-                minimap_x = int(x * scale_x)
-                minimap_y = int(y * scale_y)
-                
-                # Draw a pixel (or small rect) at this position
-                size = max(1, int(scale_x * sample_size))
-                pygame.draw.rect(self.surface, color, (minimap_x, minimap_y, size, size))
+        if USING_CPP:
+            builder = threading.Thread(target=self._build_tiles, args=(self._build_id,), daemon=True)
+            builder.start()
+    
+    def _build_next_tile(self, build_id):
+        """
+        Sample and color the next pending tile of a build.
+        
+        Args:
+            build_id (int): Build the tile belongs to
+            
+        Returns:
+            bool: False once the build is finished or was superseded
+        """
+        with self._tile_lock:
+            if build_id != self._build_id or not self._pending_tiles:
+                return False
+            i, j = self._pending_tiles.pop(0)
+        
+        tile_width = min(self.TILE_SAMPLES, self.pixels.shape[0] - i)
+        tile_height = min(self.TILE_SAMPLES, self.pixels.shape[1] - j)
+        step = 1 << self.level
+        region = self.terrain.get_region_lod(i * step, j * step, tile_width, tile_height, self.level)
+        colors = TerrainColors.get_colors(region, self.terrain.max_elevation)
+        
+        with self._tile_lock:
+            if build_id != self._build_id:
+                return False
+            self._ready_tiles.append((i, j, colors))
+        return True
+    
+    def _build_tiles(self, build_id):
+        """Background thread body: build every tile of a build."""
+        while self._build_next_tile(build_id):
+            pass
+    
+    def _apply_ready_tiles(self):
+        """Copy finished tiles into the minimap with a single surface blit."""
+        with self._tile_lock:
+            tiles = self._ready_tiles
+            self._ready_tiles = []
+        if not tiles:
+            return
+        
+        for i, j, colors in tiles:
+            self.pixels[i:i + colors.shape[0], j:j + colors.shape[1]] = colors
+        
+        pygame.surfarray.blit_array(self.map_surface, self.pixels)
+        self.surface = pygame.transform.scale(self.map_surface, self.size)
     
     def update(self, player_pos, path=None):
         """
@@ -339,6 +435,10 @@ class Minimap:
         """
         self.player_pos = player_pos
         self.path = path
+        
+        # Without a background builder, build a tile per frame
+        if not USING_CPP:
+            self._build_next_tile(self._build_id)
     
     def set_destination(self, screen_x, screen_y):
         """
@@ -375,7 +475,8 @@ class Minimap:
         Args:
             screen (pygame.Surface): Screen surface to draw on
         """
-        # Draw the minimap background
+        # Draw the minimap background, with any newly finished tiles
+        self._apply_ready_tiles()
         screen.blit(self.surface, self.position)
         
         # Draw the border
@@ -426,6 +527,13 @@ class TerrainRenderer:
         # Create a color cache to avoid recalculating colors
         self.color_cache = {}
         
+        # Sample-resolution surface the top-down frame is blitted into
+        self._frame_surface = None
+        
+        # Frame buffer and surface reused by the native first-person view
+        self._fp_frame = None
+        self._fp_surface = None
+        
         # For improved visual quality
         self.use_lighting = True
         self.light_direction = (-1, -1)  # Light coming from top-left
@@ -480,15 +588,55 @@ class TerrainRenderer:
         # Apply lighting to color
         return TerrainColors.get_shaded_color(base_color, light_factor)
     
-    def render(self, camera, player_pos, path=None, destination=None):
+    def shade_region(self, region):
+        """
+        Color a region of elevations with the same colors and lighting as
+        get_color, as whole-array operations.
+        
+        Neighbours outside the region count as having the cell's own
+        elevation.
+        
+        Args:
+            region (numpy.ndarray): 2D array of elevations indexed [i, j]
+            
+        Returns:
+            numpy.ndarray: uint8 array of shape region.shape + (3,)
+        """
+        colors = TerrainColors.get_colors(region, self.terrain.max_elevation)
+        if not self.use_lighting:
+            return colors
+        
+        # Central differences for the normal, as in get_color
+        padded = np.pad(region, 1, mode='edge')
+        dx = padded[2:, 1:-1] - padded[:-2, 1:-1]
+        dy = padded[1:-1, 2:] - padded[1:-1, :-2]
+        length = np.maximum(0.001, np.sqrt(dx * dx + dy * dy))
+        
+        light_x, light_y, light_z = self.light_direction[0], self.light_direction[1], -1.0
+        light_length = math.sqrt(light_x ** 2 + light_y ** 2 + light_z ** 2)
+        diffuse = (dx * light_x + dy * light_y + light_z) / (length * light_length)
+        diffuse = np.maximum(0.0, diffuse)
+        
+        light_factor = self.ambient_light + (1.0 - self.ambient_light) * diffuse
+        light_factor[region < 0] = 1.0
+        
+        shaded = colors * light_factor[..., np.newaxis]
+        return np.clip(shaded, 0, 255).astype(np.uint8)
+    
+    def render(self, camera, player_pos, path=None, destination=None, explored_cells=None):
         """
         Render the visible terrain centered on the player.
         
+        The visible region is fetched with one batch query, colored and lit
+        as arrays, and drawn with a single surface blit scaled to the zoom.
+        
         Args:
             camera (Camera): Camera instance
             player_pos (tuple): Player's position (x, y)
             path (list): List of path waypoints
             destination (tuple): Destination position (x, y)
+            explored_cells (list): Cells explored by the pathfinder, drawn
+                highlighted when given
         """
         screen_width, screen_height = self.screen.get_size()
         
@@ -508,44 +656,39 @@ class TerrainRenderer:
         end_x = min(self.terrain.width, end_x)
         end_y = min(self.terrain.height, end_y)
         
-        # Calculate step size based on zoom level
+        # Calculate step size based on zoom level. Zoomed out, the step is
+        # rounded down to a power of two so the samples come from a coarse mip
+        # level instead of full-resolution chunks.
         step = max(1, int(1 / camera.zoom))
-        
-        # Precompute visible blocks and their elevations
-        visible_blocks = {}
-        for x in range(start_x, end_x, step):
-            for y in range(start_y, end_y, step):
-                elevation = self.terrain.get_elevation(x, y)
-                visible_blocks[(x, y)] = elevation
-        
-        # Render the visible terrain
-        for x in range(start_x, end_x, step):
-            for y in range(start_y, end_y, step):
-                # Get the elevation at this position
-                elevation = visible_blocks.get((x, y), -1)
-                
-                # Get neighbor elevations for lighting
-                if self.use_lighting and elevation >= 0:
-                    neighbors = {
-                        "left": visible_blocks.get((x-step, y), elevation),
-                        "right": visible_blocks.get((x+step, y), elevation),
-                        "top": visible_blocks.get((x, y-step), elevation),
-                        "bottom": visible_blocks.get((x, y+step), elevation)
-                    }
-                else:
-                    neighbors = None
-                
-                # Calculate the color based on elevation and lighting
-                color = self.get_color(elevation, x, y, neighbors)
-                
-                # Convert world coordinates to screen coordinates
-                screen_x, screen_y = camera.world_to_screen(x, y, screen_width, screen_height)
-                
-                # Calculate the size of the block based on zoom level
-                block_size = max(1, int(self.block_size * camera.zoom))
-                
-                # Draw a rect at this position
-                pygame.draw.rect(self.screen, color, (screen_x, screen_y, block_size, block_size))
+        level = step.bit_length() - 1
+        step = 1 << level
+        start_x -= start_x % step
+        start_y -= start_y % step
+        
+        # Fetch the visible samples with one batch query
+        samples_x = len(range(start_x, end_x, step))
+        samples_y = len(range(start_y, end_y, step))
+        if samples_x > 0 and samples_y > 0:
+            region = self.terrain.get_region_lod(start_x, start_y, samples_x, samples_y, level)
+            pixels = self.shade_region(region)
+            
+            # Highlight cells explored by the pathfinder
+            if explored_cells:
+                cells = np.asarray(explored_cells, dtype=np.int64).reshape(-1, 2)
+                i = (cells[:, 0] - start_x) // step
+                j = (cells[:, 1] - start_y) // step
+                inside = (i >= 0) & (i < samples_x) & (j >= 0) & (j < samples_y)
+                pixels[i[inside], j[inside]] = (255, 255, 0)
+            
+            # One sample covers step blocks, so step * zoom pixels
+            if self._frame_surface is None or self._frame_surface.get_size() != (samples_x, samples_y):
+                self._frame_surface = pygame.Surface((samples_x, samples_y))
+            pygame.surfarray.blit_array(self._frame_surface, pixels)
+            
+            size = (max(1, int(round(samples_x * step * camera.zoom))),
+                    max(1, int(round(samples_y * step * camera.zoom))))
+            screen_x, screen_y = camera.world_to_screen(start_x, start_y, screen_width, screen_height)
+            self.screen.blit(pygame.transform.scale(self._frame_surface, size), (int(screen_x), int(screen_y)))
         
         # Draw the player's position
         player_x, player_y = camera.world_to_screen(player_pos[0], player_pos[1], screen_width, screen_height)
@@ -579,6 +722,9 @@ class TerrainRenderer:
         """
         Render the terrain from a first-person perspective.
         
+        Uses the native raycaster when the C++ terrain is available and
+        falls back to marching rays in Python otherwise.
+        
         Args:
             camera (FirstPersonCamera): First-person camera instance
             player_pos (tuple): Player's position (x, y)
@@ -589,6 +735,151 @@ class TerrainRenderer:
         """
         screen_width, screen_height = self.screen.get_size()
         
+        if not self._render_first_person_native(camera, player_height, path, destination):
+            self._render_first_person_python(camera, path, destination)
+        
+        # Draw a clearer crosshair in the center of the screen
+        crosshair_size = 12
+        crosshair_thickness = 2
+        crosshair_color = (255, 255, 255)
+        crosshair_center = (screen_width // 2, screen_height // 2)
+        
+        # Outer circle
+        pygame.draw.circle(self.screen, crosshair_color, crosshair_center, crosshair_size, 1)
+        
+        # Inner dot
+        pygame.draw.circle(self.screen, crosshair_color, crosshair_center, 2)
+        
+        # Crosshair lines
+        pygame.draw.line(self.screen, crosshair_color, 
+                        (crosshair_center[0] - crosshair_size, crosshair_center[1]),
+                        (crosshair_center[0] - 4, crosshair_center[1]), crosshair_thickness)
+        pygame.draw.line(self.screen, crosshair_color, 
+                        (crosshair_center[0] + 4, crosshair_center[1]),
+                        (crosshair_center[0] + crosshair_size, crosshair_center[1]), crosshair_thickness)
+        pygame.draw.line(self.screen, crosshair_color, 
+                        (crosshair_center[0], crosshair_center[1] - crosshair_size),
+                        (crosshair_center[0], crosshair_center[1] - 4), crosshair_thickness)
+        pygame.draw.line(self.screen, crosshair_color, 
+                        (crosshair_center[0], crosshair_center[1] + 4),
+                        (crosshair_center[0], crosshair_center[1] + crosshair_size), crosshair_thickness)
+        
+        # Draw elevation indicator on the left side
+        elevation_indicator_width = 20
+        elevation_indicator_height = 150
+        elevation_x = 20
+        elevation_y = (screen_height - elevation_indicator_height) // 2
+        
+        # Draw background
+        pygame.draw.rect(self.screen, (30, 30, 30), 
+                        (elevation_x, elevation_y, elevation_indicator_width, elevation_indicator_height))
+        
+        # Draw current elevation indicator
+        if self.terrain.max_elevation > 0:
+            normalized_elevation = min(1.0, max(0.0, player_height / self.terrain.max_elevation))
+            indicator_height = int(elevation_indicator_height * normalized_elevation)
+            indicator_y = elevation_y + elevation_indicator_height - indicator_height
+            
+            # Draw filled bar
+            pygame.draw.rect(self.screen, (0, 200, 0), 
+                            (elevation_x, indicator_y, elevation_indicator_width, indicator_height))
+            
+            # Draw marker for current position
+            pygame.draw.rect(self.screen, (255, 255, 255), 
+                            (elevation_x, indicator_y, elevation_indicator_width, 3))
+        
+        # Label the elevation bar
+        elevation_label = "Elevation"
+        font = pygame.font.SysFont("Arial", 18)
+        label_surface = font.render(elevation_label, True, (255, 255, 255))
+        self.screen.blit(label_surface, 
+                        (elevation_x + elevation_indicator_width // 2 - label_surface.get_width() // 2, 
+                        elevation_y + elevation_indicator_height + 5))
+    
+    def _render_first_person_native(self, camera, player_height, path, destination):
+        """
+        Render the first-person terrain, sky and markers with the native
+        raycaster: one call fills a frame buffer that is blitted once.
+        
+        Args:
+            camera (FirstPersonCamera): First-person camera instance
+            player_height (float): Player's height above the terrain
+            path (list): List of path waypoints
+            destination (tuple): Destination position (x, y)
+            
+        Returns:
+            bool: False if the native raycaster is not available
+        """
+        screen_width, screen_height = self.screen.get_size()
+        eye_height = player_height + camera.height_offset
+        cam_x, cam_y = camera.position
+        
+        frame = self.terrain.render_view(
+            cam_x, cam_y, eye_height, camera.direction, camera.vertical_angle,
+            camera.horizontal_fov, camera.render_distance, camera.height_scale,
+            screen_width, screen_height, self._fp_frame
+        )
+        if frame is None:
+            return False
+        self._fp_frame = frame
+        
+        if self._fp_surface is None or self._fp_surface.get_size() != (screen_width, screen_height):
+            self._fp_surface = pygame.Surface((screen_width, screen_height))
+        pygame.surfarray.blit_array(self._fp_surface, frame)
+        self.screen.blit(self._fp_surface, (0, 0))
+        
+        # Project markers with the raycaster's camera model
+        half_width = math.tan(camera.horizontal_fov / 2)
+        focal = (screen_width / 2) / half_width
+        horizon = screen_height / 2 + math.tan(camera.vertical_angle) * focal
+        forward = (math.cos(camera.direction), math.sin(camera.direction))
+        
+        def project(point):
+            dx, dy = point[0] - cam_x, point[1] - cam_y
+            depth = dx * forward[0] + dy * forward[1]
+            if depth < 1 or depth > camera.render_distance:
+                return None
+            side = -dx * forward[1] + dy * forward[0]
+            elevation = max(0.0, self.terrain.get_elevation(int(point[0]), int(point[1])))
+            screen_x = screen_width / 2 + side / depth * focal
+            screen_y = horizon + (eye_height - elevation) * camera.height_scale * focal / depth
+            return int(screen_x), int(screen_y), depth
+        
+        if path:
+            for path_pos in path[::4]:
+                projected = project(path_pos)
+                if projected:
+                    x, y, depth = projected
+                    pygame.draw.circle(self.screen, (0, 255, 0), (x, y),
+                                       max(2, int(8 * (1 - depth / camera.render_distance))))
+        
+        if destination:
+            projected = project(destination)
+            if projected:
+                x, y, depth = projected
+                marker_size = max(5, int(15 * (1 - depth / camera.render_distance)))
+                pygame.draw.circle(self.screen, (255, 0, 0), (x, y), marker_size)
+                pygame.draw.line(self.screen, (255, 255, 255),
+                                 (x - marker_size / 2, y - marker_size / 2),
+                                 (x + marker_size / 2, y + marker_size / 2), 2)
+                pygame.draw.line(self.screen, (255, 255, 255),
+                                 (x - marker_size / 2, y + marker_size / 2),
+                                 (x + marker_size / 2, y - marker_size / 2), 2)
+        
+        return True
+    
+    def _render_first_person_python(self, camera, path, destination):
+        """
+        Render the first-person terrain, sky and markers by marching rays in
+        Python.
+        
+        Args:
+            camera (FirstPersonCamera): First-person camera instance
+            path (list): List of path waypoints
+            destination (tuple): Destination position (x, y)
+        """
+        screen_width, screen_height = self.screen.get_size()
+        
         # Draw sky gradient
         # Create a vertical gradient from sky color to horizon color
         for y in range(screen_height // 2):
@@ -775,64 +1066,6 @@ class TerrainRenderer:
                         marker_x = x + block_width // 2
                         pygame.draw.circle(self.screen, (0, 255, 0), (marker_x, screen_y), marker_size)
                         break
-        
-        # Draw a clearer crosshair in the center of the screen
-        crosshair_size = 12
-        crosshair_thickness = 2
-        crosshair_color = (255, 255, 255)
-        crosshair_center = (screen_width // 2, screen_height // 2)
-        
-        # Outer circle
-        pygame.draw.circle(self.screen, crosshair_color, crosshair_center, crosshair_size, 1)
-        
-        # Inner dot
-        pygame.draw.circle(self.screen, crosshair_color, crosshair_center, 2)
-        
-        # Crosshair lines
-        pygame.draw.line(self.screen, crosshair_color, 
-                        (crosshair_center[0] - crosshair_size, crosshair_center[1]),
-                        (crosshair_center[0] - 4, crosshair_center[1]), crosshair_thickness)
-        pygame.draw.line(self.screen, crosshair_color, 
-                        (crosshair_center[0] + 4, crosshair_center[1]),
-                        (crosshair_center[0] + crosshair_size, crosshair_center[1]), crosshair_thickness)
-        pygame.draw.line(self.screen, crosshair_color, 
-                        (crosshair_center[0], crosshair_center[1] - crosshair_size),
-                        (crosshair_center[0], crosshair_center[1] - 4), crosshair_thickness)
-        pygame.draw.line(self.screen, crosshair_color, 
-                        (crosshair_center[0], crosshair_center[1] + 4),
-                        (crosshair_center[0], crosshair_center[1] + crosshair_size), crosshair_thickness)
-        
-        # Draw elevation indicator on the left side
-        elevation_indicator_width = 20
-        elevation_indicator_height = 150
-        elevation_x = 20
-        elevation_y = (screen_height - elevation_indicator_height) // 2
-        
-        # Draw background
-        pygame.draw.rect(self.screen, (30, 30, 30), 
-                        (elevation_x, elevation_y, elevation_indicator_width, elevation_indicator_height))
-        
-        # Draw current elevation indicator
-        if self.terrain.max_elevation > 0:
-            normalized_elevation = min(1.0, max(0.0, player_height / self.terrain.max_elevation))
-            indicator_height = int(elevation_indicator_height * normalized_elevation)
-            indicator_y = elevation_y + elevation_indicator_height - indicator_height
-            
-            # Draw filled bar
-            pygame.draw.rect(self.screen, (0, 200, 0), 
-                            (elevation_x, indicator_y, elevation_indicator_width, indicator_height))
-            
-            # Draw marker for current position
-            pygame.draw.rect(self.screen, (255, 255, 255), 
-                            (elevation_x, indicator_y, elevation_indicator_width, 3))
-        
-        # Label the elevation bar
-        elevation_label = "Elevation"
-        font = pygame.font.SysFont("Arial", 18)
-        label_surface = font.render(elevation_label, True, (255, 255, 255))
-        self.screen.blit(label_surface, 
-                        (elevation_x + elevation_indicator_width // 2 - label_surface.get_width() // 2, 
-                        elevation_y + elevation_indicator_height + 5))
 
 
 class GUI:
@@ -872,6 +1105,13 @@ class GUI:
         
         # First-person mode
         self.first_person_mode = False
+        
+        # Native library counters overlay; rates are recomputed about once a
+        # second from the previous snapshot
+        self.show_stats = False
+        self._stats_snapshot = None
+        self._stats_time = 0
+        self._stats_lines = []
     
     def clear_screen(self):
         """Clear the screen with a black background."""
@@ -920,7 +1160,68 @@ class GUI:
             self.render_text(message, (10, y), color)
             y += 25
     
-    def render_hud(self, player_pos, elevation, autopilot_enabled, first_person_mode=False):
+    @staticmethod
+    def _histogram_percentile_ms(histogram, fraction):
+        """
+        Upper bound of the latency bucket holding the given fraction of samples.
+        
+        Args:
+            histogram (list): Counts per bucket, bucket i covering [2**i, 2**(i+1)) microseconds
+            fraction (float): Fraction of samples, e.g. 0.95
+            
+        Returns:
+            float: Bucket upper bound in milliseconds, or 0 with no samples
+        """
+        total = sum(histogram)
+        if total == 0:
+            return 0.0
+        
+        seen = 0
+        for bucket, count in enumerate(histogram):
+            seen += count
+            if seen >= fraction * total:
+                return (2 ** (bucket + 1)) / 1000.0
+        return (2 ** len(histogram)) / 1000.0
+    
+    def _update_stats_lines(self, stats):
+        """
+        Recompute the stats overlay text from a new counters snapshot.
+        
+        Args:
+            stats (dict): Counters from TerrainGenerator.get_stats
+        """
+        now = pygame.time.get_ticks()
+        previous = self._stats_snapshot
+        if previous is not None and now - self._stats_time < 1000:
+            return
+        
+        seconds = (now - self._stats_time) / 1000.0 if previous is not None else 0.0
+        
+        def rate(name):
+            if previous is None or seconds <= 0:
+                return 0.0
+            return (stats[name] - previous[name]) / seconds
+        
+        lookups = stats['cache_hits'] + stats['cache_misses']
+        hit_rate = 100.0 * stats['cache_hits'] / lookups if lookups else 0.0
+        chunk_ms = stats['chunk_generation_ns'] / stats['chunk_generations'] / 1e6 if stats['chunk_generations'] else 0.0
+        path_ms = stats['path_ns'] / stats['path_searches'] / 1e6 if stats['path_searches'] else 0.0
+        
+        self._stats_lines = [
+            f"Chunks: {rate('chunk_generations'):.1f} gen/s, {chunk_ms:.1f} ms avg, "
+            f"p95 < {self._histogram_percentile_ms(stats['chunk_latency'], 0.95):.1f} ms",
+            f"Cache: {hit_rate:.1f}% hits, {rate('evictions'):.1f} evictions/s, "
+            f"{stats['chunks_resident']} chunks, {stats['bytes_resident'] / (1024 * 1024):.1f} MB",
+            f"Planner: {stats['path_searches']} searches, {path_ms:.1f} ms avg, "
+            f"p95 < {self._histogram_percentile_ms(stats['path_latency'], 0.95):.1f} ms, "
+            f"{rate('path_expansions'):.0f} expansions/s",
+            f"Pool: {stats['pool_bytes'] / (1024 * 1024):.0f} MB slabs, {stats['pool_buffers_free']} free buffers"
+            + (", huge pages" if stats['pool_huge_pages'] else ""),
+        ]
+        self._stats_snapshot = stats
+        self._stats_time = now
+    
+    def render_hud(self, player_pos, elevation, autopilot_enabled, first_person_mode=False, stats=None):
         """
         Render the heads-up display.
         
@@ -929,6 +1230,7 @@ class GUI:
             elevation (float): Current elevation
             autopilot_enabled (bool): Whether autopilot is enabled
             first_person_mode (bool): Whether first-person mode is enabled
+            stats (dict): Native library counters to overlay, or None to hide them
         """
         # Render player position
         pos_text = f"Position: ({player_pos[0]:.1f}, {player_pos[1]:.1f})"
@@ -938,6 +1240,16 @@ class GUI:
         elev_text = f"Elevation: {elevation:.1f}"
         self.render_text(elev_text, (10, 30))
         
+        # Render library counters, so chunk thrash and planner stalls show live
+        if stats is not None:
+            if stats['enabled']:
+                self._update_stats_lines(stats)
+                lines = self._stats_lines
+            else:
+                lines = ["Stats: library built with TERRAIN_STATS=0"]
+            for i, line in enumerate(lines):
+                self.render_text(line, (10, 60 + 20 * i), (200, 200, 255))
+        
         # Render autopilot status
         if autopilot_enabled:
             self.render_text("Autopilot: ENABLED", (self.width - 200, 10), (0, 255, 0))
@@ -952,9 +1264,9 @@ class GUI:
         
         # Render controls help appropriate for the current view mode
         if first_person_mode:
-            controls_text = "Controls: WASD=Move, Mouse=Look, K=Toggle Autopilot, R=Toggle View"
+            controls_text = "Controls: WASD=Move, Mouse=Look, K=Toggle Autopilot, R=Toggle View, I=Stats"
         else:
-            controls_text = "Controls: WASD=Move, K=Toggle Autopilot, R=Toggle View, Scroll=Zoom"
+            controls_text = "Controls: WASD=Move, K=Toggle Autopilot, R=Toggle View, Scroll=Zoom, I=Stats"
         
         self.render_text(controls_text, (10, self.height - 50))
         
@@ -6,6 +6,7 @@ A full-screen GUI simulation of Mars terrain with pathfinding and navigation.
 """
 
 import argparse
+import json
 import sys
 import os
 import time
@@ -37,9 +38,27 @@ def parse_args():
                         help='Probability of obstacles (default: 0.05)')
     parser.add_argument('--test', action='store_true',
                         help='Run in test mode with smaller world size')
+    parser.add_argument('--cache-dir', type=str, default=None,
+                        help='Directory for persistent chunk tiles (default: cache.disk_dir setting)')
+    parser.add_argument('--heightfield', type=str, default=None,
+                        help='Heightfield file (tiled export or GeoTIFF) to explore instead of generated terrain')
     
     return parser.parse_args()
 
+def load_settings():
+    """
+    Load settings from the settings.json file next to this script.
+    
+    Returns:
+        dict: Parsed settings, or an empty dict if the file is missing or invalid
+    """
+    settings_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'settings.json')
+    try:
+        with open(settings_path, 'r') as f:
+            return json.load(f)
+    except (FileNotFoundError, json.JSONDecodeError):
+        return {}
+
 def ensure_valid_starting_position(terrain, start_pos, radius=5):
     """
     Ensure that the starting position and its surroundings are valid (not obstacles).
@@ -54,11 +73,6 @@ def ensure_valid_starting_position(terrain, start_pos, radius=5):
     """
     x, y = start_pos
     
-    # First, generate the chunk containing the start position
-    chunk_x = x // terrain.chunk_size
-    chunk_y = y // terrain.chunk_size
-    chunk = terrain.generate_chunk(chunk_x, chunk_y)
-    
     # Clear obstacles around the starting position
     for dx in range(-radius, radius+1):
         for dy in range(-radius, radius+1):
@@ -66,20 +80,8 @@ def ensure_valid_starting_position(terrain, start_pos, radius=5):
             if 0 <= nx < terrain.width and 0 <= ny < terrain.height:
                 # Force this position to have a valid elevation (not an obstacle)
                 if terrain.is_obstacle(nx, ny):
-                    # Get local coordinates within the chunk
-                    local_x = nx % terrain.chunk_size
-                    local_y = ny % terrain.chunk_size
-                    local_chunk_x = nx // terrain.chunk_size
-                    local_chunk_y = ny // terrain.chunk_size
-                    
-                    # If this position is in a different chunk, generate that chunk
-                    if local_chunk_x != chunk_x or local_chunk_y != chunk_y:
-                        local_chunk = terrain.generate_chunk(local_chunk_x, local_chunk_y)
-                        # Set a valid elevation (middle of the range)
-                        local_chunk[local_x, local_y] = terrain.max_elevation / 2
-                    else:
-                        # Set a valid elevation (middle of the range)
-                        chunk[local_x, local_y] = terrain.max_elevation / 2
+                    # Set a valid elevation (middle of the range)
+                    terrain.set_elevation(nx, ny, terrain.max_elevation / 2)
     
     return start_pos
 
@@ -109,12 +111,19 @@ def main():
         terrain_height = args.height
         chunk_size = args.chunk_size
     
+    settings = load_settings()
+    
+    # Warm starts with the same seed reuse chunk tiles from the disk store
+    cache_settings = settings.get('cache', {})
+    cache_dir = args.cache_dir or cache_settings.get('disk_dir') or None
+    
     terrain = TerrainGenerator(
         width=terrain_width,
         height=terrain_height,
         max_elevation=args.max_elevation,
         chunk_size=chunk_size,
-        seed=args.seed
+        seed=args.seed,
+        cache_dir=cache_dir
     )
     
     # Set custom terrain parameters if provided
@@ -124,8 +133,34 @@ def main():
     if args.scale:
         terrain.scale = args.scale
     
+    if args.heightfield:
+        terrain.load_heightfield(args.heightfield)
+    
+    # Bound chunk memory; visible chunks are pinned as the player moves
+    terrain.configure_cache(
+        int(cache_settings.get('budget_mb', 256) * 1024 * 1024),
+        1 if cache_settings.get('policy', 'lru').lower() == 'clock' else 0
+    )
+    terrain.set_chunk_format(cache_settings.get('chunk_format', 'float32'))
+    terrain.set_huge_pages(cache_settings.get('huge_pages', False))
+    terrain.set_chunk_layout(cache_settings.get('chunk_layout', 'linear'))
+    pin_radius = cache_settings.get('pin_radius', 2)
+    pinned_chunk = None
+    
     # Create the pathfinder
-    pathfinder = PathFinder(terrain)
+    pathfinding_settings = settings.get('pathfinding', {})
+    terrain.set_edge_cost_weight(pathfinding_settings.get('edge_cost_weight', 0.0))
+    terrain.set_path_heuristic(pathfinding_settings.get('heuristic', 'octile_climb'),
+                               pathfinding_settings.get('landmark_count', 8))
+    terrain.set_path_clearance(pathfinding_settings.get('required_clearance', 0.0),
+                               pathfinding_settings.get('preferred_clearance', 0.0),
+                               pathfinding_settings.get('clearance_weight', 0.0))
+    pathfinder = PathFinder(terrain, max_iterations=pathfinding_settings.get('max_iterations', 0),
+                            mode=pathfinding_settings.get('mode', 'astar'),
+                            jump_tolerance=pathfinding_settings.get('jump_tolerance', 0.0),
+                            epsilon=tuple(pathfinding_settings.get('epsilon_schedule', (10.0, 1.0, 3.0))),
+                            deadline_ms=pathfinding_settings.get('deadline_ms', 0),
+                            replan_iterations=pathfinding_settings.get('replan_iterations', 10000))
     
     # Define a safe starting position (well away from the edges)
     start_pos = (50, 50)
@@ -133,13 +168,19 @@ def main():
     # Ensure the starting position is valid
     start_pos = ensure_valid_starting_position(terrain, start_pos)
     
+    # Landmark tables for the default and the autopilot elevation weights;
+    # built after the start is cleared, since that edit would outdate them
+    if pathfinding_settings.get('heuristic') == 'landmarks':
+        text = "Preparing landmark tables..."
+        gui.render_text(text, (gui.width // 2 - len(text) * 5, gui.height // 2 + 30))
+        gui.update()
+        for elevation_weight in sorted({pathfinder.elevation_weight, 3.0}):
+            if not terrain.prepare_landmarks(elevation_weight):
+                print("Landmark tables unavailable; paths use the octile-plus-climb heuristic.")
+                break
+    
     # Generate initial terrain around the starting point
-    for x in range(-2, 3):
-        for y in range(-2, 3):
-            chunk_x = start_pos[0] // terrain.chunk_size + x
-            chunk_y = start_pos[1] // terrain.chunk_size + y
-            if chunk_x >= 0 and chunk_y >= 0:
-                terrain.generate_chunk(chunk_x, chunk_y)
+    terrain.generate_chunks(terrain.get_visible_chunks(start_pos[0], start_pos[1], 2))
     
     # Create the player controller
     controller = PlayerController(terrain, pathfinder, gui, initial_pos=start_pos)
@@ -166,7 +207,12 @@ def main():
     )
     
     # Create the renderer with appropriate settings
-    renderer = TerrainRenderer(gui.screen, terrain, block_size=5)
+    display_settings = settings.get('display', {})
+    renderer = TerrainRenderer(gui.screen, terrain, block_size=display_settings.get('block_size', 5))
+    renderer.use_lighting = display_settings.get('use_lighting', True)
+    renderer.ambient_light = display_settings.get('ambient_light', 0.5)
+    renderer.light_direction = tuple(display_settings.get('light_direction', (-1, -1)))
+    gui.show_stats = display_settings.get('show_stats', False)
     
     # Create the input handler
     input_handler = InputHandler(gui, controller, camera, minimap)
@@ -249,7 +295,9 @@ def main():
                     fp_camera.set_position(new_pos[0], new_pos[1], terrain)
         
         # Render HUD with first-person mode indication
-        gui.render_hud(player_pos, controller.get_elevation(), controller.autopilot_enabled, gui.first_person_mode)
+        stats = terrain.get_stats() if gui.show_stats else None
+        gui.render_hud(player_pos, controller.get_elevation(), controller.autopilot_enabled, gui.first_person_mode,
+                       stats)
         
         # Update the display
         gui.update()
@@ -259,14 +307,18 @@ def main():
             pygame.event.pump()
         
         # Preload chunks around the player
-        chunk_x = int(player_pos[0]) // terrain.chunk_size
-        chunk_y = int(player_pos[1]) // terrain.chunk_size
-        for dx in range(-1, 2):
-            for dy in range(-1, 2):
-                terrain.generate_chunk(chunk_x + dx, chunk_y + dy)
+        terrain.generate_chunks(terrain.get_visible_chunks(int(player_pos[0]), int(player_pos[1]), 1))
         
-        # Unload distant chunks to save memory
-        terrain.unload_distant_chunks(int(player_pos[0]), int(player_pos[1]), 5)
+        # Keep the chunks around the player resident; the cache budget
+        # evicts the rest
+        if terrain.has_cache_budget:
+            player_chunk = (int(player_pos[0]) // terrain.chunk_size, int(player_pos[1]) // terrain.chunk_size)
+            if player_chunk != pinned_chunk:
+                terrain.pin_chunks(terrain.get_visible_chunks(int(player_pos[0]), int(player_pos[1]), pin_radius))
+                pinned_chunk = player_chunk
+        else:
+            # Unload distant chunks to save memory
+            terrain.unload_distant_chunks(int(player_pos[0]), int(player_pos[1]), 5)
     
     # Clean up
     gui.quit()
@@ -0,0 +1,560 @@
+// Standalone performance suite for the terrain generator, built by
+// `make bench`. The library is a single translation unit, so it is compiled
+// straight into the benchmark. Results are printed as JSON in the layout
+// Google Benchmark uses, so runs can be diffed with its compare.py.
+//
+// Usage: terrain_benchmark [--filter=SUBSTRING] [--min_time=SECONDS]
+
+#include "terrain_generator.cpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations;
+    double realTimeNs;     // Per iteration
+    double itemsPerSecond; // 0 when the benchmark does not count items
+    std::vector<std::pair<std::string, double>> counters;
+};
+
+// Passed to each benchmark body. The body runs its operation iterations()
+// times, keeping setup outside the timed region with pause()/resume().
+class BenchmarkState {
+private:
+    uint64_t iterationCount;
+    uint64_t items;
+    Clock::duration paused;
+    Clock::time_point pausedAt;
+
+public:
+    std::vector<std::pair<std::string, double>> counters;
+
+    explicit BenchmarkState(uint64_t iterationCount)
+        : iterationCount(iterationCount), items(0), paused(Clock::duration::zero()) {}
+
+    uint64_t iterations() const { return iterationCount; }
+
+    void pause() { pausedAt = Clock::now(); }
+    void resume() { paused += Clock::now() - pausedAt; }
+
+    void addItems(uint64_t count) { items += count; }
+    uint64_t itemCount() const { return items; }
+    Clock::duration pausedTime() const { return paused; }
+};
+
+// Keep a value alive so the optimizer cannot drop the work producing it
+template <typename T>
+void doNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+class BenchmarkRunner {
+private:
+    std::string filter;
+    double minTime;
+    std::vector<BenchmarkResult> results;
+
+public:
+    BenchmarkRunner(const std::string& filter, double minTime) : filter(filter), minTime(minTime) {}
+
+    // Run body with growing iteration counts until one run lasts minTime
+    void run(const std::string& name, const std::function<void(BenchmarkState&)>& body) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) {
+            return;
+        }
+
+        uint64_t iterations = 1;
+        while (true) {
+            BenchmarkState state(iterations);
+            Clock::time_point started = Clock::now();
+            body(state);
+            double seconds = std::chrono::duration<double>(Clock::now() - started - state.pausedTime()).count();
+
+            if (seconds >= minTime || iterations >= (1ull << 30)) {
+                BenchmarkResult result;
+                result.name = name;
+                result.iterations = iterations;
+                result.realTimeNs = seconds * 1e9 / iterations;
+                result.itemsPerSecond = state.itemCount() > 0 && seconds > 0 ? state.itemCount() / seconds : 0.0;
+                result.counters = state.counters;
+                results.push_back(result);
+                std::fprintf(stderr, "%-48s %12.0f ns %10llu\n", name.c_str(), result.realTimeNs,
+                             static_cast<unsigned long long>(iterations));
+                return;
+            }
+
+            // Aim a little past minTime, growing at most 10x per round
+            double scale = seconds > 0 ? minTime * 1.4 / seconds : 10.0;
+            iterations = static_cast<uint64_t>(iterations * std::max(1.5, std::min(10.0, scale))) + 1;
+        }
+    }
+
+    void printJson() const {
+        std::printf("{\n  \"context\": {\n");
+        std::printf("    \"library\": \"terrain_generator\",\n");
+        std::printf("    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+        std::printf("    \"min_time\": %g\n  },\n", minTime);
+        std::printf("  \"benchmarks\": [");
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchmarkResult& result = results[i];
+            std::printf("%s\n    {\n", i > 0 ? "," : "");
+            std::printf("      \"name\": \"%s\",\n", result.name.c_str());
+            std::printf("      \"run_type\": \"iteration\",\n");
+            std::printf("      \"iterations\": %llu,\n", static_cast<unsigned long long>(result.iterations));
+            std::printf("      \"real_time\": %.3f,\n", result.realTimeNs);
+            // Only wall time is measured; cpu_time repeats it for compare.py
+            std::printf("      \"cpu_time\": %.3f,\n", result.realTimeNs);
+            for (const auto& counter : result.counters) {
+                std::printf("      \"%s\": %.6g,\n", counter.first.c_str(), counter.second);
+            }
+            if (result.itemsPerSecond > 0) {
+                std::printf("      \"items_per_second\": %.6g,\n", result.itemsPerSecond);
+            }
+            std::printf("      \"time_unit\": \"ns\"\n    }");
+        }
+        std::printf("\n  ]\n}\n");
+    }
+};
+
+// Fixed world used by every benchmark
+const int kSeed = 42;
+const int kChunkSize = 256;
+
+void configure(TerrainGenerator& terrain, int octaves = 6) {
+    terrain.setParameters(0.01, octaves, 0.5, 2.0, 0.05);
+}
+
+void registerNoise(BenchmarkRunner& runner) {
+    runner.run("BM_SimplexNoise", [](BenchmarkState& state) {
+        SimplexNoise noise(kSeed);
+        double sum = 0.0;
+        for (uint64_t i = 0; i < state.iterations(); i++) {
+            sum += noise.noise(i * 0.013, i * 0.007);
+        }
+        doNotOptimize(sum);
+        state.addItems(state.iterations());
+    });
+
+    // "auto" uses the FractalNoise specializations for 4, 6 and 8 octaves,
+    // "generic" the same kernel with runtime octave and cell counts
+    struct KernelCase {
+        const char* name;
+        NoiseKernel kernel;
+        bool presetKernels;
+    };
+    static const KernelCase kernels[] = {
+        {"reference", NOISE_KERNEL_REFERENCE, true},
+        {"auto", NOISE_KERNEL_AUTO, true},
+        {"generic", NOISE_KERNEL_AUTO, false},
+    };
+    static const int octaveCounts[] = {1, 2, 4, 6, 8};
+    for (const KernelCase& kernel : kernels) {
+        for (int octaves : octaveCounts) {
+            std::string name = std::string("BM_GenerateChunk/") + kernel.name + "/octaves:" + std::to_string(octaves);
+            runner.run(name, [kernel, octaves](BenchmarkState& state) {
+                TerrainGenerator terrain(64 * kChunkSize, 64 * kChunkSize, 250, kChunkSize, kSeed);
+                configure(terrain, octaves);
+                terrain.setNoiseKernel(kernel.kernel);
+                terrain.setPresetKernels(kernel.presetKernels);
+for (uint64_t i = 0; i < state.iterations(); i++) {
+                    ChunkPtr chunk = terrain.buildChunk(static_cast<int>(i % 64), static_cast<int>(i / 64 % 64));
+                    doNotOptimize(chunk);
+                }
+                state.addItems(state.iterations() * kChunkSize * kChunkSize);
+            });
+        }
+    }
+}
+
+void registerElevation(BenchmarkRunner& runner) {
+    // Hits inside a warm 4x4 chunk block
+    runner.run("BM_GetElevation/sequential_hit", [](BenchmarkState& state) {
+        state.pause();
+        TerrainGenerator terrain(4 * kChunkSize, 4 * kChunkSize, 250, kChunkSize, kSeed);
+        configure(terrain);
+        std::vector<float> warm(4 * kChunkSize * 4 * kChunkSize);
+        terrain.getRegion(0, 0, 4 * kChunkSize, 4 * kChunkSize, 1, warm.data());
+        state.resume();
+
+        const int side = 4 * kChunkSize;
+        float sum = 0.0f;
+        for (uint64_t i = 0; i < state.iterations(); i++) {
+            int cell = static_cast<int>(i % (side * side));
+            sum += terrain.getElevation(cell / side, cell % side);
+        }
+        doNotOptimize(sum);
+        state.addItems(state.iterations());
+    });
+
+    runner.run("BM_GetElevation/random_hit", [](BenchmarkState& state) {
+        state.pause();
+        TerrainGenerator terrain(4 * kChunkSize, 4 * kChunkSize, 250, kChunkSize, kSeed);
+        configure(terrain);
+        std::vector<float> warm(4 * kChunkSize * 4 * kChunkSize);
+        terrain.getRegion(0, 0, 4 * kChunkSize, 4 * kChunkSize, 1, warm.data());
+        std::mt19937 random(kSeed);
+        std::vector<int> cells(1 << 16);
+        for (int& cell : cells) {
+            cell = static_cast<int>(random() % (4 * kChunkSize * 4 * kChunkSize));
+        }
+        state.resume();
+
+        const int side = 4 * kChunkSize;
+        float sum = 0.0f;
+        for (uint64_t i = 0; i < state.iterations(); i++) {
+            int cell = cells[i & (cells.size() - 1)];
+            sum += terrain.getElevation(cell / side, cell % side);
+        }
+        doNotOptimize(sum);
+        state.addItems(state.iterations());
+    });
+
+    // Every lookup lands on a chunk that is not cached yet
+    runner.run("BM_GetElevation/miss", [](BenchmarkState& state) {
+        TerrainGenerator terrain(1024 * kChunkSize, 1024 * kChunkSize, 250, kChunkSize, kSeed);
+        configure(terrain);
+        float sum = 0.0f;
+        for (uint64_t i = 0; i < state.iterations(); i++) {
+            int chunk = static_cast<int>(i % (1024 * 1024));
+            sum += terrain.getElevation((chunk / 1024) * kChunkSize + 7, (chunk % 1024) * kChunkSize + 7);
+            if (i % 256 == 255) {
+                state.pause();
+                terrain.clearChunks();
+                state.resume();
+            }
+        }
+        doNotOptimize(sum);
+        state.addItems(state.iterations());
+    });
+}
+
+void registerRegions(BenchmarkRunner& runner) {
+    static const int steps[] = {1, 4};
+    for (int step : steps) {
+        runner.run("BM_GetRegion/512x512/step:" + std::to_string(step), [step](BenchmarkState& state) {
+            state.pause();
+            TerrainGenerator terrain(16 * kChunkSize, 16 * kChunkSize, 250, kChunkSize, kSeed);
+            configure(terrain);
+            std::vector<float> out(512 * 512);
+            terrain.getRegion(100, 100, 512, 512, step, out.data());
+            state.resume();
+
+            for (uint64_t i = 0; i < state.iterations(); i++) {
+                terrain.getRegion(100, 100, 512, 512, step, out.data());
+                doNotOptimize(out[0]);
+            }
+            state.addItems(state.iterations() * 512 * 512);
+        });
+    }
+
+    runner.run("BM_GetElevations/batch:65536", [](BenchmarkState& state) {
+        state.pause();
+        TerrainGenerator terrain(4 * kChunkSize, 4 * kChunkSize, 250, kChunkSize, kSeed);
+        configure(terrain);
+        std::mt19937 random(kSeed);
+        std::vector<int> xs(65536), ys(65536);
+        for (size_t i = 0; i < xs.size(); i++) {
+            xs[i] = static_cast<int>(random() % (4 * kChunkSize));
+            ys[i] = static_cast<int>(random() % (4 * kChunkSize));
+        }
+        std::vector<float> out(xs.size());
+        terrain.getElevations(xs.data(), ys.data(), static_cast<int>(xs.size()), out.data());
+        state.resume();
+
+        for (uint64_t i = 0; i < state.iterations(); i++) {
+            terrain.getElevations(xs.data(), ys.data(), static_cast<int>(xs.size()), out.data());
+            doNotOptimize(out[0]);
+        }
+        state.addItems(state.iterations() * xs.size());
+    });
+
+    runner.run("BM_GetRegionLod/256x256/level:6", [](BenchmarkState& state) {
+        state.pause();
+        TerrainGenerator terrain(15000, 15000, 250, kChunkSize, kSeed);
+        configure(terrain);
+        std::vector<float> out(256 * 256);
+        state.resume();
+
+        for (uint64_t i = 0; i < state.iterations(); i++) {
+            terrain.getRegionLod(0, 0, 256, 256, 6, out.data());
+            doNotOptimize(out[0]);
+        }
+        state.addItems(state.iterations() * 256 * 256);
+    });
+}
+
+void registerCache(BenchmarkRunner& runner) {
+    // Sweep 64 chunks through a cache budgeted for 32, so every access to a
+    // chunk evicted on the previous sweep regenerates it
+    static const CachePolicy policies[] = {CACHE_POLICY_LRU, CACHE_POLICY_CLOCK};
+    for (CachePolicy policy : policies) {
+        std::string name = std::string("BM_CacheEviction/") + (policy == CACHE_POLICY_LRU ? "lru" : "clock");
+        runner.run(name, [policy](BenchmarkState& state) {
+            TerrainGenerator terrain(8 * kChunkSize, 8 * kChunkSize, 250, kChunkSize, kSeed);
+            configure(terrain);
+            terrain.setCachePolicy(policy);
+            terrain.setCacheBudget(32ull * kChunkSize * kChunkSize * sizeof(float));
+
+            for (uint64_t i = 0; i < state.iterations(); i++) {
+                int chunk = static_cast<int>(i % 64);
+                ChunkPtr data = terrain.getChunk(chunk / 8, chunk % 8);
+                doNotOptimize(data);
+            }
+
+            CacheStats stats = terrain.getCacheStats();
+            uint64_t lookups = stats.hits + stats.misses;
+            state.counters.push_back({"hit_rate", lookups > 0 ? static_cast<double>(stats.hits) / lookups : 0.0});
+            state.counters.push_back({"evictions", static_cast<double>(stats.evictions)});
+            state.addItems(state.iterations());
+        });
+    }
+}
+
+void registerBuffers(BenchmarkRunner& runner) {
+    // Stream chunk-sized buffers through a window of 64 live chunks, filling
+    // each one as generation would: pooled buffers against a fresh heap
+    // vector per chunk, as chunks were stored before the pool
+    const size_t cells = static_cast<size_t>(kChunkSize) * kChunkSize;
+    runner.run("BM_ChunkBuffer/heap", [cells](BenchmarkState& state) {
+        std::vector<std::vector<float>> window(64);
+        for (uint64_t i = 0; i < state.iterations(); i++) {
+            std::vector<float> buffer(cells, 0.0f);
+            std::fill(buffer.begin(), buffer.end(), static_cast<float>(i));
+            window[i % window.size()] = std::move(buffer);
+        }
+        doNotOptimize(window);
+        state.addItems(state.iterations());
+    });
+
+    static const bool hugePages[] = {false, true};
+    for (bool huge : hugePages) {
+        runner.run(huge ? "BM_ChunkBuffer/pool_huge_pages" : "BM_ChunkBuffer/pool", [huge, cells](BenchmarkState& state) {
+            std::shared_ptr<ChunkBufferPool> pool = std::make_shared<ChunkBufferPool>(cells, huge);
+            std::vector<ChunkPtr> window(64);
+            for (uint64_t i = 0; i < state.iterations(); i++) {
+                ChunkPtr chunk = std::make_shared<ChunkData>(pool);
+                std::fill(chunk->data(), chunk->data() + cells, static_cast<float>(i));
+                window[i % window.size()] = std::move(chunk);
+            }
+            doNotOptimize(window);
+            state.addItems(state.iterations());
+        });
+    }
+}
+
+void registerPaths(BenchmarkRunner& runner) {
+    // Fixed start/goal pairs on a fixed 2048^2 world. Landmark tables are
+    // prepared, and chunks and any cached per-chunk annotations are built by
+    // an untimed first search, so only the searches themselves are measured
+    struct PathCase {
+        const char* name;
+        int algorithm;
+        PathHeuristic heuristic;
+        int startX, startY, goalX, goalY;
+    };
+    static const PathCase cases[] = {
+        {"BM_FindPath/astar/short", PATH_ALGORITHM_ASTAR, PATH_HEURISTIC_OCTILE_CLIMB, 100, 100, 400, 350},
+        {"BM_FindPath/astar/long", PATH_ALGORITHM_ASTAR, PATH_HEURISTIC_OCTILE_CLIMB, 100, 1500, 1400, 200},
+        {"BM_FindPath/astar_manhattan/long", PATH_ALGORITHM_ASTAR, PATH_HEURISTIC_MANHATTAN, 100, 1500, 1400, 200},
+        {"BM_FindPath/astar_landmarks/long", PATH_ALGORITHM_ASTAR, PATH_HEURISTIC_LANDMARKS, 100, 1500, 1400, 200},
+        {"BM_FindPath/hpa/long", PATH_ALGORITHM_HIERARCHICAL, PATH_HEURISTIC_OCTILE_CLIMB, 100, 1500, 1400, 200},
+        {"BM_FindPath/jps/long", PATH_ALGORITHM_JUMP_POINT, PATH_HEURISTIC_OCTILE_CLIMB, 100, 1500, 1400, 200},
+    };
+
+    for (const PathCase& pathCase : cases) {
+        runner.run(pathCase.name, [&pathCase](BenchmarkState& state) {
+            state.pause();
+            TerrainGenerator terrain(2048, 2048, 250, kChunkSize, kSeed);
+            configure(terrain);
+            terrain.setPathHeuristic(pathCase.heuristic, 8);
+            std::vector<float> warm(2048 * 2048);
+            terrain.getRegion(0, 0, 2048, 2048, 1, warm.data());
+            if (pathCase.heuristic == PATH_HEURISTIC_LANDMARKS) {
+                terrain_prepare_landmarks(&terrain, 3.0, nullptr, 0);
+            }
+            std::vector<int> buffer(2 * 65536);
+            int length = terrain_find_path_with(&terrain, pathCase.algorithm, pathCase.startX, pathCase.startY,
+                                                pathCase.goalX, pathCase.goalY, 3.0, 0, buffer.data(),
+                                                static_cast<int>(buffer.size() / 2));
+            state.resume();
+
+            for (uint64_t i = 0; i < state.iterations(); i++) {
+                length = terrain_find_path_with(&terrain, pathCase.algorithm, pathCase.startX, pathCase.startY,
+                                                pathCase.goalX, pathCase.goalY, 3.0, 0, buffer.data(),
+                                                static_cast<int>(buffer.size() / 2));
+            }
+            state.counters.push_back({"path_length", static_cast<double>(length)});
+        });
+    }
+}
+
+void registerClearance(BenchmarkRunner& runner) {
+    // Clearance fields for a warm 4x4 chunk block, built for one chunk and
+    // for the block on the worker pool, and the long A* path above keeping
+    // 2 cells from obstacles and steep cells and preferring 4
+    for (int chunks : {1, 16}) {
+        runner.run("BM_Clearance/build/chunks:" + std::to_string(chunks), [chunks](BenchmarkState& state) {
+            state.pause();
+            TerrainGenerator terrain(6 * kChunkSize, 6 * kChunkSize, 250, kChunkSize, kSeed);
+            configure(terrain);
+            std::vector<float> warm(36 * kChunkSize * kChunkSize);
+            terrain.getRegion(0, 0, 6 * kChunkSize, 6 * kChunkSize, 1, warm.data());
+            std::vector<int> coords;
+            std::vector<ChunkPtr> block;
+            for (int c = 0; c < chunks; c++) {
+                coords.push_back(1 + c / 4);
+                coords.push_back(1 + c % 4);
+                block.push_back(terrain.getChunk(1 + c / 4, 1 + c % 4));
+            }
+            state.resume();
+
+            for (uint64_t i = 0; i < state.iterations(); i++) {
+                for (const ChunkPtr& chunk : block) {
+                    chunk->clearAnnotations();
+                }
+                terrain_prepare_clearance(&terrain, coords.data(), chunks);
+            }
+            state.addItems(state.iterations() * chunks * kChunkSize * kChunkSize);
+        });
+    }
+
+    runner.run("BM_FindPath/astar_clearance/long", [](BenchmarkState& state) {
+        state.pause();
+        TerrainGenerator terrain(2048, 2048, 250, kChunkSize, kSeed);
+        configure(terrain);
+        terrain.setPathClearance(2.0, 4.0, 2.0);
+        std::vector<float> warm(2048 * 2048);
+        terrain.getRegion(0, 0, 2048, 2048, 1, warm.data());
+        // The ends above sit close to obstacles; move each to the nearest
+        // cell with the required clearance
+        int ends[4] = {100, 1500, 1400, 200};
+        for (int e = 0; e < 2; e++) {
+            int* end = &ends[2 * e];
+            bool found = false;
+            for (int r = 0; !found; r++) {
+                for (int dx = -r; dx <= r && !found; dx++) {
+                    for (int dy = -r; dy <= r && !found; dy++) {
+                        int x = end[0] + dx;
+                        int y = end[1] + dy;
+                        float clearance = 0.0f;
+                        terrain_get_clearances(&terrain, &x, &y, 1, &clearance);
+                        if (clearance >= 2.0f) {
+                            end[0] = x;
+                            end[1] = y;
+                            found = true;
+                        }
+                    }
+                }
+            }
+        }
+        std::vector<int> buffer(2 * 65536);
+        int length = terrain_find_path(&terrain, ends[0], ends[1], ends[2], ends[3], 3.0, 0, buffer.data(),
+                                       static_cast<int>(buffer.size() / 2));
+        state.resume();
+
+        for (uint64_t i = 0; i < state.iterations(); i++) {
+            length = terrain_find_path(&terrain, ends[0], ends[1], ends[2], ends[3], 3.0, 0, buffer.data(),
+                                       static_cast<int>(buffer.size() / 2));
+        }
+        state.counters.push_back({"path_length", static_cast<double>(length)});
+    });
+}
+
+void registerLayouts(BenchmarkRunner& runner) {
+    // The same work over each chunk cell layout: A* expansions per second on
+    // the long path above, and the 4-neighbour fetch of the renderer's
+    // lighting over a warm 4x4 chunk block, walking y inside x like it does
+    struct LayoutCase {
+        const char* name;
+        ChunkLayout layout;
+    };
+    static const LayoutCase layouts[] = {
+        {"linear", CHUNK_LAYOUT_LINEAR},
+        {"tiled8", CHUNK_LAYOUT_TILED},
+        {"morton", CHUNK_LAYOUT_MORTON},
+    };
+
+    for (const LayoutCase& layout : layouts) {
+        runner.run(std::string("BM_Layout/astar_expansions/") + layout.name, [&layout](BenchmarkState& state) {
+            state.pause();
+            TerrainGenerator terrain(2048, 2048, 250, kChunkSize, kSeed);
+            configure(terrain);
+            terrain.setChunkLayout(layout.layout);
+            std::vector<float> warm(2048 * 2048);
+            terrain.getRegion(0, 0, 2048, 2048, 1, warm.data());
+            PathFinder pathfinder(terrain);
+            pathfinder.findPath(100, 1500, 1400, 200, 3.0, 0);
+            state.resume();
+
+            uint64_t expansions = 0;
+            for (uint64_t i = 0; i < state.iterations(); i++) {
+                std::vector<std::pair<int, int>> path = pathfinder.findPath(100, 1500, 1400, 200, 3.0, 0);
+                doNotOptimize(path);
+                expansions += pathfinder.getExpansions();
+            }
+            state.addItems(expansions);
+        });
+
+        runner.run(std::string("BM_Layout/lighting/") + layout.name, [&layout](BenchmarkState& state) {
+            state.pause();
+            TerrainGenerator terrain(4 * kChunkSize, 4 * kChunkSize, 250, kChunkSize, kSeed);
+            configure(terrain);
+            terrain.setChunkLayout(layout.layout);
+            std::vector<ChunkPtr> chunks;
+            for (int c = 0; c < 16; c++) {
+                chunks.push_back(terrain.getChunk(c / 4, c % 4));
+            }
+            state.resume();
+
+            // Lambert shading with light from (-1, -1, -1), as in gui.py
+            const float lx = -0.57735f, ly = -0.57735f, lz = -0.57735f;
+            float sum = 0.0f;
+            for (uint64_t i = 0; i < state.iterations(); i++) {
+                const ChunkData& chunk = *chunks[i % chunks.size()];
+                for (int x = 1; x < kChunkSize - 1; x++) {
+                    for (int y = 1; y < kChunkSize - 1; y++) {
+                        float dx = chunk.at(x + 1, y) - chunk.at(x - 1, y);
+                        float dy = chunk.at(x, y + 1) - chunk.at(x, y - 1);
+                        float length = std::max(0.001f, std::sqrt(dx * dx + dy * dy));
+                        float diffuse = (dx * lx + dy * ly + lz) / length;
+                        sum += diffuse > 0.0f ? diffuse : 0.0f;
+                    }
+                }
+            }
+            doNotOptimize(sum);
+            state.addItems(state.iterations() * (kChunkSize - 2) * (kChunkSize - 2));
+        });
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double minTime = 0.5;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 9, "--filter=") == 0) {
+            filter = arg.substr(9);
+        } else if (arg.compare(0, 11, "--min_time=") == 0) {
+            minTime = std::atof(arg.c_str() + 11);
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter=SUBSTRING] [--min_time=SECONDS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    BenchmarkRunner runner(filter, minTime);
+    registerNoise(runner);
+    registerElevation(runner);
+    registerRegions(runner);
+    registerCache(runner);
+    registerBuffers(runner);
+    registerPaths(runner);
+    registerClearance(runner);
+    registerLayouts(runner);
+    runner.printJson();
+    return 0;
+}
@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""
+Python-side benchmarks for the terrain generator wrapper.
+
+Measures what the ctypes boundary in terrain_wrapper.py costs on top of the
+native work reported by `make bench`: the same fixed world and queries are
+timed through the wrapper, and per-call results are compared with a raw call
+into the library so the marshalling overhead can be read off directly.
+Results are printed as JSON in the same layout as the C++ benchmark.
+
+Usage: python3 benchmark.py [--filter=SUBSTRING] [--min_time=SECONDS]
+"""
+
+import json
+import os
+import sys
+import time
+
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from terrain_generator import terrain_wrapper
+from terrain_generator.terrain_wrapper import TerrainGenerator, PATH_ALGORITHM_ASTAR, PATH_ALGORITHM_HIERARCHICAL
+
+# Fixed world matching benchmark.cpp
+SEED = 42
+CHUNK_SIZE = 256
+
+
+class BenchmarkRunner:
+    """Runs benchmark bodies until they last long enough and collects results."""
+
+    def __init__(self, name_filter='', min_time=0.5):
+        self.name_filter = name_filter
+        self.min_time = min_time
+        self.results = []
+
+    def run(self, name, body, items_per_iteration=0, setup=None):
+        """
+        Time body with growing iteration counts until one run lasts min_time.
+
+        Args:
+            name (str): Benchmark name
+            body (callable): Called with the iteration count; runs the operation that many times
+            items_per_iteration (int): Items processed per iteration, for items_per_second
+            setup (callable): Untimed preparation run once before timing
+        """
+        if self.name_filter and self.name_filter not in name:
+            return
+        if setup:
+            setup()
+
+        iterations = 1
+        while True:
+            started = time.perf_counter()
+            body(iterations)
+            seconds = time.perf_counter() - started
+
+            if seconds >= self.min_time or iterations >= 1 << 30:
+                result = {
+                    'name': name,
+                    'run_type': 'iteration',
+                    'iterations': iterations,
+                    'real_time': seconds * 1e9 / iterations,
+                    'cpu_time': seconds * 1e9 / iterations,
+                    'time_unit': 'ns',
+                }
+                if items_per_iteration and seconds > 0:
+                    result['items_per_second'] = items_per_iteration * iterations / seconds
+                self.results.append(result)
+                print('%-48s %12.0f ns %10d' % (name, result['real_time'], iterations), file=sys.stderr)
+                return
+
+            scale = self.min_time * 1.4 / seconds if seconds > 0 else 10.0
+            iterations = int(iterations * max(1.5, min(10.0, scale))) + 1
+
+    def to_json(self):
+        """Return the collected results in Google Benchmark's JSON layout."""
+        return json.dumps({
+            'context': {
+                'library': 'terrain_wrapper',
+                'num_cpus': os.cpu_count(),
+                'min_time': self.min_time,
+            },
+            'benchmarks': self.results,
+        }, indent=2)
+
+
+def make_terrain(size):
+    """Create the fixed benchmark world with every chunk already generated."""
+    terrain = TerrainGenerator(size, size, 250, CHUNK_SIZE, SEED)
+    terrain.set_parameters(0.01, 6, 0.5, 2.0, 0.05)
+    terrain.get_region(0, 0, size, size)
+    return terrain
+
+
+def register_calls(runner, terrain):
+    """Per-call overhead: wrapper methods against raw ctypes calls."""
+    lib = terrain_wrapper._lib
+    handle = terrain._terrain
+    rng = np.random.default_rng(SEED)
+    xs = rng.integers(0, terrain.width, 4096).tolist()
+    ys = rng.integers(0, terrain.height, 4096).tolist()
+
+    def raw_get_elevation(iterations):
+        for i in range(iterations):
+            lib.terrain_get_elevation(handle, xs[i & 4095], ys[i & 4095])
+
+    def wrapper_get_elevation(iterations):
+        for i in range(iterations):
+            terrain.get_elevation(xs[i & 4095], ys[i & 4095])
+
+    def wrapper_is_obstacle(iterations):
+        for i in range(iterations):
+            terrain.is_obstacle(xs[i & 4095], ys[i & 4095])
+
+    runner.run('PY_GetElevation/raw_ctypes', raw_get_elevation, 1)
+    runner.run('PY_GetElevation/wrapper', wrapper_get_elevation, 1)
+    runner.run('PY_IsObstacle/wrapper', wrapper_is_obstacle, 1)
+
+
+def register_batches(runner, terrain):
+    """Batch calls, where the fixed ctypes cost is spread over many cells."""
+    rng = np.random.default_rng(SEED)
+    for count in (1, 64, 4096, 65536):
+        xs = rng.integers(0, terrain.width, count).astype(np.int32)
+        ys = rng.integers(0, terrain.height, count).astype(np.int32)
+
+        def body(iterations, xs=xs, ys=ys):
+            for _ in range(iterations):
+                terrain.get_elevations(xs, ys)
+
+        runner.run('PY_GetElevations/batch:%d' % count, body, count)
+
+    for step in (1, 4):
+        def body(iterations, step=step):
+            for _ in range(iterations):
+                terrain.get_region(100, 100, 512, 512, step)
+
+        runner.run('PY_GetRegion/512x512/step:%d' % step, body, 512 * 512)
+
+
+def register_paths(runner, terrain):
+    """Path queries matching benchmark.cpp, including path list conversion."""
+    cases = (
+        ('PY_FindPath/astar/short', PATH_ALGORITHM_ASTAR, (100, 100), (400, 350)),
+        ('PY_FindPath/hpa/long', PATH_ALGORITHM_HIERARCHICAL, (100, 1500), (1400, 200)),
+    )
+    for name, algorithm, start, goal in cases:
+        def body(iterations, algorithm=algorithm, start=start, goal=goal):
+            for _ in range(iterations):
+                terrain.find_path(start, goal, elevation_weight=3.0, algorithm=algorithm)
+
+        def setup(algorithm=algorithm, start=start, goal=goal):
+            terrain.find_path(start, goal, elevation_weight=3.0, algorithm=algorithm)
+
+        runner.run(name, body, setup=setup)
+
+
+def main():
+    name_filter = ''
+    min_time = 0.5
+    for arg in sys.argv[1:]:
+        if arg.startswith('--filter='):
+            name_filter = arg[len('--filter='):]
+        elif arg.startswith('--min_time='):
+            min_time = float(arg[len('--min_time='):])
+        else:
+            print('usage: %s [--filter=SUBSTRING] [--min_time=SECONDS]' % sys.argv[0], file=sys.stderr)
+            return 1
+
+    runner = BenchmarkRunner(name_filter, min_time)
+    terrain = make_terrain(2048)
+    register_calls(runner, terrain)
+    register_batches(runner, terrain)
+    register_paths(runner, terrain)
+    print(runner.to_json())
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
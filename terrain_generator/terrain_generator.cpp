@@ -1,25 +1,56 @@
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <queue>
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <tuple>
 #include <random>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <string>
+#include <cstdio>
+#include <chrono>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <malloc.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Simplex skew and unskew factors for 2D, 0.5 * (sqrt(3) - 1) and
+// (3 - sqrt(3)) / 6, spelled out so they are usable in constant expressions
+static constexpr double kSimplexF2 = 0.3660254037844386;
+static constexpr double kSimplexG2 = 0.21132486540518713;
 
 // SimplexNoise implementation
 class SimplexNoise {
 private:
     std::vector<int> perm;
+    std::vector<int> permMod12;
     
-    const double F2 = 0.5 * (sqrt(3.0) - 1.0);
-    const double G2 = (3.0 - sqrt(3.0)) / 6.0;
+    static constexpr double F2 = kSimplexF2;
+    static constexpr double G2 = kSimplexG2;
     
-    double dot(const int* g, double x, double y) {
+    double dot(const int* g, double x, double y) const {
         return g[0] * x + g[1] * y;
     }
     
-    const int grad3[12][3] = {
+    static constexpr int grad3[12][3] = {
         {1,1,0}, {-1,1,0}, {1,-1,0}, {-1,-1,0},
         {1,0,1}, {-1,0,1}, {1,0,-1}, {-1,0,-1},
         {0,1,1}, {0,-1,1}, {0,1,-1}, {0,-1,-1}
@@ -28,6 +59,7 @@ private:
 public:
     SimplexNoise(int seed) {
         perm.resize(512);
+        permMod12.resize(512);
         std::vector<int> p(256);
         
         // Initialize with values 0-255
@@ -43,9 +75,17 @@ public:
         for (int i = 0; i < 256; i++) {
             perm[i] = perm[i + 256] = p[i];
         }
+        
+        // Gradient indices precomputed for the vectorized kernels
+        for (int i = 0; i < 512; i++) {
+            permMod12[i] = perm[i] % 12;
+        }
     }
     
-    double noise(double xin, double yin) {
+    const int* permTable() const { return perm.data(); }
+    const int* permMod12Table() const { return permMod12.data(); }
+    
+    double noise(double xin, double yin) const {
         double n0, n1, n2; // Noise contributions from the three corners
         
         // Skew the input space to determine which simplex cell we're in
@@ -116,246 +156,7771 @@ public:
     }
 };
 
-// Hash pair for chunk coordinates
-struct ChunkCoordHash {
-    std::size_t operator()(const std::pair<int, int>& p) const {
-        return std::hash<int>()(p.first) ^ (std::hash<int>()(p.second) << 1);
-    }
+// Out-of-class definitions for the odr-used constexpr members (C++14)
+constexpr double SimplexNoise::F2;
+constexpr double SimplexNoise::G2;
+constexpr int SimplexNoise::grad3[12][3];
+
+// SIMD fractal noise
+//
+// Evaluates all octaves of fractal simplex noise for a column of cells at
+// once, several cells per instruction with float lanes. The lattice
+// arithmetic is done relative to an integer anchor cell computed in double
+// precision per column and octave, so the float lanes only ever see small
+// coordinates. Corner contributions are branchless (max(t, 0)^4) and gradient
+// indices come from a precomputed perm % 12 table.
+//
+// Tolerance: compared with the double precision SimplexNoise::noise path the
+// summed noise differs by less than 2e-5 for the settings.json presets
+// (scale 0.01, 4 to 8 octaves), i.e. under 0.002 elevation units at
+// maxElevation 250. All float kernels (scalar, SSE4.1, AVX2, NEON) use the
+// same operation order without FMA, so they agree bit for bit.
+
+// Kernel selection for chunk generation
+enum NoiseKernel {
+    NOISE_KERNEL_AUTO = 0,       // Best kernel supported by this CPU
+    NOISE_KERNEL_REFERENCE = 1,  // Double precision SimplexNoise::noise, one cell at a time
+    NOISE_KERNEL_SCALAR = 2,     // Float kernel, one lane
+    NOISE_KERNEL_SSE41 = 3,
+    NOISE_KERNEL_AVX2 = 4,
+    NOISE_KERNEL_NEON = 5
 };
 
-// Main TerrainGenerator class
-class TerrainGenerator {
-private:
-    int width;
-    int height;
-    int maxElevation;
-    int chunkSize;
-    int seed;
+// One octave of noise for a column of cells, expressed relative to the
+// lattice anchor (anchorI, anchorJ)
+struct NoiseOctave {
+    float localX;     // x relative to the anchor, shared by the whole column
+    float localY;     // y of the first cell relative to the anchor
+    float stepY;      // y distance between consecutive cells
+    int anchorI;
+    int anchorJ;
+    float amplitude;
+};
+
+// x and y components of SimplexNoise::grad3, which is all the 2D noise uses
+static const float kNoiseGradX[12] = {1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0};
+static const float kNoiseGradY[12] = {1, 1, -1, -1, 0, 0, 0, 0, 1, -1, 1, -1};
+
+// Lookup tables shared by the kernels
+struct NoiseTables {
+    const int* perm;       // 512 entries
+    const int* permMod12;  // 512 entries
+    const float* gradX;    // 12 entries
+    const float* gradY;    // 12 entries
+};
+
+// Build the octave parameters for a column starting at (x, y), moving stepY
+// per cell. The anchor is the simplex lattice cell containing (x, y), found
+// in double precision; skewing is linear, so noise(x, y) equals the noise of
+// the anchor-relative point with lattice indices offset by the anchor.
+static NoiseOctave makeNoiseOctave(double x, double y, double stepY, double amplitude) {
+    double s = (x + y) * kSimplexF2;
+    int anchorI = static_cast<int>(std::floor(x + s));
+    int anchorJ = static_cast<int>(std::floor(y + s));
+    double t = (anchorI + anchorJ) * kSimplexG2;
     
-    double scale;
-    int octaves;
-    double persistence;
-    double lacunarity;
-    double obstacleProb;
+    NoiseOctave octave;
+    octave.localX = static_cast<float>(x - (anchorI - t));
+    octave.localY = static_cast<float>(y - (anchorJ - t));
+    octave.stepY = static_cast<float>(stepY);
+    octave.anchorI = anchorI;
+    octave.anchorJ = anchorJ;
+    octave.amplitude = static_cast<float>(amplitude);
+    return octave;
+}
+
+// Single float lane, used where no vector unit is available
+struct ScalarLanes {
+    typedef float F;
+    typedef int I;
+    static const int width = 1;
     
-    SimplexNoise noiseGen;
+    static F set1(float v) { return v; }
+    static I set1i(int v) { return v; }
+    static F laneIndex() { return 0.0f; }
+    static F add(F a, F b) { return a + b; }
+    static F sub(F a, F b) { return a - b; }
+    static F mul(F a, F b) { return a * b; }
+    static F max(F a, F b) { return a > b ? a : b; }
+    static F floor(F a) { return std::floor(a); }
+    static I toInt(F a) { return static_cast<int>(a); }
+    static F toFloat(I a) { return static_cast<float>(a); }
+    static I addi(I a, I b) { return a + b; }
+    static I andi(I a, I b) { return a & b; }
+    static I greaterThan(F a, F b) { return a > b ? 1 : 0; }
+    static I gather(const int* table, I index) { return table[index]; }
+    static F gather(const float* table, I index) { return table[index]; }
+    static void store(float* out, F v) { *out = v; }
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+struct Sse41Lanes {
+    typedef __m128 F;
+    typedef __m128i I;
+    static const int width = 4;
     
-    // Cache of generated chunks
-    std::unordered_map<std::pair<int, int>, std::vector<float>, ChunkCoordHash> chunks;
-    std::mt19937 rng;
+    static F set1(float v) { return _mm_set1_ps(v); }
+    static I set1i(int v) { return _mm_set1_epi32(v); }
+    static F laneIndex() { return _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f); }
+    static F add(F a, F b) { return _mm_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F max(F a, F b) { return _mm_max_ps(a, b); }
+    static F floor(F a) { return _mm_floor_ps(a); }
+    static I toInt(F a) { return _mm_cvttps_epi32(a); }
+    static F toFloat(I a) { return _mm_cvtepi32_ps(a); }
+    static I addi(I a, I b) { return _mm_add_epi32(a, b); }
+    static I andi(I a, I b) { return _mm_and_si128(a, b); }
+    static I greaterThan(F a, F b) { return _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(a, b)), _mm_set1_epi32(1)); }
+    static I gather(const int* table, I index) {
+        alignas(16) int lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), index);
+        return _mm_set_epi32(table[lanes[3]], table[lanes[2]], table[lanes[1]], table[lanes[0]]);
+    }
+    static F gather(const float* table, I index) {
+        alignas(16) int lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), index);
+        return _mm_set_ps(table[lanes[3]], table[lanes[2]], table[lanes[1]], table[lanes[0]]);
+    }
+    static void store(float* out, F v) { _mm_storeu_ps(out, v); }
+};
+#pragma GCC pop_options
 
-public:
-    TerrainGenerator(int width, int height, int maxElevation, int chunkSize, int seed) 
-        : width(width), height(height), maxElevation(maxElevation), chunkSize(chunkSize), 
-          seed(seed), noiseGen(seed), rng(seed) {
-        
-        // Default terrain parameters
-        scale = 0.01;
-        octaves = 6;
-        persistence = 0.5;
-        lacunarity = 2.0;
-        obstacleProb = 0.2;
+#pragma GCC push_options
+#pragma GCC target("avx2")
+struct Avx2Lanes {
+    typedef __m256 F;
+    typedef __m256i I;
+    static const int width = 8;
+    
+    static F set1(float v) { return _mm256_set1_ps(v); }
+    static I set1i(int v) { return _mm256_set1_epi32(v); }
+    static F laneIndex() { return _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f); }
+    static F add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F max(F a, F b) { return _mm256_max_ps(a, b); }
+    static F floor(F a) { return _mm256_floor_ps(a); }
+    static I toInt(F a) { return _mm256_cvttps_epi32(a); }
+    static F toFloat(I a) { return _mm256_cvtepi32_ps(a); }
+    static I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+    static I andi(I a, I b) { return _mm256_and_si256(a, b); }
+    static I greaterThan(F a, F b) {
+        return _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ)), _mm256_set1_epi32(1));
     }
+    static I gather(const int* table, I index) { return _mm256_i32gather_epi32(table, index, 4); }
+    static F gather(const float* table, I index) { return _mm256_i32gather_ps(table, index, 4); }
+    static void store(float* out, F v) { _mm256_storeu_ps(out, v); }
+};
+#pragma GCC pop_options
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+
+struct NeonLanes {
+    typedef float32x4_t F;
+    typedef int32x4_t I;
+    static const int width = 4;
     
-    // Set terrain generation parameters
-    void setParameters(double scale, int octaves, double persistence, double lacunarity, double obstacleProb) {
-        this->scale = scale;
-        this->octaves = octaves;
-        this->persistence = persistence;
-        this->lacunarity = lacunarity;
-        this->obstacleProb = obstacleProb;
+    static F set1(float v) { return vdupq_n_f32(v); }
+    static I set1i(int v) { return vdupq_n_s32(v); }
+    static F laneIndex() {
+        static const float lanes[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+        return vld1q_f32(lanes);
+    }
+    static F add(F a, F b) { return vaddq_f32(a, b); }
+    static F sub(F a, F b) { return vsubq_f32(a, b); }
+    static F mul(F a, F b) { return vmulq_f32(a, b); }
+    static F max(F a, F b) { return vmaxq_f32(a, b); }
+    static F floor(F a) {
+        // Truncate, then step down where truncation rounded up
+        F truncated = vcvtq_f32_s32(vcvtq_s32_f32(a));
+        uint32x4_t roundedUp = vcgtq_f32(truncated, a);
+        return vsubq_f32(truncated, vbslq_f32(roundedUp, vdupq_n_f32(1.0f), vdupq_n_f32(0.0f)));
+    }
+    static I toInt(F a) { return vcvtq_s32_f32(a); }
+    static F toFloat(I a) { return vcvtq_f32_s32(a); }
+    static I addi(I a, I b) { return vaddq_s32(a, b); }
+    static I andi(I a, I b) { return vandq_s32(a, b); }
+    static I greaterThan(F a, F b) { return vandq_s32(vreinterpretq_s32_u32(vcgtq_f32(a, b)), vdupq_n_s32(1)); }
+    static I gather(const int* table, I index) {
+        int lanes[4];
+        vst1q_s32(lanes, index);
+        int values[4] = {table[lanes[0]], table[lanes[1]], table[lanes[2]], table[lanes[3]]};
+        return vld1q_s32(values);
+    }
+    static F gather(const float* table, I index) {
+        int lanes[4];
+        vst1q_s32(lanes, index);
+        float values[4] = {table[lanes[0]], table[lanes[1]], table[lanes[2]], table[lanes[3]]};
+        return vld1q_f32(values);
     }
+    static void store(float* out, F v) { vst1q_f32(out, v); }
+};
+#endif
+
+// Sum all octaves of noise for n consecutive cells of a column. Written once
+// against the lane interface above and instantiated per instruction set. It
+// is always inlined into a function compiled for the matching target, so
+// the vector ABI warning for the generic instantiation does not apply.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+template <typename V>
+__attribute__((always_inline)) inline void fractalNoiseKernel(const NoiseTables& tables, const NoiseOctave* octaves, int octaveCount,
+                               int n, float* out) {
+    typedef typename V::F F;
+    typedef typename V::I I;
     
-    // Get chunk by coordinates
-    std::vector<float> generateChunk(int chunkX, int chunkY) {
-        // Check if chunk already exists in cache
-        std::pair<int, int> chunkKey(chunkX, chunkY);
-        if (chunks.find(chunkKey) != chunks.end()) {
-            return chunks[chunkKey];
-        }
-        
-        // Create a new chunk
-        std::vector<float> chunk(chunkSize * chunkSize, 0.0f);
-        
-        // Calculate absolute position of chunk
-        int absX = chunkX * chunkSize;
-        int absY = chunkY * chunkSize;
-        
-        // Generate elevation values using simplex noise
-        std::uniform_real_distribution<double> dist(0.0, 1.0);
+    constexpr float F2 = static_cast<float>(kSimplexF2);
+    constexpr float G2 = static_cast<float>(kSimplexG2);
+    
+    const F f2 = V::set1(F2);
+    const F g2 = V::set1(G2);
+    const F g2x2MinusOne = V::set1(2.0f * G2 - 1.0f);
+    const F half = V::set1(0.5f);
+    const F zero = V::set1(0.0f);
+    const I oneI = V::set1i(1);
+    const I byteMask = V::set1i(255);
+    const F lanes = V::laneIndex();
+    
+    float tail[8];
+    
+    for (int k = 0; k < n; k += V::width) {
+        F sum = zero;
+        F cell = V::add(V::set1(static_cast<float>(k)), lanes);
         
-        for (int x = 0; x < chunkSize; x++) {
-            for (int y = 0; y < chunkSize; y++) {
-                // Calculate absolute coordinates
-                int worldX = absX + x;
-                int worldY = absY + y;
-                
-                // Generate elevation using multiple octaves of noise
-                double elevation = 0.0;
-                double amplitude = 1.0;
-                double frequency = 1.0;
-                
-                for (int i = 0; i < octaves; i++) {
-                    double nx = worldX * scale * frequency;
-                    double ny = worldY * scale * frequency;
-                    
-                    // Add noise contribution for this octave
-                    elevation += noiseGen.noise(nx, ny) * amplitude;
-                    
-                    // Update amplitude and frequency for next octave
-                    amplitude *= persistence;
-                    frequency *= lacunarity;
-                }
-                
-                // Normalize elevation to [0, 1] range
-                elevation = (elevation + 1.0) / 2.0;
-                
-                // Scale to max elevation
-                elevation *= maxElevation;
-                
-                // Randomly place obstacles (represented by -1)
-                if (dist(rng) < obstacleProb) {
-                    chunk[x * chunkSize + y] = -1.0f;
-                } else {
-                    chunk[x * chunkSize + y] = static_cast<float>(elevation);
-                }
-            }
+        for (int o = 0; o < octaveCount; o++) {
+            const NoiseOctave& octave = octaves[o];
+            F xin = V::set1(octave.localX);
+            F yin = V::add(V::set1(octave.localY), V::mul(cell, V::set1(octave.stepY)));
+            
+            // Skew the input space to find the simplex cell
+            F s = V::mul(V::add(xin, yin), f2);
+            F fi = V::floor(V::add(xin, s));
+            F fj = V::floor(V::add(yin, s));
+            
+            F t = V::mul(V::add(fi, fj), g2);
+            F x0 = V::sub(xin, V::sub(fi, t));
+            F y0 = V::sub(yin, V::sub(fj, t));
+            
+            // Middle corner offsets: (1, 0) in the lower triangle, (0, 1) in the upper
+            I i1 = V::greaterThan(x0, y0);
+            I j1 = V::andi(V::addi(i1, oneI), oneI);
+            F i1f = V::toFloat(i1);
+            F j1f = V::toFloat(j1);
+            
+            F x1 = V::add(V::sub(x0, i1f), g2);
+            F y1 = V::add(V::sub(y0, j1f), g2);
+            F x2 = V::add(x0, g2x2MinusOne);
+            F y2 = V::add(y0, g2x2MinusOne);
+            
+            // Hashed gradient indices of the three corners
+            I ii = V::andi(V::addi(V::toInt(fi), V::set1i(octave.anchorI)), byteMask);
+            I jj = V::andi(V::addi(V::toInt(fj), V::set1i(octave.anchorJ)), byteMask);
+            I gi0 = V::gather(tables.permMod12, V::addi(ii, V::gather(tables.perm, jj)));
+            I gi1 = V::gather(tables.permMod12,
+                              V::addi(V::addi(ii, i1), V::gather(tables.perm, V::addi(jj, j1))));
+            I gi2 = V::gather(tables.permMod12,
+                              V::addi(V::addi(ii, oneI), V::gather(tables.perm, V::addi(jj, oneI))));
+            
+            // Corner contributions, zero outside the kernel radius
+            F t0 = V::max(V::sub(V::sub(half, V::mul(x0, x0)), V::mul(y0, y0)), zero);
+            F t1 = V::max(V::sub(V::sub(half, V::mul(x1, x1)), V::mul(y1, y1)), zero);
+            F t2 = V::max(V::sub(V::sub(half, V::mul(x2, x2)), V::mul(y2, y2)), zero);
+            t0 = V::mul(t0, t0);
+            t1 = V::mul(t1, t1);
+            t2 = V::mul(t2, t2);
+            
+            F n0 = V::mul(V::mul(t0, t0), V::add(V::mul(V::gather(tables.gradX, gi0), x0),
+                                                 V::mul(V::gather(tables.gradY, gi0), y0)));
+            F n1 = V::mul(V::mul(t1, t1), V::add(V::mul(V::gather(tables.gradX, gi1), x1),
+                                                 V::mul(V::gather(tables.gradY, gi1), y1)));
+            F n2 = V::mul(V::mul(t2, t2), V::add(V::mul(V::gather(tables.gradX, gi2), x2),
+                                                 V::mul(V::gather(tables.gradY, gi2), y2)));
+            
+            F value = V::mul(V::set1(70.0f), V::add(V::add(n0, n1), n2));
+            sum = V::add(sum, V::mul(value, V::set1(octave.amplitude)));
         }
         
-        // Store the generated chunk in cache
-        chunks[chunkKey] = chunk;
-        
-        return chunk;
+        if (k + V::width <= n) {
+            V::store(out + k, sum);
+        } else {
+            V::store(tail, sum);
+            std::copy(tail, tail + (n - k), out + k);
+        }
     }
-    
-    // Get elevation at specified world coordinates
-    float getElevation(int x, int y) {
-        // Check if coordinates are within bounds
-        if (x < 0 || x >= width || y < 0 || y >= height) {
-            return -1.0f;  // Out of bounds - treated as obstacle
+}
+#pragma GCC diagnostic pop
+
+static void fractalNoiseScalar(const NoiseTables& tables, const NoiseOctave* octaves, int octaveCount,
+                               int n, float* out) {
+    fractalNoiseKernel<ScalarLanes>(tables, octaves, octaveCount, n, out);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+__attribute__((flatten))
+static void fractalNoiseSse41(const NoiseTables& tables, const NoiseOctave* octaves, int octaveCount,
+                              int n, float* out) {
+    fractalNoiseKernel<Sse41Lanes>(tables, octaves, octaveCount, n, out);
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+__attribute__((flatten))
+static void fractalNoiseAvx2(const NoiseTables& tables, const NoiseOctave* octaves, int octaveCount,
+                             int n, float* out) {
+    fractalNoiseKernel<Avx2Lanes>(tables, octaves, octaveCount, n, out);
+}
+#pragma GCC pop_options
+#endif
+
+#if defined(__ARM_NEON)
+static void fractalNoiseNeon(const NoiseTables& tables, const NoiseOctave* octaves, int octaveCount,
+                             int n, float* out) {
+    fractalNoiseKernel<NeonLanes>(tables, octaves, octaveCount, n, out);
+}
+#endif
+
+// Whether this CPU can run the given kernel
+static bool noiseKernelSupported(NoiseKernel kernel) {
+    switch (kernel) {
+        case NOISE_KERNEL_REFERENCE:
+        case NOISE_KERNEL_SCALAR:
+            return true;
+#if defined(__x86_64__) || defined(__i386__)
+        case NOISE_KERNEL_SSE41:
+            return __builtin_cpu_supports("sse4.1");
+        case NOISE_KERNEL_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#if defined(__ARM_NEON)
+        case NOISE_KERNEL_NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+// Fastest kernel supported by this CPU
+static NoiseKernel bestNoiseKernel() {
+    static const NoiseKernel preference[] = {
+        NOISE_KERNEL_AVX2, NOISE_KERNEL_NEON, NOISE_KERNEL_SSE41, NOISE_KERNEL_SCALAR
+    };
+    for (NoiseKernel kernel : preference) {
+        if (noiseKernelSupported(kernel)) {
+            return kernel;
         }
-        
-        // Calculate chunk coordinates
-        int chunkX = x / chunkSize;
-        int chunkY = y / chunkSize;
-        
-        // Calculate local coordinates within chunk
-        int localX = x % chunkSize;
-        int localY = y % chunkSize;
-        
-        // Get or generate the chunk
-        std::vector<float> chunk = generateChunk(chunkX, chunkY);
-        
-        // Return elevation at specified position
-        return chunk[localX * chunkSize + localY];
     }
+    return NOISE_KERNEL_SCALAR;
+}
+
+// Run the selected float kernel over n cells of a column
+static void fractalNoiseColumn(NoiseKernel kernel, const NoiseTables& tables, const NoiseOctave* octaves,
+                               int octaveCount, int n, float* out) {
+    switch (kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+        case NOISE_KERNEL_AVX2:
+            fractalNoiseAvx2(tables, octaves, octaveCount, n, out);
+            return;
+        case NOISE_KERNEL_SSE41:
+            fractalNoiseSse41(tables, octaves, octaveCount, n, out);
+            return;
+#endif
+#if defined(__ARM_NEON)
+        case NOISE_KERNEL_NEON:
+            fractalNoiseNeon(tables, octaves, octaveCount, n, out);
+            return;
+#endif
+        default:
+            fractalNoiseScalar(tables, octaves, octaveCount, n, out);
+            return;
+    }
+}
+
+// Compile-time specialized fractal noise
+//
+// The settings.json presets (4, 6 or 8 octaves over 64, 128 or 256 cell
+// chunks, persistence 0.5, lacunarity 2.0) get their own instantiations of
+// the column kernel with the octave and cell counts as constants, so the
+// octave loop unrolls, the tail store folds away and the octave amplitude
+// and frequency tables are built by the compiler. Powers of two are exact
+// in double, so the tables match the runtime products bit for bit and the
+// specialized kernels produce the same chunks as the generic path.
+static constexpr double kPresetPersistence = 0.5;
+static constexpr double kPresetLacunarity = 2.0;
+
+// Amplitude and frequency of each octave at the preset persistence and
+// lacunarity
+template <int Octaves>
+struct PresetOctaveTable {
+    double amplitude[Octaves];
+    double frequency[Octaves];
     
-    // Check if a position is an obstacle
-    bool isObstacle(int x, int y) {
-        return getElevation(x, y) < 0;
+    constexpr PresetOctaveTable() : amplitude(), frequency() {
+        double a = 1.0;
+        double f = 1.0;
+        for (int i = 0; i < Octaves; i++) {
+            amplitude[i] = a;
+            frequency[i] = f;
+            a *= kPresetPersistence;
+            f *= kPresetLacunarity;
+        }
     }
+};
+
+template <int Octaves, int ChunkSize>
+struct FractalNoise {
+    static_assert(Octaves > 0 && ChunkSize > 0, "FractalNoise needs at least one octave and one cell");
     
-    // Unload distant chunks to save memory
-    void unloadDistantChunks(int centerX, int centerY, int maxViewRadius) {
-        int centerChunkX = centerX / chunkSize;
-        int centerChunkY = centerY / chunkSize;
-        
-        // Find chunks to remove
-        std::vector<std::pair<int, int>> chunksToRemove;
-        
-        for (const auto& entry : chunks) {
-            int chunkX = entry.first.first;
-            int chunkY = entry.first.second;
-            
-            // Calculate Manhattan distance to center chunk
-            int dx = std::abs(chunkX - centerChunkX);
-            int dy = std::abs(chunkY - centerChunkY);
-            int distance = dx + dy;
-            
-            // If chunk is too far, mark for removal
-            if (distance > maxViewRadius) {
-                chunksToRemove.push_back(entry.first);
-            }
+    // Octave parameters for a column of ChunkSize cells starting at world
+    // cell (worldX, worldY), stride cells apart
+    static void columnOctaves(int worldX, int worldY, int stride, double scale, NoiseOctave* out) {
+        constexpr PresetOctaveTable<Octaves> table;
+        for (int i = 0; i < Octaves; i++) {
+            out[i] = makeNoiseOctave(worldX * scale * table.frequency[i], worldY * scale * table.frequency[i],
+                                     stride * scale * table.frequency[i], table.amplitude[i]);
         }
-        
-        // Remove distant chunks
-        for (const auto& key : chunksToRemove) {
-            chunks.erase(key);
+    }
+    
+    // Sum the octaves for one column with the selected kernel
+    static void column(NoiseKernel kernel, const NoiseTables& tables, const NoiseOctave* octaves, float* out) {
+        switch (kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+            case NOISE_KERNEL_AVX2:
+                avx2(tables, octaves, out);
+                return;
+            case NOISE_KERNEL_SSE41:
+                sse41(tables, octaves, out);
+                return;
+#endif
+#if defined(__ARM_NEON)
+            case NOISE_KERNEL_NEON:
+                fractalNoiseKernel<NeonLanes>(tables, octaves, Octaves, ChunkSize, out);
+                return;
+#endif
+            default:
+                fractalNoiseKernel<ScalarLanes>(tables, octaves, Octaves, ChunkSize, out);
+                return;
         }
     }
     
-    // Get visible chunks from center point
-    std::vector<std::pair<int, int>> getVisibleChunks(int centerX, int centerY, int viewRadius) {
-        int centerChunkX = centerX / chunkSize;
-        int centerChunkY = centerY / chunkSize;
-        
-        std::vector<std::pair<int, int>> visibleChunks;
-        
-        for (int dx = -viewRadius; dx <= viewRadius; dx++) {
-            for (int dy = -viewRadius; dy <= viewRadius; dy++) {
-                int chunkX = centerChunkX + dx;
-                int chunkY = centerChunkY + dy;
-                
-                // Ensure chunk is within world bounds
-                if (chunkX >= 0 && chunkX < width / chunkSize &&
-                    chunkY >= 0 && chunkY < height / chunkSize) {
-                    visibleChunks.push_back({chunkX, chunkY});
-                }
+private:
+#if defined(__x86_64__) || defined(__i386__)
+    __attribute__((target("sse4.1"), flatten))
+    static void sse41(const NoiseTables& tables, const NoiseOctave* octaves, float* out) {
+        fractalNoiseKernel<Sse41Lanes>(tables, octaves, Octaves, ChunkSize, out);
+    }
+    
+    __attribute__((target("avx2"), flatten))
+    static void avx2(const NoiseTables& tables, const NoiseOctave* octaves, float* out) {
+        fractalNoiseKernel<Avx2Lanes>(tables, octaves, Octaves, ChunkSize, out);
+    }
+#endif
+};
+
+// Stateless per-cell random numbers. Each value depends only on
+// (seed, worldX, worldY), so any cell can be evaluated in isolation, in any
+// order and on any thread.
+static inline uint64_t mix64(uint64_t h) {
+    // splitmix64 finalizer
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+// Uniform value in [0, 1) for a world cell
+static inline double cellRandom(int seed, int worldX, int worldY) {
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(worldX)) << 32) |
+                   static_cast<uint32_t>(worldY);
+    uint64_t h = mix64(key ^ mix64(static_cast<uint64_t>(static_cast<uint32_t>(seed)) + 0x9E3779B97F4A7C15ULL));
+    
+    // Top 53 bits as a double
+    return static_cast<double>(h >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Hash pair for chunk coordinates
+struct ChunkCoordHash {
+    std::size_t operator()(const std::pair<int, int>& p) const {
+        return std::hash<int>()(p.first) ^ (std::hash<int>()(p.second) << 1);
+    }
+};
+
+// Ways of storing chunk cells in memory
+enum ChunkFormat {
+    CHUNK_FORMAT_FLOAT32 = 0,  // 4 bytes per cell, obstacles also stored in-band as -1
+    CHUNK_FORMAT_UINT16 = 1,   // 2 bytes per cell, quantized over the chunk's elevation range
+    CHUNK_FORMAT_UINT8 = 2     // 1 byte per cell, quantized over the chunk's elevation range
+};
+
+// Order of the float cells inside a chunk. Chunk-relative cell (x, y) is
+// always addressed as logical index x * chunkSize + y; the layout only
+// decides where that cell sits in memory. Blocked layouts keep all eight
+// neighbours of most cells within a few cache lines, where the linear one
+// puts the x - 1 and x + 1 columns a full column away.
+enum ChunkLayout {
+    CHUNK_LAYOUT_LINEAR = 0,  // x-major columns, cell (x, y) at x * chunkSize + y
+    CHUNK_LAYOUT_TILED = 1,   // 8x8 micro-tiles in x-major order, each x-major; chunkSize a multiple of 8
+    CHUNK_LAYOUT_MORTON = 2   // Z-order, bits of x and y interleaved; chunkSize a power of two
+};
+
+static const int kMicroTileShift = 3;  // 8x8 micro-tiles for CHUNK_LAYOUT_TILED
+
+// Whether a chunk size supports a layout
+static bool chunkLayoutSupported(ChunkLayout layout, int chunkSize) {
+    switch (layout) {
+        case CHUNK_LAYOUT_LINEAR:
+            return true;
+        case CHUNK_LAYOUT_TILED:
+            return chunkSize > 0 && chunkSize % (1 << kMicroTileShift) == 0;
+        case CHUNK_LAYOUT_MORTON:
+            return chunkSize > 0 && chunkSize <= 65536 && (chunkSize & (chunkSize - 1)) == 0;
+        default:
+            return false;
+    }
+}
+
+// Spread the low 16 bits of v to the even bit positions, for Morton indices
+static inline uint32_t spreadBits16(uint32_t v) {
+    v &= 0xFFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+// Slots for data derived from a chunk and cached alongside it
+enum ChunkAnnotation {
+    CHUNK_ANNOTATION_TRANSITIONS = 0,  // HierarchicalPathFinder cluster graphs
+    CHUNK_ANNOTATION_SMOOTH_CELLS = 1, // JumpPointPathFinder smoothness bits
+    CHUNK_ANNOTATION_EDGE_COSTS = 2,   // EdgeCostReader step costs
+    CHUNK_ANNOTATION_CLEARANCE = 3,    // ClearanceField distances to blocked cells
+    CHUNK_ANNOTATION_COUNT
+};
+
+// Pooled chunk cell buffers
+//
+// Every float chunk of a generator has the same size, so cells come from a
+// pool of equal buffers carved out of large slabs rather than one heap
+// allocation each. Released buffers go on a free list and are handed to the
+// next chunk, so streaming chunks in and out as the rover moves does not
+// churn or fragment the heap. Buffers are aligned to 64 bytes, a cache line
+// and the widest vector the noise kernels store. Slabs are anonymous
+// mappings of at least 2 MiB; with huge pages they are requested as such
+// (MAP_HUGETLB, falling back to transparent huge pages) so a chunk scan
+// touches one TLB entry instead of dozens. Slabs are kept until trim()
+// finds them entirely free or the pool goes away.
+class ChunkBufferPool {
+private:
+    static const size_t kAlignment = 64;
+    static const size_t kSlabBytes = size_t(2) << 20;
+    
+    struct Slab {
+        char* base;
+        size_t bytes;
+        bool hugePages;
+    };
+    
+    size_t cellCount;
+    size_t bufferBytes;
+    size_t buffersPerSlab;
+    size_t slabBytes;
+    bool hugePages;
+    
+    mutable std::mutex mutex;
+    std::vector<Slab> slabs;
+    std::vector<float*> freeBuffers;
+    
+    ChunkBufferPool(const ChunkBufferPool&) = delete;
+    ChunkBufferPool& operator=(const ChunkBufferPool&) = delete;
+    
+    // Map a new slab and put its buffers on the free list
+    bool grow() {
+        Slab slab = {nullptr, slabBytes, false};
+#ifdef _WIN32
+        slab.base = static_cast<char*>(_aligned_malloc(slabBytes, kAlignment));
+#else
+        void* mapping = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (hugePages) {
+            mapping = mmap(nullptr, slabBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            slab.hugePages = mapping != MAP_FAILED;
+        }
+#endif
+        if (mapping == MAP_FAILED) {
+            mapping = mmap(nullptr, slabBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+            if (hugePages && mapping != MAP_FAILED) {
+                slab.hugePages = madvise(mapping, slabBytes, MADV_HUGEPAGE) == 0;
             }
+#endif
+        }
+        slab.base = mapping == MAP_FAILED ? nullptr : static_cast<char*>(mapping);
+#endif
+        if (!slab.base) {
+            return false;
         }
         
-        return visibleChunks;
+        slabs.push_back(slab);
+        for (size_t i = buffersPerSlab; i-- > 0;) {
+            freeBuffers.push_back(reinterpret_cast<float*>(slab.base + i * bufferBytes));
+        }
+        return true;
     }
     
-    // Clear all generated chunks from memory
-    void clearChunks() {
-        chunks.clear();
+    static void unmap(const Slab& slab) {
+#ifdef _WIN32
+        _aligned_free(slab.base);
+#else
+        munmap(slab.base, slab.bytes);
+#endif
     }
-};
 
-extern "C" {
-    // Create and manage terrain generator instances
-    TerrainGenerator* terrain_create(int width, int height, int maxElevation, int chunkSize, int seed) {
-        return new TerrainGenerator(width, height, maxElevation, chunkSize, seed);
+public:
+    // Pool of buffers holding cellCount floats each
+    ChunkBufferPool(size_t cellCount, bool hugePages)
+        : cellCount(cellCount), hugePages(hugePages) {
+        bufferBytes = (std::max<size_t>(cellCount, 1) * sizeof(float) + kAlignment - 1) / kAlignment * kAlignment;
+        slabBytes = (bufferBytes + kSlabBytes - 1) / kSlabBytes * kSlabBytes;
+        buffersPerSlab = slabBytes / bufferBytes;
     }
     
-    void terrain_set_parameters(TerrainGenerator* terrain, double scale, int octaves, 
-                             double persistence, double lacunarity, double obstacleProb) {
-        if (terrain) {
-            terrain->setParameters(scale, octaves, persistence, lacunarity, obstacleProb);
+    ~ChunkBufferPool() {
+        for (const Slab& slab : slabs) {
+            unmap(slab);
         }
     }
     
-    // Get and copy chunk data
-    void terrain_generate_chunk(TerrainGenerator* terrain, int chunkX, int chunkY, float* result) {
-        if (!terrain || !result) return;
-        
-        std::vector<float> chunk = terrain->generateChunk(chunkX, chunkY);
-        std::memcpy(result, chunk.data(), chunk.size() * sizeof(float));
+    size_t getCellCount() const { return cellCount; }
+    bool usesHugePages() const { return hugePages; }
+    
+    // A buffer of cellCount floats, or nullptr if no memory is left. A
+    // recycled buffer still holds its previous chunk's cells. Thread safe.
+    float* acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeBuffers.empty() && !grow()) {
+            return nullptr;
+        }
+        float* buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+        return buffer;
     }
     
-    float terrain_get_elevation(TerrainGenerator* terrain, int x, int y) {
-        if (!terrain) return -1.0f;
-        return terrain->getElevation(x, y);
+    // Return a buffer from acquire. Thread safe.
+    void release(float* buffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeBuffers.push_back(buffer);
     }
     
-    bool terrain_is_obstacle(TerrainGenerator* terrain, int x, int y) {
-        if (!terrain) return true;
-        return terrain->isObstacle(x, y);
+    // Unmap slabs none of whose buffers are in use
+    void trim() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::sort(freeBuffers.begin(), freeBuffers.end());
+        
+        std::vector<Slab> kept;
+        std::vector<float*> keptBuffers;
+        for (const Slab& slab : slabs) {
+            const float* begin = reinterpret_cast<const float*>(slab.base);
+            const float* end = reinterpret_cast<const float*>(slab.base + slab.bytes);
+            auto first = std::lower_bound(freeBuffers.begin(), freeBuffers.end(), begin);
+            auto last = std::lower_bound(first, freeBuffers.end(), end);
+            if (static_cast<size_t>(last - first) == buffersPerSlab) {
+                unmap(slab);
+            } else {
+                kept.push_back(slab);
+                keptBuffers.insert(keptBuffers.end(), first, last);
+            }
+        }
+        slabs.swap(kept);
+        freeBuffers.swap(keptBuffers);
     }
     
-    void terrain_unload_distant_chunks(TerrainGenerator* terrain, int centerX, int centerY, int maxViewRadius) {
-        if (terrain) {
-            terrain->unloadDistantChunks(centerX, centerY, maxViewRadius);
+    // Bytes mapped for slabs, and how many of their buffers are free
+    void usage(uint64_t& bytes, uint64_t& freeCount, bool& huge) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes = 0;
+        huge = !slabs.empty();
+        for (const Slab& slab : slabs) {
+            bytes += slab.bytes;
+            huge = huge && slab.hugePages;
         }
+        freeCount = freeBuffers.size();
     }
+};
+
+// Elevation data for one chunk, addressed x-major ([x * chunkSize + y]).
+// Float cells live either in a pooled buffer or in a private file mapping,
+// which shares clean pages with other processes mapping the same tile.
+// Pooled float chunks can keep their cells in a blocked ChunkLayout; get,
+// set and at hide it, and data() only exposes linear cells.
+// Quantized chunks store base + q * step, at most step / 2 from the source
+// elevation. Every format keeps a 1-bit obstacle mask (bit i % 64 of word
+// i / 64 is cell i), so obstacle tests never decode elevations and can
+// cover 64 cells of a column at once.
+class ChunkData {
+private:
+    ChunkFormat format;
+    ChunkLayout layout;
+    size_t count;
+    int side;  // Chunk side length; chunks are square
     
-    void terrain_clear_chunks(TerrainGenerator* terrain) {
-        if (terrain) {
-            terrain->clearChunks();
+    std::shared_ptr<ChunkBufferPool> pool;  // Owner of cells, if pooled
+    float* cells;
+    void* mapping;
+    size_t mappingLength;
+    
+    std::vector<uint16_t> quantized16;
+    std::vector<uint8_t> quantized8;
+    float quantBase;
+    float quantStep;
+    
+    std::vector<uint64_t> obstacles;
+    
+    // Derived data, dropped whenever a cell changes
+    mutable std::mutex annotationMutex;
+    std::shared_ptr<const void> annotations[CHUNK_ANNOTATION_COUNT];
+    
+    ChunkData(const ChunkData&) = delete;
+    ChunkData& operator=(const ChunkData&) = delete;
+    
+    void setObstacleBit(size_t i, bool obstacle) {
+        uint64_t bit = uint64_t(1) << (i % 64);
+        if (obstacle) {
+            obstacles[i / 64] |= bit;
+        } else {
+            obstacles[i / 64] &= ~bit;
         }
     }
     
+    static int squareSide(size_t count) {
+        return static_cast<int>(std::sqrt(static_cast<double>(count)) + 0.5);
+    }
+    
+    // Memory position of logical cell i
+    size_t physical(size_t i) const {
+        if (layout == CHUNK_LAYOUT_LINEAR) {
+            return i;
+        }
+        return cellOffset(static_cast<int>(i / side), static_cast<int>(i % side));
+    }
+    
+    unsigned int quantize(float elevation) const {
+        unsigned int levels = format == CHUNK_FORMAT_UINT16 ? 65535u : 255u;
+        double q = std::round((elevation - quantBase) / quantStep);
+        return static_cast<unsigned int>(std::min<double>(std::max(q, 0.0), levels));
+    }
+
+public:
+    // Float chunk in a buffer from pool. The cells are not cleared; the
+    // caller writes every one before the chunk is shared.
+    explicit ChunkData(std::shared_ptr<ChunkBufferPool> bufferPool)
+        : format(CHUNK_FORMAT_FLOAT32), layout(CHUNK_LAYOUT_LINEAR), count(bufferPool->getCellCount()),
+          side(squareSide(count)), pool(std::move(bufferPool)),
+          cells(pool->acquire()), mapping(nullptr), mappingLength(0), quantBase(0.0f), quantStep(1.0f),
+          obstacles((count + 63) / 64, 0) {
+        if (!cells) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    // Float chunk served from a mapping; takes ownership of the mapping
+    ChunkData(void* mapping, size_t mappingLength, float* cells, size_t count)
+        : format(CHUNK_FORMAT_FLOAT32), layout(CHUNK_LAYOUT_LINEAR), count(count), side(squareSide(count)),
+          cells(cells), mapping(mapping),
+          mappingLength(mappingLength), quantBase(0.0f), quantStep(1.0f),
+          obstacles((count + 63) / 64, 0) {
+        updateObstacleMask();
+    }
+    
+    // Quantized copy of a chunk; targetFormat is CHUNK_FORMAT_UINT16 or
+    // CHUNK_FORMAT_UINT8
+    ChunkData(const ChunkData& source, ChunkFormat targetFormat)
+        : format(targetFormat), layout(CHUNK_LAYOUT_LINEAR), count(source.count), side(source.side),
+          cells(nullptr), mapping(nullptr),
+          mappingLength(0), quantBase(0.0f), quantStep(1.0f), obstacles(source.obstacles) {
+        // Quantize over the range of the non-obstacle cells
+        float low = 0.0f;
+        float high = 0.0f;
+        bool any = false;
+        for (size_t i = 0; i < count; i++) {
+            if (!source.isObstacle(i)) {
+                float elevation = source.get(i);
+                low = any ? std::min(low, elevation) : elevation;
+                high = any ? std::max(high, elevation) : elevation;
+                any = true;
+            }
+        }
+        unsigned int levels = format == CHUNK_FORMAT_UINT16 ? 65535u : 255u;
+        quantBase = low;
+        quantStep = high > low ? (high - low) / levels : 1.0f;
+        
+        if (format == CHUNK_FORMAT_UINT16) {
+            quantized16.resize(count);
+        } else {
+            quantized8.resize(count);
+        }
+        for (size_t i = 0; i < count; i++) {
+            set(i, source.get(i));
+        }
+    }
+    
+    // Copy of a float chunk with its cells in targetLayout, in a buffer from
+    // bufferPool. The layout must be supported by the chunk's side length.
+    ChunkData(const ChunkData& source, ChunkLayout targetLayout, std::shared_ptr<ChunkBufferPool> bufferPool)
+        : format(CHUNK_FORMAT_FLOAT32), layout(targetLayout), count(source.count), side(source.side),
+          pool(std::move(bufferPool)), cells(pool->acquire()), mapping(nullptr), mappingLength(0),
+          quantBase(0.0f), quantStep(1.0f), obstacles(source.obstacles) {
+        if (!cells) {
+            throw std::bad_alloc();
+        }
+        for (int x = 0; x < side; x++) {
+            for (int y = 0; y < side; y++) {
+                cells[cellOffset(x, y)] = source.at(x, y);
+            }
+        }
+    }
+    
+    ~ChunkData() {
+        if (pool) {
+            pool->release(cells);
+        }
+#ifndef _WIN32
+        if (mapping) {
+            munmap(mapping, mappingLength);
+        }
+#endif
+    }
+    
+    ChunkFormat getFormat() const { return format; }
+    ChunkLayout getLayout() const { return layout; }
+    size_t size() const { return count; }
+    
+    // Float cells in linear order, or nullptr for quantized chunks and
+    // blocked layouts
+    float* data() { return layout == CHUNK_LAYOUT_LINEAR ? cells : nullptr; }
+    const float* data() const { return layout == CHUNK_LAYOUT_LINEAR ? cells : nullptr; }
+    
+    // Memory position of chunk-relative cell (x, y) in this chunk's layout
+    size_t cellOffset(int x, int y) const {
+        switch (layout) {
+            case CHUNK_LAYOUT_TILED: {
+                const int mask = (1 << kMicroTileShift) - 1;
+                size_t tile = static_cast<size_t>(x >> kMicroTileShift) * (side >> kMicroTileShift) +
+                              (y >> kMicroTileShift);
+                return (tile << (2 * kMicroTileShift)) | ((x & mask) << kMicroTileShift) | (y & mask);
+            }
+            case CHUNK_LAYOUT_MORTON:
+                return (static_cast<size_t>(spreadBits16(x)) << 1) | spreadBits16(y);
+            default:
+                return static_cast<size_t>(x) * side + y;
+        }
+    }
+    
+    // Elevation of chunk-relative cell (x, y), -1 or below for obstacles.
+    // Cheaper than get for blocked layouts, which get must first split into
+    // x and y.
+    float at(int x, int y) const {
+        if (format == CHUNK_FORMAT_FLOAT32) {
+            return cells[cellOffset(x, y)];
+        }
+        return get(static_cast<size_t>(x) * side + y);
+    }
+    
+    // Elevation of cell i, -1 or below for obstacles
+    float get(size_t i) const {
+        if (format == CHUNK_FORMAT_FLOAT32) {
+            return cells[physical(i)];
+        }
+        if (isObstacle(i)) {
+            return -1.0f;
+        }
+        unsigned int q = format == CHUNK_FORMAT_UINT16 ? quantized16[i] : quantized8[i];
+        return quantBase + q * quantStep;
+    }
+    
+    // Overwrite cell i; negative elevations mark obstacles. Quantized chunks
+    // clamp to their elevation range.
+    void set(size_t i, float elevation) {
+        setObstacleBit(i, elevation < 0);
+        if (format == CHUNK_FORMAT_FLOAT32) {
+            cells[physical(i)] = elevation;
+        } else if (format == CHUNK_FORMAT_UINT16) {
+            quantized16[i] = static_cast<uint16_t>(elevation < 0 ? 0 : quantize(elevation));
+        } else {
+            quantized8[i] = static_cast<uint8_t>(elevation < 0 ? 0 : quantize(elevation));
+        }
+    }
+    
+    // Decode n cells starting at begin into out
+    void decode(size_t begin, size_t n, float* out) const {
+        if (format == CHUNK_FORMAT_FLOAT32 && layout == CHUNK_LAYOUT_LINEAR) {
+            std::memcpy(out, cells + begin, n * sizeof(float));
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            out[i] = get(begin + i);
+        }
+    }
+    
+    bool isObstacle(size_t i) const {
+        return (obstacles[i / 64] >> (i % 64)) & 1;
+    }
+    
+    const uint64_t* obstacleMask() const { return obstacles.data(); }
+    
+    // Rebuild the obstacle mask from float cells
+    void updateObstacleMask() {
+        std::fill(obstacles.begin(), obstacles.end(), 0);
+        for (size_t i = 0; i < count; i++) {
+            if (cells[physical(i)] < 0) {
+                obstacles[i / 64] |= uint64_t(1) << (i % 64);
+            }
+        }
+    }
+    
+    // Derived data cached with the chunk, or nullptr if not computed yet
+    template <typename T>
+    std::shared_ptr<const T> getAnnotation(ChunkAnnotation slot) const {
+        std::lock_guard<std::mutex> lock(annotationMutex);
+        return std::static_pointer_cast<const T>(annotations[slot]);
+    }
+    
+    template <typename T>
+    void setAnnotation(ChunkAnnotation slot, std::shared_ptr<const T> annotation) {
+        std::lock_guard<std::mutex> lock(annotationMutex);
+        annotations[slot] = std::move(annotation);
+    }
+    
+    void clearAnnotations() {
+        std::lock_guard<std::mutex> lock(annotationMutex);
+        for (auto& annotation : annotations) {
+            annotation.reset();
+        }
+    }
+    
+    // Resident bytes for the cells and obstacle mask
+    size_t byteSize() const {
+        size_t cellBytes = format == CHUNK_FORMAT_FLOAT32 ? sizeof(float)
+                         : format == CHUNK_FORMAT_UINT16 ? sizeof(uint16_t) : sizeof(uint8_t);
+        return count * cellBytes + obstacles.size() * sizeof(uint64_t);
+    }
+};
+
+// Copy n bits from src starting at bit srcBit into dst starting at bit
+// dstBit, a word at a time. The destination bits must start out clear.
+static void orBits(const uint64_t* src, size_t srcBit, uint64_t* dst, size_t dstBit, size_t n) {
+    while (n > 0) {
+        size_t take = std::min<size_t>(n, 64);
+        
+        // Gather up to 64 source bits, which may straddle two words
+        size_t srcWord = srcBit / 64;
+        unsigned int srcShift = srcBit % 64;
+        uint64_t bits = src[srcWord] >> srcShift;
+        if (srcShift != 0 && srcShift + take > 64) {
+            bits |= src[srcWord + 1] << (64 - srcShift);
+        }
+        if (take < 64) {
+            bits &= (uint64_t(1) << take) - 1;
+        }
+        
+        // Scatter them, again possibly across two words
+        size_t dstWord = dstBit / 64;
+        unsigned int dstShift = dstBit % 64;
+        dst[dstWord] |= bits << dstShift;
+        if (dstShift != 0 && dstShift + take > 64) {
+            dst[dstWord + 1] |= bits >> (64 - dstShift);
+        }
+        
+        srcBit += take;
+        dstBit += take;
+        n -= take;
+    }
+}
+
+// Set n bits of dst starting at bit dstBit
+static void setBits(uint64_t* dst, size_t dstBit, size_t n) {
+    while (n > 0) {
+        unsigned int shift = dstBit % 64;
+        size_t take = std::min<size_t>(n, 64 - shift);
+        uint64_t bits = take == 64 ? ~uint64_t(0) : ((uint64_t(1) << take) - 1) << shift;
+        dst[dstBit / 64] |= bits;
+        dstBit += take;
+        n -= take;
+    }
+}
+
+// Chunk elevation data. Chunks are shared so that callers holding a
+// reference keep the data alive after the cache unloads it.
+typedef std::shared_ptr<ChunkData> ChunkPtr;
+
+// On-disk store of generated chunks, one tile file per chunk. Tiles are
+// named after the seed, a hash of every parameter that affects generation
+// and the chunk coordinates, so changing parameters simply stops matching
+// the old tiles. Tiles are written to a temporary file and renamed into
+// place, so concurrent processes only ever see complete tiles.
+class ChunkStore {
+private:
+    // Tile header; the cells follow as raw floats
+    struct TileHeader {
+        uint32_t magic;
+        uint32_t version;
+        int32_t chunkSize;
+        int32_t chunkX;
+        int32_t chunkY;
+        int32_t seed;
+        uint64_t paramsHash;
+        uint64_t cellCount;
+        uint64_t reserved;  // Pads the header so the cells stay 16-byte aligned
+    };
+    
+    static const uint32_t kMagic = 0x4B43544D;  // "MTCK"
+    static const uint32_t kVersion = 1;
+    
+    std::string directory;
+    int seed;
+    uint64_t paramsHash;
+    std::atomic<uint64_t> tempCounter;
+    
+    std::string tilePath(int chunkX, int chunkY) const {
+        char name[96];
+        std::snprintf(name, sizeof(name), "/s%d_p%016llx_%d_%d.tile", seed,
+                      static_cast<unsigned long long>(paramsHash), chunkX, chunkY);
+        return directory + name;
+    }
+    
+    std::string blobPath(const std::string& name) const {
+        char prefix[64];
+        std::snprintf(prefix, sizeof(prefix), "/s%d_p%016llx_", seed,
+                      static_cast<unsigned long long>(paramsHash));
+        return directory + prefix + name;
+    }
+    
+    bool headerMatches(const TileHeader& header, int chunkX, int chunkY, size_t cellCount) const {
+        return header.magic == kMagic && header.version == kVersion &&
+               header.chunkSize * header.chunkSize == static_cast<int64_t>(cellCount) &&
+               header.chunkX == chunkX && header.chunkY == chunkY && header.seed == seed &&
+               header.paramsHash == paramsHash && header.cellCount == cellCount;
+    }
+
+public:
+    ChunkStore(const std::string& directory, int seed)
+        : directory(directory), seed(seed), paramsHash(0), tempCounter(0) {
+#ifdef _WIN32
+        _mkdir(directory.c_str());
+#else
+        mkdir(directory.c_str(), 0755);  // Fails harmlessly if it exists
+#endif
+    }
+    
+    // Switch to the tiles generated with the given parameters. Not safe to
+    // call while chunks are loaded or saved.
+    void setParamsHash(uint64_t hash) {
+        paramsHash = hash;
+    }
+    
+    // Map the stored tile for a chunk, or return nullptr if there is no
+    // valid tile. The mapping is private, so edits stay in this process.
+    // Where files cannot be mapped, the tile is read into a buffer from pool.
+    ChunkPtr load(int chunkX, int chunkY, int chunkSize, const std::shared_ptr<ChunkBufferPool>& pool) const {
+        size_t cellCount = static_cast<size_t>(chunkSize) * chunkSize;
+        size_t fileLength = sizeof(TileHeader) + cellCount * sizeof(float);
+        std::string path = tilePath(chunkX, chunkY);
+        
+#ifdef _WIN32
+        // No mmap; read the tile into a pooled buffer instead
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return nullptr;
+        }
+        TileHeader header;
+        ChunkPtr chunk;
+        if (std::fread(&header, sizeof(header), 1, file) == 1 &&
+            headerMatches(header, chunkX, chunkY, cellCount)) {
+            chunk = std::make_shared<ChunkData>(pool);
+            if (std::fread(chunk->data(), sizeof(float), cellCount, file) != cellCount) {
+                chunk.reset();
+            } else {
+                chunk->updateObstacleMask();
+            }
+        }
+        std::fclose(file);
+        return chunk;
+#else
+        (void)pool;  // Mapped tiles own their memory
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return nullptr;
+        }
+        
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != fileLength) {
+            close(fd);
+            return nullptr;
+        }
+        
+        void* mapping = mmap(nullptr, fileLength, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            return nullptr;
+        }
+        
+        const TileHeader* header = static_cast<const TileHeader*>(mapping);
+        if (!headerMatches(*header, chunkX, chunkY, cellCount)) {
+            munmap(mapping, fileLength);
+            return nullptr;
+        }
+        
+        float* cells = reinterpret_cast<float*>(static_cast<char*>(mapping) + sizeof(TileHeader));
+        return std::make_shared<ChunkData>(mapping, fileLength, cells, cellCount);
+#endif
+    }
+    
+    // Write a chunk's tile. Failures are ignored; the chunk is then simply
+    // regenerated next time.
+    void save(int chunkX, int chunkY, int chunkSize, const ChunkData& chunk) {
+        TileHeader header = {kMagic, kVersion, chunkSize, chunkX, chunkY, seed, paramsHash,
+                             static_cast<uint64_t>(chunk.size()), 0};
+        
+        std::string path = tilePath(chunkX, chunkY);
+        char suffix[64];
+        std::snprintf(suffix, sizeof(suffix), ".tmp%ld_%llu", static_cast<long>(getpid()),
+                      static_cast<unsigned long long>(tempCounter++));
+        std::string tempPath = path + suffix;
+        
+        FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) {
+            return;
+        }
+        bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                       std::fwrite(chunk.data(), sizeof(float), chunk.size(), file) == chunk.size();
+        written = std::fclose(file) == 0 && written;
+        
+        if (!written || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+        }
+    }
+    
+    // Read a file of data derived from the whole terrain, named like the
+    // tiles of the current parameters. Returns false if there is none.
+    bool loadBlob(const std::string& name, std::vector<char>& out) const {
+        FILE* file = std::fopen(blobPath(name).c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        out.clear();
+        char buffer[65536];
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            out.insert(out.end(), buffer, buffer + n);
+        }
+        bool ok = !std::ferror(file);
+        std::fclose(file);
+        return ok;
+    }
+    
+    // Write a derived data file the same way as tiles; failures are ignored
+    void saveBlob(const std::string& name, const std::vector<char>& data) {
+        std::string path = blobPath(name);
+        char suffix[64];
+        std::snprintf(suffix, sizeof(suffix), ".tmp%ld_%llu", static_cast<long>(getpid()),
+                      static_cast<unsigned long long>(tempCounter++));
+        std::string tempPath = path + suffix;
+        
+        FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) {
+            return;
+        }
+        bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+        written = std::fclose(file) == 0 && written;
+        
+        if (!written || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+        }
+    }
+};
+
+// File formats written by TerrainGenerator::exportRegion
+enum HeightfieldFormat {
+    HEIGHTFIELD_FORMAT_TILED = 0,    // Chunk-sized float tiles, cells laid out like chunks
+    HEIGHTFIELD_FORMAT_GEOTIFF = 1   // Uncompressed float32 GeoTIFF, one strip per row of tiles
+};
+
+// Results of heightfield export and import
+enum HeightfieldStatus {
+    HEIGHTFIELD_OK = 0,
+    HEIGHTFIELD_INVALID_ARGUMENT = -1,
+    HEIGHTFIELD_IO_ERROR = -2,
+    HEIGHTFIELD_TOO_LARGE = -3,  // A GeoTIFF over 4 GiB, beyond classic TIFF offsets
+    HEIGHTFIELD_UNSUPPORTED = -4 // Neither a tiled heightfield nor an uncompressed little-endian TIFF
+};
+
+// Header of a tiled heightfield file. Tiles of tileSize x tileSize floats
+// follow in row-major tile order (tile index tileY * tilesX + tileX), each
+// stored x-major like a chunk; cells past the exported rectangle are -1.
+struct HeightfieldHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    int32_t tileSize;
+    int32_t originX;  // World cell the first cell was exported from
+    int32_t originY;
+    int32_t seed;
+    uint64_t paramsHash;
+    uint64_t reserved;  // Pads the header so tiles stay 16-byte aligned
+};
+
+static const uint32_t kHeightfieldMagic = 0x4648544D;  // "MTHF"
+static const uint32_t kHeightfieldVersion = 1;
+
+// TIFF tags read and written for GeoTIFF heightfields
+enum TiffTag {
+    TIFF_TAG_IMAGE_WIDTH = 256,
+    TIFF_TAG_IMAGE_LENGTH = 257,
+    TIFF_TAG_BITS_PER_SAMPLE = 258,
+    TIFF_TAG_COMPRESSION = 259,
+    TIFF_TAG_PHOTOMETRIC = 262,
+    TIFF_TAG_STRIP_OFFSETS = 273,
+    TIFF_TAG_SAMPLES_PER_PIXEL = 277,
+    TIFF_TAG_ROWS_PER_STRIP = 278,
+    TIFF_TAG_STRIP_BYTE_COUNTS = 279,
+    TIFF_TAG_PLANAR_CONFIG = 284,
+    TIFF_TAG_TILE_WIDTH = 322,
+    TIFF_TAG_SAMPLE_FORMAT = 339,
+    TIFF_TAG_MODEL_TRANSFORMATION = 34264,
+    TIFF_TAG_GEO_KEY_DIRECTORY = 34735,
+    TIFF_TAG_GDAL_NODATA = 42113
+};
+
+// An external heightfield serving as the chunk source in place of the
+// noise: a tiled heightfield written by exportRegion, or a little-endian,
+// uncompressed, stripped, single-band TIFF (GeoTIFF from GIS tools) of
+// float32, int16 or uint16 samples. The file is mapped read-only, so only
+// the pages chunks are built from are read. Cell (0, 0) lands on world cell
+// (offsetX, offsetY) and stored values v become v * valueScale +
+// valueOffset. Negative results are obstacles as usual; nodata and NaN
+// cells become -1, and so does every world cell the heightfield does not
+// cover.
+class HeightfieldSource {
+private:
+    enum Layout { LAYOUT_TILED, LAYOUT_STRIPS };
+    enum SampleType { SAMPLE_FLOAT32, SAMPLE_INT16, SAMPLE_UINT16 };
+    
+    Layout layout;
+    SampleType sampleType;
+    int width;
+    int height;
+    
+    // LAYOUT_TILED
+    int tileSize;
+    int tilesX;
+    
+    // LAYOUT_STRIPS
+    int rowsPerStrip;
+    std::vector<uint64_t> stripOffsets;
+    
+    bool hasNoData;
+    double noData;
+    
+    int offsetX;
+    int offsetY;
+    double valueScale;
+    double valueOffset;
+    uint64_t identity;
+    
+    const uint8_t* bytes;
+    size_t length;
+#ifdef _WIN32
+    std::vector<uint8_t> buffer;
+#endif
+    
+    HeightfieldSource()
+        : layout(LAYOUT_TILED), sampleType(SAMPLE_FLOAT32), width(0), height(0), tileSize(0), tilesX(0),
+          rowsPerStrip(0), hasNoData(false), noData(0.0), offsetX(0), offsetY(0), valueScale(1.0),
+          valueOffset(0.0), identity(0), bytes(nullptr), length(0) {}
+    
+    bool mapFile(const std::string& path) {
+#ifdef _WIN32
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        uint8_t chunk[65536];
+        size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            buffer.insert(buffer.end(), chunk, chunk + n);
+        }
+        std::fclose(file);
+        bytes = buffer.data();
+        length = buffer.size();
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            close(fd);
+            return false;
+        }
+        length = static_cast<size_t>(info.st_size);
+        void* mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            length = 0;
+            return false;
+        }
+        bytes = static_cast<const uint8_t*>(mapping);
+        return true;
+#endif
+    }
+    
+    template <typename T>
+    T read(size_t offset) const {
+        T value;
+        std::memcpy(&value, bytes + offset, sizeof(T));
+        return value;
+    }
+    
+    bool parseTiled() {
+        HeightfieldHeader header = read<HeightfieldHeader>(0);
+        if (header.version != kHeightfieldVersion || header.width <= 0 || header.height <= 0 ||
+            header.tileSize <= 0) {
+            return false;
+        }
+        width = header.width;
+        height = header.height;
+        tileSize = header.tileSize;
+        tilesX = (width + tileSize - 1) / tileSize;
+        uint64_t tilesY = (height + tileSize - 1) / tileSize;
+        layout = LAYOUT_TILED;
+        sampleType = SAMPLE_FLOAT32;
+        return length == sizeof(HeightfieldHeader) +
+                         tilesX * tilesY * tileSize * static_cast<uint64_t>(tileSize) * sizeof(float);
+    }
+    
+    // Value i of a TIFF directory entry of SHORT or LONG type
+    bool entryValue(size_t entry, uint32_t i, uint64_t& value) const {
+        uint16_t type = read<uint16_t>(entry + 2);
+        uint32_t count = read<uint32_t>(entry + 4);
+        size_t size = type == 3 ? 2 : type == 4 ? 4 : 0;
+        if (size == 0 || i >= count) {
+            return false;
+        }
+        size_t values = count * size <= 4 ? entry + 8 : read<uint32_t>(entry + 8);
+        if (values + (i + 1) * size > length) {
+            return false;
+        }
+        value = size == 2 ? read<uint16_t>(values + i * size) : read<uint32_t>(values + i * size);
+        return true;
+    }
+    
+    bool parseTiff() {
+        if (length < 8 || bytes[0] != 'I' || bytes[1] != 'I' || read<uint16_t>(2) != 42) {
+            return false;
+        }
+        size_t directory = read<uint32_t>(4);
+        if (directory + 2 > length) {
+            return false;
+        }
+        uint16_t entries = read<uint16_t>(directory);
+        if (directory + 2 + entries * 12ull > length) {
+            return false;
+        }
+        
+        uint64_t bits = 1, compression = 1, samples = 1, planar = 1, format = 1;
+        uint64_t imageWidth = 0, imageLength = 0, rows = 0;
+        size_t offsetsEntry = 0;
+        for (uint16_t e = 0; e < entries; e++) {
+            size_t entry = directory + 2 + e * 12;
+            uint16_t tag = read<uint16_t>(entry);
+            switch (tag) {
+                case TIFF_TAG_IMAGE_WIDTH: entryValue(entry, 0, imageWidth); break;
+                case TIFF_TAG_IMAGE_LENGTH: entryValue(entry, 0, imageLength); break;
+                case TIFF_TAG_BITS_PER_SAMPLE: entryValue(entry, 0, bits); break;
+                case TIFF_TAG_COMPRESSION: entryValue(entry, 0, compression); break;
+                case TIFF_TAG_SAMPLES_PER_PIXEL: entryValue(entry, 0, samples); break;
+                case TIFF_TAG_ROWS_PER_STRIP: entryValue(entry, 0, rows); break;
+                case TIFF_TAG_PLANAR_CONFIG: entryValue(entry, 0, planar); break;
+                case TIFF_TAG_SAMPLE_FORMAT: entryValue(entry, 0, format); break;
+                case TIFF_TAG_STRIP_OFFSETS: offsetsEntry = entry; break;
+                case TIFF_TAG_TILE_WIDTH: return false;  // Tiled TIFFs are not read
+                case TIFF_TAG_GDAL_NODATA: {
+                    uint32_t count = read<uint32_t>(entry + 4);
+                    size_t text = count <= 4 ? entry + 8 : read<uint32_t>(entry + 8);
+                    if (read<uint16_t>(entry + 2) == 2 && text + count <= length) {
+                        std::string value(reinterpret_cast<const char*>(bytes + text), count);
+                        char* end = nullptr;
+                        noData = std::strtod(value.c_str(), &end);
+                        hasNoData = end != value.c_str();
+                    }
+                    break;
+                }
+                default: break;
+            }
+        }
+        
+        if (format == 3 && bits == 32) {
+            sampleType = SAMPLE_FLOAT32;
+        } else if (format == 2 && bits == 16) {
+            sampleType = SAMPLE_INT16;
+        } else if (format == 1 && bits == 16) {
+            sampleType = SAMPLE_UINT16;
+        } else {
+            return false;
+        }
+        if (compression != 1 || samples != 1 || planar != 1 || imageWidth == 0 || imageLength == 0 ||
+            imageWidth > INT32_MAX || imageLength > INT32_MAX || offsetsEntry == 0) {
+            return false;
+        }
+        
+        layout = LAYOUT_STRIPS;
+        width = static_cast<int>(imageWidth);
+        height = static_cast<int>(imageLength);
+        rowsPerStrip = rows == 0 || rows > imageLength ? height : static_cast<int>(rows);
+        
+        const size_t sampleBytes = bits / 8;
+        const int strips = (height + rowsPerStrip - 1) / rowsPerStrip;
+        stripOffsets.resize(strips);
+        for (int s = 0; s < strips; s++) {
+            if (!entryValue(offsetsEntry, s, stripOffsets[s])) {
+                return false;
+            }
+            uint64_t stripRows = std::min(rowsPerStrip, height - s * rowsPerStrip);
+            if (stripOffsets[s] + stripRows * width * sampleBytes > length) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Stored value of heightfield cell (x, y), in bounds
+    double rawAt(int x, int y) const {
+        if (layout == LAYOUT_TILED) {
+            size_t tile = static_cast<size_t>(y / tileSize) * tilesX + x / tileSize;
+            size_t cell = static_cast<size_t>(x % tileSize) * tileSize + y % tileSize;
+            return read<float>(sizeof(HeightfieldHeader) +
+                               (tile * tileSize * tileSize + cell) * sizeof(float));
+        }
+        
+        size_t sample = static_cast<size_t>(y % rowsPerStrip) * width + x;
+        size_t offset = stripOffsets[y / rowsPerStrip];
+        switch (sampleType) {
+            case SAMPLE_INT16: return read<int16_t>(offset + sample * 2);
+            case SAMPLE_UINT16: return read<uint16_t>(offset + sample * 2);
+            default: return read<float>(offset + sample * 4);
+        }
+    }
+
+public:
+    ~HeightfieldSource() {
+#ifndef _WIN32
+        if (bytes) {
+            munmap(const_cast<uint8_t*>(bytes), length);
+        }
+#endif
+    }
+    
+    HeightfieldSource(const HeightfieldSource&) = delete;
+    HeightfieldSource& operator=(const HeightfieldSource&) = delete;
+    
+    // Open a heightfield file, or return nullptr and set status to why not
+    static std::shared_ptr<const HeightfieldSource> open(const std::string& path, int offsetX, int offsetY,
+                                                         double valueScale, double valueOffset,
+                                                         int& status) {
+        std::shared_ptr<HeightfieldSource> source(new HeightfieldSource());
+        if (!source->mapFile(path)) {
+            status = HEIGHTFIELD_IO_ERROR;
+            return nullptr;
+        }
+        
+        bool tiled = source->length >= sizeof(HeightfieldHeader) &&
+                     source->read<uint32_t>(0) == kHeightfieldMagic;
+        if (tiled ? !source->parseTiled() : !source->parseTiff()) {
+            status = HEIGHTFIELD_UNSUPPORTED;
+            return nullptr;
+        }
+        
+        source->offsetX = offsetX;
+        source->offsetY = offsetY;
+        source->valueScale = valueScale;
+        source->valueOffset = valueOffset;
+        
+        // Names the chunk store tiles built from this heightfield
+        uint64_t scaleBits;
+        uint64_t offsetBits;
+        std::memcpy(&scaleBits, &valueScale, sizeof(scaleBits));
+        std::memcpy(&offsetBits, &valueOffset, sizeof(offsetBits));
+        uint64_t words[] = {
+            std::hash<std::string>()(path), source->length,
+            static_cast<uint64_t>(source->width), static_cast<uint64_t>(source->height),
+            static_cast<uint64_t>(static_cast<uint32_t>(offsetX)), static_cast<uint64_t>(static_cast<uint32_t>(offsetY)),
+            scaleBits, offsetBits
+        };
+        uint64_t h = 0;
+        for (uint64_t word : words) {
+            h = mix64(h ^ word);
+        }
+        source->identity = h;
+        
+        status = HEIGHTFIELD_OK;
+        return source;
+    }
+    
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    uint64_t getIdentity() const { return identity; }
+    
+    // Cell value for world cell (worldX, worldY); -1 for obstacles
+    float cellAt(int worldX, int worldY) const {
+        int x = worldX - offsetX;
+        int y = worldY - offsetY;
+        if (x < 0 || x >= width || y < 0 || y >= height) {
+            return -1.0f;
+        }
+        double raw = rawAt(x, y);
+        if (std::isnan(raw) || (hasNoData && raw == noData)) {
+            return -1.0f;
+        }
+        return static_cast<float>(raw * valueScale + valueOffset);
+    }
+    
+    // Fill a size x size tile of samples stride cells apart from world cell
+    // (absX, absY), stored x-major like a chunk
+    void sampleTile(int absX, int absY, int stride, int size, float* out) const {
+        // Walk the file in its own order: strips are rows, tiles columns
+        if (layout == LAYOUT_STRIPS) {
+            for (int y = 0; y < size; y++) {
+                for (int x = 0; x < size; x++) {
+                    out[x * size + y] = cellAt(absX + x * stride, absY + y * stride);
+                }
+            }
+            return;
+        }
+        for (int x = 0; x < size; x++) {
+            for (int y = 0; y < size; y++) {
+                out[x * size + y] = cellAt(absX + x * stride, absY + y * stride);
+            }
+        }
+    }
+};
+
+// Build the header, directory and tag data of an uncompressed float32
+// GeoTIFF of a w x h rectangle whose pixel (0, 0) is world cell (x0, y0),
+// stored in strips of rowsPerStrip rows right after the returned bytes.
+// Returns false if the file would not fit classic TIFF's 32-bit offsets.
+static bool geoTiffPrefix(int x0, int y0, int w, int h, int rowsPerStrip, std::vector<uint8_t>& out) {
+    struct Entry {
+        uint16_t tag;
+        uint16_t type;  // 2 ASCII, 3 SHORT, 4 LONG, 12 DOUBLE
+        uint32_t count;
+        uint32_t value;  // Inline value, or the offset of the values
+    };
+    
+    const uint32_t strips = static_cast<uint32_t>((h + rowsPerStrip - 1) / rowsPerStrip);
+    const uint32_t entryCount = 14;
+    const size_t directory = 8;
+    const size_t offsetsAt = directory + 2 + entryCount * 12 + 4;
+    const size_t countsAt = offsetsAt + 4 * strips;
+    const size_t transformAt = countsAt + 4 * strips;
+    const size_t keysAt = transformAt + 16 * sizeof(double);
+    const size_t dataAt = (keysAt + 12 * sizeof(uint16_t) + 15) / 16 * 16;
+    if (dataAt + static_cast<uint64_t>(w) * h * sizeof(float) > UINT32_MAX) {
+        return false;
+    }
+    
+    out.assign(dataAt, 0);
+    auto put = [&out](size_t at, const void* value, size_t size) { std::memcpy(&out[at], value, size); };
+    
+    const uint8_t magic[4] = {'I', 'I', 42, 0};
+    uint32_t directoryOffset = directory;
+    put(0, magic, 4);
+    put(4, &directoryOffset, 4);
+    
+    // One strip per stored row; a single strip's offset and count are inline
+    uint32_t dataOffset = static_cast<uint32_t>(dataAt);
+    for (uint32_t s = 0; s < strips; s++) {
+        uint32_t rows = std::min<uint32_t>(rowsPerStrip, h - s * rowsPerStrip);
+        uint32_t offset = dataOffset + s * rowsPerStrip * static_cast<uint32_t>(w) * sizeof(float);
+        uint32_t count = rows * static_cast<uint32_t>(w) * sizeof(float);
+        put(offsetsAt + 4 * s, &offset, 4);
+        put(countsAt + 4 * s, &count, 4);
+    }
+    uint32_t firstCount;
+    std::memcpy(&firstCount, &out[countsAt], 4);
+    
+    // Pixel (column, row) is world cell (x0 + column, y0 + row) in a local
+    // engineering frame
+    const double transform[16] = {1, 0, 0, static_cast<double>(x0),
+                                  0, 1, 0, static_cast<double>(y0),
+                                  0, 0, 0, 0,
+                                  0, 0, 0, 1};
+    put(transformAt, transform, sizeof(transform));
+    
+    // GeoKey directory: user-defined model type, pixels are areas
+    const uint16_t keys[12] = {1, 1, 0, 2, 1024, 0, 1, 32767, 1025, 0, 1, 1};
+    put(keysAt, keys, sizeof(keys));
+    
+    uint32_t noData = 0;
+    std::memcpy(&noData, "-1", 3);
+    
+    const Entry entries[entryCount] = {
+        {TIFF_TAG_IMAGE_WIDTH, 4, 1, static_cast<uint32_t>(w)},
+        {TIFF_TAG_IMAGE_LENGTH, 4, 1, static_cast<uint32_t>(h)},
+        {TIFF_TAG_BITS_PER_SAMPLE, 3, 1, 32},
+        {TIFF_TAG_COMPRESSION, 3, 1, 1},
+        {TIFF_TAG_PHOTOMETRIC, 3, 1, 1},
+        {TIFF_TAG_STRIP_OFFSETS, 4, strips, strips == 1 ? dataOffset : static_cast<uint32_t>(offsetsAt)},
+        {TIFF_TAG_SAMPLES_PER_PIXEL, 3, 1, 1},
+        {TIFF_TAG_ROWS_PER_STRIP, 4, 1, static_cast<uint32_t>(rowsPerStrip)},
+        {TIFF_TAG_STRIP_BYTE_COUNTS, 4, strips, strips == 1 ? firstCount : static_cast<uint32_t>(countsAt)},
+        {TIFF_TAG_PLANAR_CONFIG, 3, 1, 1},
+        {TIFF_TAG_SAMPLE_FORMAT, 3, 1, 3},
+        {TIFF_TAG_MODEL_TRANSFORMATION, 12, 16, static_cast<uint32_t>(transformAt)},
+        {TIFF_TAG_GEO_KEY_DIRECTORY, 3, 12, static_cast<uint32_t>(keysAt)},
+        {TIFF_TAG_GDAL_NODATA, 2, 3, noData},
+    };
+    
+    uint16_t count16 = entryCount;
+    put(directory, &count16, 2);
+    for (uint32_t e = 0; e < entryCount; e++) {
+        size_t at = directory + 2 + e * 12;
+        put(at, &entries[e].tag, 2);
+        put(at + 2, &entries[e].type, 2);
+        put(at + 4, &entries[e].count, 4);
+        put(at + 8, &entries[e].value, 4);
+    }
+    // The next directory offset after the entries stays 0: one image
+    return true;
+}
+
+// Fixed-size pool of worker threads
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    bool stopping;
+    
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;  // Stopping and no work left
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    explicit ThreadPool(int threadCount) : stopping(false) {
+        for (int i = 0; i < threadCount; i++) {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+    
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        taskAvailable.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    int size() const {
+        return static_cast<int>(workers.size());
+    }
+    
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        taskAvailable.notify_one();
+    }
+    
+    // Run fn(i) for every i in [0, n) on the workers and the calling thread,
+    // returning once every call has finished. The caller claims indices
+    // itself, so it never waits on helpers that have not started yet.
+    void parallelFor(int n, const std::function<void(int)>& fn) {
+        if (n <= 0) {
+            return;
+        }
+        
+        struct Batch {
+            std::function<void(int)> fn;
+            int n;
+            std::atomic<int> next;
+            std::atomic<int> done;
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        
+        auto batch = std::make_shared<Batch>();
+        batch->fn = fn;
+        batch->n = n;
+        batch->next = 0;
+        batch->done = 0;
+        
+        auto runBatch = [](Batch& b) {
+            for (;;) {
+                int i = b.next.fetch_add(1);
+                if (i >= b.n) {
+                    return;
+                }
+                b.fn(i);
+                if (b.done.fetch_add(1) + 1 == b.n) {
+                    std::lock_guard<std::mutex> lock(b.mutex);
+                    b.finished.notify_all();
+                }
+            }
+        };
+        
+        int helpers = std::min(size(), n - 1);
+        for (int i = 0; i < helpers; i++) {
+            submit([batch, runBatch] { runBatch(*batch); });
+        }
+        runBatch(*batch);
+        
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->finished.wait(lock, [&batch] { return batch->done.load() == batch->n; });
+    }
+};
+
+// Eviction policies for ChunkCache
+enum CachePolicy {
+    CACHE_POLICY_LRU = 0,    // Evict the least recently used chunks first
+    CACHE_POLICY_CLOCK = 1   // Second chance: skip chunks used since the last sweep
+};
+
+// Snapshot of chunk cache counters, laid out for the C API
+struct CacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t bytesResident;
+    uint64_t chunksResident;
+    uint64_t byteBudget;
+};
+
+// Build with -DTERRAIN_STATS=0 to compile the hot-path counters out
+#ifndef TERRAIN_STATS
+#define TERRAIN_STATS 1
+#endif
+
+// Latency histogram bucket i counts durations in [2^i, 2^(i+1))
+// microseconds; bucket 0 also holds anything shorter and the last bucket
+// anything longer
+static const int kStatsHistogramBuckets = 24;
+
+// Snapshot of generator and planner counters, laid out for the C API.
+// Times are summed wall times in nanoseconds.
+struct TerrainStats {
+    uint64_t enabled;  // 0 if the library was built without counters
+    uint64_t chunkGenerations;
+    uint64_t chunkGenerationNs;
+    uint64_t noiseEvaluations;  // Octave noise samples, cells x octaves
+    uint64_t cacheHits;
+    uint64_t cacheMisses;
+    uint64_t evictions;
+    uint64_t bytesResident;
+    uint64_t chunksResident;
+    uint64_t pathSearches;
+    uint64_t pathExpansions;
+    uint64_t pathNs;
+    uint64_t chunkLatency[kStatsHistogramBuckets];
+    uint64_t pathLatency[kStatsHistogramBuckets];
+    uint64_t poolBytes;        // Slab memory reserved for chunk cells
+    uint64_t poolBuffersFree;  // Recycled cell buffers waiting for a chunk
+    uint64_t poolHugePages;    // 1 if every slab is backed by huge pages
+};
+
+// Wall clock for one measured operation; free when counters are compiled out
+class StatsTimer {
+#if TERRAIN_STATS
+private:
+    std::chrono::steady_clock::time_point started;
+
+public:
+    StatsTimer() : started(std::chrono::steady_clock::now()) {}
+    
+    uint64_t elapsedNs() const {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count());
+    }
+#else
+public:
+    uint64_t elapsedNs() const { return 0; }
+#endif
+};
+
+// Counters for chunk generation and path searches. Each thread writes its
+// own padded slot with relaxed atomic adds, so recording never contends on
+// a shared cache line; snapshots sum the slots and may be slightly behind
+// operations still in flight.
+class TerrainMetrics {
+private:
+    enum Counter {
+        COUNTER_CHUNK_GENERATIONS,
+        COUNTER_CHUNK_GENERATION_NS,
+        COUNTER_NOISE_EVALUATIONS,
+        COUNTER_PATH_SEARCHES,
+        COUNTER_PATH_EXPANSIONS,
+        COUNTER_PATH_NS,
+        COUNTER_COUNT
+    };
+
+#if TERRAIN_STATS
+    struct Slot {
+        std::atomic<uint64_t> counters[COUNTER_COUNT];
+        std::atomic<uint64_t> chunkLatency[kStatsHistogramBuckets];
+        std::atomic<uint64_t> pathLatency[kStatsHistogramBuckets];
+        char padding[64];
+    };
+    
+    static const int kSlots = 16;
+    Slot slots[kSlots];
+    
+    // Threads are handed slots round robin on first use
+    static int slotIndex() {
+        static std::atomic<unsigned int> nextSlot(0);
+        thread_local int index = static_cast<int>(nextSlot.fetch_add(1, std::memory_order_relaxed) % kSlots);
+        return index;
+    }
+    
+    static int histogramBucket(uint64_t ns) {
+        uint64_t micros = ns / 1000;
+        int bucket = 0;
+        while (micros > 1 && bucket < kStatsHistogramBuckets - 1) {
+            micros >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+    
+    static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+#endif
+
+public:
+    TerrainMetrics() {
+        reset();
+    }
+    
+    void recordChunkGeneration(uint64_t noiseEvaluations, uint64_t ns) {
+#if TERRAIN_STATS
+        Slot& slot = slots[slotIndex()];
+        add(slot.counters[COUNTER_CHUNK_GENERATIONS], 1);
+        add(slot.counters[COUNTER_CHUNK_GENERATION_NS], ns);
+        add(slot.counters[COUNTER_NOISE_EVALUATIONS], noiseEvaluations);
+        add(slot.chunkLatency[histogramBucket(ns)], 1);
+#else
+        (void)noiseEvaluations;
+        (void)ns;
+#endif
+    }
+    
+    void recordPathSearch(uint64_t expansions, uint64_t ns) {
+#if TERRAIN_STATS
+        Slot& slot = slots[slotIndex()];
+        add(slot.counters[COUNTER_PATH_SEARCHES], 1);
+        add(slot.counters[COUNTER_PATH_EXPANSIONS], expansions);
+        add(slot.counters[COUNTER_PATH_NS], ns);
+        add(slot.pathLatency[histogramBucket(ns)], 1);
+#else
+        (void)expansions;
+        (void)ns;
+#endif
+    }
+    
+    // Fill the generator and planner fields of stats; cache fields are left
+    // to the caller
+    void snapshot(TerrainStats& stats) const {
+        std::memset(&stats, 0, sizeof(stats));
+#if TERRAIN_STATS
+        stats.enabled = 1;
+        uint64_t totals[COUNTER_COUNT] = {};
+        for (const Slot& slot : slots) {
+            for (int i = 0; i < COUNTER_COUNT; i++) {
+                totals[i] += slot.counters[i].load(std::memory_order_relaxed);
+            }
+            for (int i = 0; i < kStatsHistogramBuckets; i++) {
+                stats.chunkLatency[i] += slot.chunkLatency[i].load(std::memory_order_relaxed);
+                stats.pathLatency[i] += slot.pathLatency[i].load(std::memory_order_relaxed);
+            }
+        }
+        stats.chunkGenerations = totals[COUNTER_CHUNK_GENERATIONS];
+        stats.chunkGenerationNs = totals[COUNTER_CHUNK_GENERATION_NS];
+        stats.noiseEvaluations = totals[COUNTER_NOISE_EVALUATIONS];
+        stats.pathSearches = totals[COUNTER_PATH_SEARCHES];
+        stats.pathExpansions = totals[COUNTER_PATH_EXPANSIONS];
+        stats.pathNs = totals[COUNTER_PATH_NS];
+#endif
+    }
+    
+    void reset() {
+#if TERRAIN_STATS
+        for (Slot& slot : slots) {
+            for (std::atomic<uint64_t>& counter : slot.counters) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+            for (int i = 0; i < kStatsHistogramBuckets; i++) {
+                slot.chunkLatency[i].store(0, std::memory_order_relaxed);
+                slot.pathLatency[i].store(0, std::memory_order_relaxed);
+            }
+        }
+#endif
+    }
+};
+
+// Thread-safe cache of generated chunks with an optional byte budget.
+// Entries are split into independently locked shards so that threads working
+// on different chunks rarely contend; locks are only held for lookups and
+// inserts, never while a chunk is generated. When an insert takes the cache
+// over budget, unpinned chunks are evicted in policy order until it is back
+// under 90% of the budget.
+class ChunkCache {
+public:
+    typedef std::pair<int, int> Key;
+
+private:
+    struct Entry {
+        ChunkPtr chunk;
+        uint64_t lastAccess;   // Access tick, for LRU
+        uint64_t insertOrder;  // Position on the clock, for CLOCK
+        bool referenced;       // Used since the clock hand last passed
+    };
+    
+    // Hit and miss counts live beside each shard's lock, so lookups never
+    // touch a counter shared by every thread
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<Key, Entry, ChunkCoordHash> entries;
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> misses;
+        
+        Shard() : hits(0), misses(0) {}
+    };
+    
+    static const int kShards = 64;
+    Shard shards[kShards];
+    
+    std::atomic<uint64_t> tick;
+    std::atomic<uint64_t> evictions;
+    std::atomic<uint64_t> bytesResident;
+    std::atomic<uint64_t> chunksResident;
+    std::atomic<uint64_t> byteBudget;
+    
+    // Guards eviction state; only one thread evicts at a time
+    std::mutex evictMutex;
+    CachePolicy policy;
+    uint64_t clockHand;
+    std::unordered_set<Key, ChunkCoordHash> pinned;
+    
+    Shard& shardFor(const Key& key) {
+        unsigned int h = static_cast<unsigned int>(key.first) * 73856093u ^
+                         static_cast<unsigned int>(key.second) * 19349663u;
+        return shards[h % kShards];
+    }
+    
+    static uint64_t chunkBytes(const ChunkPtr& chunk) {
+        return chunk->byteSize();
+    }
+    
+    // Remove an entry while its shard is locked
+    void eraseLocked(Shard& shard, std::unordered_map<Key, Entry, ChunkCoordHash>::iterator it) {
+        bytesResident -= chunkBytes(it->second.chunk);
+        chunksResident--;
+        evictions++;
+        shard.entries.erase(it);
+    }
+    
+    // Evict unpinned chunks in policy order until under 90% of the budget.
+    // Called with evictMutex held.
+    void evictLocked() {
+        uint64_t budget = byteBudget.load();
+        if (budget == 0 || bytesResident.load() <= budget) {
+            return;
+        }
+        uint64_t target = budget - budget / 10;
+        
+        struct Candidate {
+            Key key;
+            uint64_t lastAccess;
+            uint64_t insertOrder;
+            bool referenced;
+        };
+        
+        // Snapshot every unpinned entry; chunks are large, so there are few
+        std::vector<Candidate> candidates;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& entry : shard.entries) {
+                if (pinned.count(entry.first) == 0) {
+                    candidates.push_back({entry.first, entry.second.lastAccess,
+                                          entry.second.insertOrder, entry.second.referenced});
+                }
+            }
+        }
+        
+        if (policy == CACHE_POLICY_LRU) {
+            std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+                return a.lastAccess < b.lastAccess;
+            });
+        } else {
+            // Start the sweep just after the clock hand and wrap around
+            uint64_t hand = clockHand;
+            std::sort(candidates.begin(), candidates.end(), [hand](const Candidate& a, const Candidate& b) {
+                bool aAfter = a.insertOrder > hand;
+                bool bAfter = b.insertOrder > hand;
+                if (aAfter != bAfter) {
+                    return aAfter;
+                }
+                return a.insertOrder < b.insertOrder;
+            });
+        }
+        
+        // CLOCK gives referenced chunks a second chance on the first pass
+        int passes = policy == CACHE_POLICY_CLOCK ? 2 : 1;
+        for (int pass = 0; pass < passes && bytesResident.load() > target; pass++) {
+            for (const Candidate& candidate : candidates) {
+                if (bytesResident.load() <= target) {
+                    break;
+                }
+                
+                Shard& shard = shardFor(candidate.key);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto it = shard.entries.find(candidate.key);
+                if (it == shard.entries.end()) {
+                    continue;
+                }
+                
+                clockHand = candidate.insertOrder;
+                if (policy == CACHE_POLICY_CLOCK && it->second.referenced) {
+                    it->second.referenced = false;
+                    continue;
+                }
+                
+                eraseLocked(shard, it);
+            }
+        }
+    }
+
+public:
+    ChunkCache()
+        : tick(0), evictions(0), bytesResident(0), chunksResident(0),
+          byteBudget(0), policy(CACHE_POLICY_LRU), clockHand(0) {}
+    
+    // Look up a chunk, returning nullptr on a miss
+    ChunkPtr find(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            shard.misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+        it->second.lastAccess = tick.fetch_add(1, std::memory_order_relaxed);
+        it->second.referenced = true;
+        return it->second.chunk;
+    }
+    
+    // Look up a chunk without counting a hit or miss or marking it used
+    ChunkPtr peek(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        return it != shard.entries.end() ? it->second.chunk : nullptr;
+    }
+    
+    bool contains(const Key& key) {
+        return peek(key) != nullptr;
+    }
+    
+    // Store a chunk and return the cached copy. If another thread stored the
+    // same chunk first, that chunk is kept and returned instead.
+    ChunkPtr insert(const Key& key, ChunkPtr chunk) {
+        ChunkPtr stored;
+        {
+            Shard& shard = shardFor(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            
+            uint64_t now = tick.fetch_add(1, std::memory_order_relaxed);
+            auto result = shard.entries.emplace(key, Entry{chunk, now, now, true});
+            stored = result.first->second.chunk;
+            
+            if (result.second) {
+                bytesResident += chunkBytes(chunk);
+                chunksResident++;
+            }
+        }
+        
+        uint64_t budget = byteBudget.load();
+        if (budget > 0 && bytesResident.load() > budget) {
+            // Another thread evicting already will bring the cache under budget
+            std::unique_lock<std::mutex> lock(evictMutex, std::try_to_lock);
+            if (lock.owns_lock()) {
+                evictLocked();
+            }
+        }
+        
+        return stored;
+    }
+    
+    // Remove every chunk for which pred(key) is true, pinned or not
+    template <typename Predicate>
+    void eraseIf(Predicate pred) {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.entries.begin(); it != shard.entries.end(); ) {
+                if (pred(it->first)) {
+                    auto victim = it++;
+                    eraseLocked(shard, victim);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+    
+    // Drop every chunk without counting evictions
+    void clear() {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& entry : shard.entries) {
+                bytesResident -= chunkBytes(entry.second.chunk);
+                chunksResident--;
+            }
+            shard.entries.clear();
+        }
+    }
+    
+    // Limit resident chunk data to budget bytes (0 = unlimited)
+    void setByteBudget(uint64_t budget) {
+        byteBudget = budget;
+        std::lock_guard<std::mutex> lock(evictMutex);
+        evictLocked();
+    }
+    
+    void setPolicy(CachePolicy newPolicy) {
+        std::lock_guard<std::mutex> lock(evictMutex);
+        policy = newPolicy;
+    }
+    
+    // Replace the set of chunks that are never evicted by the budget
+    void setPinned(const std::vector<Key>& keys) {
+        std::lock_guard<std::mutex> lock(evictMutex);
+        pinned.clear();
+        for (const Key& key : keys) {
+            pinned.insert(key);
+        }
+    }
+    
+    CacheStats stats() const {
+        CacheStats result;
+        result.hits = 0;
+        result.misses = 0;
+        for (const Shard& shard : shards) {
+            result.hits += shard.hits.load(std::memory_order_relaxed);
+            result.misses += shard.misses.load(std::memory_order_relaxed);
+        }
+        result.evictions = evictions.load();
+        result.bytesResident = bytesResident.load();
+        result.chunksResident = chunksResident.load();
+        result.byteBudget = byteBudget.load();
+        return result;
+    }
+};
+
+// Background generation queue for chunks that will be needed soon.
+// A single worker thread, started on first use, pops requests in priority
+// order (highest first, FIFO among equal priorities) and hands them to the
+// load callback. Re-requesting a queued chunk at a higher priority moves it
+// forward; outdated queue entries are skipped when popped.
+class ChunkPrefetcher {
+public:
+    typedef std::pair<int, int> Key;
+
+private:
+    struct Request {
+        int priority;
+        uint64_t sequence;
+        Key key;
+        
+        // Orders the max-heap: higher priority first, then oldest first
+        bool operator<(const Request& other) const {
+            if (priority != other.priority) {
+                return priority < other.priority;
+            }
+            return sequence > other.sequence;
+        }
+    };
+    
+    std::function<void(int, int)> load;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::priority_queue<Request> queue;
+    std::unordered_map<Key, int, ChunkCoordHash> queued;  // Key -> current priority
+    uint64_t nextSequence;
+    bool busy;
+    bool stopping;
+    
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            changed.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return;
+            }
+            
+            Request request = queue.top();
+            queue.pop();
+            
+            // Skip entries superseded by a higher priority request or a cancel
+            auto it = queued.find(request.key);
+            if (it == queued.end() || it->second != request.priority) {
+                continue;
+            }
+            queued.erase(it);
+            
+            busy = true;
+            lock.unlock();
+            load(request.key.first, request.key.second);
+            lock.lock();
+            busy = false;
+            changed.notify_all();
+        }
+    }
+
+public:
+    explicit ChunkPrefetcher(std::function<void(int, int)> load)
+        : load(std::move(load)), nextSequence(0), busy(false), stopping(false) {}
+    
+    ~ChunkPrefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    
+    // Queue chunks for background generation
+    void request(const std::vector<Key>& keys, int priority) {
+        if (keys.empty()) {
+            return;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const Key& key : keys) {
+                auto result = queued.emplace(key, priority);
+                if (!result.second) {
+                    if (result.first->second >= priority) {
+                        continue;  // Already queued at least as urgently
+                    }
+                    result.first->second = priority;
+                }
+                queue.push({priority, nextSequence++, key});
+            }
+            
+            if (!worker.joinable()) {
+                worker = std::thread(&ChunkPrefetcher::workerLoop, this);
+            }
+        }
+        changed.notify_all();
+    }
+    
+    // Drop every queued request. A chunk already being generated is
+    // finished and cached; with wait set, returns only after it is done.
+    void cancel(bool wait) {
+        std::unique_lock<std::mutex> lock(mutex);
+        queue = std::priority_queue<Request>();
+        queued.clear();
+        if (wait) {
+            changed.wait(lock, [this] { return !busy; });
+        }
+    }
+    
+    // Number of chunks still waiting to be generated
+    int pending() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return static_cast<int>(queued.size());
+    }
+};
+
+// A rectangle of cells whose elevations may have changed
+struct TerrainChange {
+    uint64_t sequence;
+    int x0;
+    int y0;
+    int width;
+    int height;
+};
+
+// Lower bound an A* search estimates the remaining cost with
+enum PathHeuristic {
+    PATH_HEURISTIC_MANHATTAN = 0,     // Legacy estimate; overestimates diagonal steps
+    PATH_HEURISTIC_OCTILE_CLIMB = 1,  // Octile distance plus the weighted climb to the goal
+    PATH_HEURISTIC_LANDMARKS = 2      // Also the ALT bound from landmark distance tables
+};
+
+// Clearance from blocked cells is measured up to this many cells
+static const int kMaxClearance = 16;
+
+// How close path searches may pass to obstacles and steep cells. Clearance
+// is the distance in cells from a cell's centre to the nearest blocked
+// cell's, so a free cell next to an obstacle has clearance 1. Both ends of
+// a step need the required clearance, and a step costs extra for every cell
+// either end falls short of the preferred clearance, keeping steps
+// symmetric.
+struct ClearanceRule {
+    double required;   // Cells with less clearance are impassable
+    double preferred;  // Cells with less clearance cost extra
+    double weight;     // Extra cost per step length and missing cell of clearance
+    
+    bool active() const { return required > 0 || (preferred > 0 && weight > 0); }
+    
+    // Extra cost of a step end with this clearance, infinite if it is
+    // below the required one
+    double penalty(float clearance) const {
+        if (clearance < required) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return clearance < preferred ? weight * (preferred - clearance) : 0.0;
+    }
+};
+
+// Slots for data derived from the whole terrain, dropped with the mip levels
+enum TerrainAnnotation {
+    TERRAIN_ANNOTATION_LANDMARKS = 0,  // LandmarkTable per elevation weight
+    TERRAIN_ANNOTATION_COUNT
+};
+
+// Main TerrainGenerator class
+class TerrainGenerator {
+private:
+    int width;
+    int height;
+    int maxElevation;
+    int chunkSize;
+    int seed;
+    
+    double scale;
+    int octaves;
+    double persistence;
+    double lacunarity;
+    double obstacleProb;
+    
+    SimplexNoise noiseGen;
+    NoiseKernel noiseKernel;
+    bool presetKernels;  // Use the FractalNoise specializations where they apply
+    ChunkFormat chunkFormat;
+    ChunkLayout chunkLayout;  // Cell order of cached float chunks and mip tiles
+    
+    // Cell buffers for generated chunks and mip tiles
+    std::shared_ptr<ChunkBufferPool> bufferPool;
+    
+    // Cache of generated chunks
+    ChunkCache cache;
+    
+    // Coarse mip levels, keyed by (level, tile index). A level L tile holds
+    // chunkSize x chunkSize samples 2^L cells apart.
+    static const int kMaxLodLevel = 15;
+    static const uint64_t kLodCacheBudget = 64ull * 1024 * 1024;
+    ChunkCache lodCache;
+    
+    // Optional on-disk tiles, consulted on cache misses
+    std::unique_ptr<ChunkStore> store;
+    uint64_t storedParamsHash;
+    
+    // External heightfield chunks are built from instead of the noise
+    std::shared_ptr<const HeightfieldSource> heightfield;
+    
+    // Worker pool for batch chunk generation, created on first use
+    std::mutex poolMutex;
+    std::unique_ptr<ThreadPool> pool;
+    int threadCount;
+    
+    // Elevation weight that per-chunk edge cost fields are kept for, or 0
+    double edgeCostWeight;
+    
+    // Heuristic used by A* searches, and landmarks per ALT table
+    PathHeuristic pathHeuristic;
+    int landmarkCount;
+    
+    // Distance path searches keep from obstacles and steep cells
+    ClearanceRule pathClearance;
+    
+    mutable std::mutex annotationMutex;
+    std::shared_ptr<const void> annotations[TERRAIN_ANNOTATION_COUNT];
+    
+    // Held while an annotation is built, so concurrent builders wait for
+    // the first instead of repeating its work
+    std::mutex annotationBuildMutex;
+    
+    // Generation and planner counters; recorded from const builders too
+    mutable TerrainMetrics metrics;
+    
+    // Recent cell changes, so incremental planners can repair their state
+    static const size_t kMaxChanges = 4096;
+    std::mutex changeMutex;
+    std::deque<TerrainChange> changes;
+    uint64_t changeSequence;
+    uint64_t resetSequence;
+    
+    // Chunks edited since they were cached; their edits are lost if they
+    // are evicted and regenerated
+    std::unordered_set<std::pair<int, int>, ChunkCoordHash> editedChunks;
+    
+    // Whether any cell changed since the last reset
+    bool cellsChanged;
+    
+    // Sequence of the newest change that may have lowered a step cost, and
+    // of the last reset, when every cell was as generated
+    uint64_t loweringSequence;
+    uint64_t regeneratedSequence;
+    
+    void recordChangeLocked(int x0, int y0, int w, int h, bool mayLower = true) {
+        cellsChanged = true;
+        changes.push_back({++changeSequence, x0, y0, w, h});
+        if (mayLower) {
+            loweringSequence = changeSequence;
+        }
+        if (changes.size() > kMaxChanges) {
+            changes.pop_front();
+        }
+    }
+    
+    // Edited chunks evicted since they were recorded will come back
+    // regenerated
+    void recordEvictedEditsLocked() {
+        for (auto it = editedChunks.begin(); it != editedChunks.end(); ) {
+            if (!cache.contains(*it)) {
+                recordChangeLocked(it->first * chunkSize, it->second * chunkSize, chunkSize, chunkSize);
+                it = editedChunks.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+    // Every cell may have changed; planners start over
+    void recordReset() {
+        std::lock_guard<std::mutex> lock(changeMutex);
+        resetSequence = ++changeSequence;
+        changes.clear();
+        editedChunks.clear();
+        cellsChanged = false;
+        loweringSequence = resetSequence;
+        regeneratedSequence = resetSequence;
+    }
+    
+    // Background chunk generation. Declared last so its worker stops before
+    // anything it uses is destroyed.
+    ChunkPrefetcher prefetcher;
+    
+    // Hash of everything that affects generated cell values, naming the
+    // tiles in the chunk store
+    uint64_t paramsHash() const {
+        // All float kernels produce identical cells; the reference differs
+        uint64_t words[] = {
+            static_cast<uint64_t>(width), static_cast<uint64_t>(height),
+            static_cast<uint64_t>(maxElevation), static_cast<uint64_t>(chunkSize),
+            static_cast<uint64_t>(octaves), 0, 0, 0, 0,
+            noiseKernel == NOISE_KERNEL_REFERENCE ? 1u : 0u,
+            heightfield ? heightfield->getIdentity() : 0
+        };
+        std::memcpy(&words[5], &scale, sizeof(double));
+        std::memcpy(&words[6], &persistence, sizeof(double));
+        std::memcpy(&words[7], &lacunarity, sizeof(double));
+        std::memcpy(&words[8], &obstacleProb, sizeof(double));
+        
+        uint64_t h = 0;
+        for (uint64_t word : words) {
+            h = mix64(h ^ word);
+        }
+        return h;
+    }
+    
+    // Point the chunk store at the tiles for the current parameters. Cached
+    // chunks are dropped if the parameters changed.
+    void refreshParamsHash() {
+        if (!store) {
+            return;
+        }
+        uint64_t hash = paramsHash();
+        if (hash != storedParamsHash) {
+            storedParamsHash = hash;
+            store->setParamsHash(hash);
+            cache.clear();
+        }
+    }
+    
+    // Switch chunk sources; everything built from the old one is dropped
+    void replaceHeightfield(std::shared_ptr<const HeightfieldSource> source) {
+        prefetcher.cancel(true);
+        heightfield = std::move(source);
+        cache.clear();
+        lodCache.clear();
+        clearAnnotations();
+        refreshParamsHash();
+        recordReset();
+    }
+    
+    // A chunk for export: the cached one, the stored tile or a fresh build,
+    // without caching it. nullptr outside the world.
+    ChunkPtr exportChunk(int chunkX, int chunkY) {
+        if (chunkX < 0 || chunkY < 0 || chunkX * chunkSize >= width || chunkY * chunkSize >= height) {
+            return nullptr;
+        }
+        ChunkPtr chunk = cache.peek({chunkX, chunkY});
+        if (!chunk && store) {
+            chunk = store->load(chunkX, chunkY, chunkSize, bufferPool);
+        }
+        return chunk ? chunk : buildChunk(chunkX, chunkY);
+    }
+    
+    ThreadPool& getPool() {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (!pool) {
+            // The calling thread also works, so it counts towards threadCount
+            pool.reset(new ThreadPool(std::max(0, threadCount - 1)));
+        }
+        return *pool;
+    }
+
+    // Smallest sample index i >= 0 with origin + i * step >= bound
+    static int firstSampleAtOrAfter(int origin, int step, int bound) {
+        if (origin >= bound) {
+            return 0;
+        }
+        return (bound - origin + step - 1) / step;
+    }
+    
+    // Look up the elevation of each coordinate, reusing the previous chunk
+    // while consecutive coordinates stay inside it
+    template <typename Visitor>
+    void forEachSample(const int* xs, const int* ys, int n, Visitor visit) {
+        ChunkPtr chunk;
+        int lastChunkX = 0;
+        int lastChunkY = 0;
+        
+        for (int i = 0; i < n; i++) {
+            int x = xs[i];
+            int y = ys[i];
+            
+            if (x < 0 || x >= width || y < 0 || y >= height) {
+                visit(i, -1.0f);  // Out of bounds - treated as obstacle
+                continue;
+            }
+            
+            int chunkX = x / chunkSize;
+            int chunkY = y / chunkSize;
+            if (!chunk || chunkX != lastChunkX || chunkY != lastChunkY) {
+                chunk = getChunk(chunkX, chunkY);
+                lastChunkX = chunkX;
+                lastChunkY = chunkY;
+            }
+            
+            visit(i, chunk->at(x % chunkSize, y % chunkSize));
+        }
+    }
+
+public:
+    // cacheDir names a directory for the on-disk chunk store; leave it empty
+    // to keep chunks in memory only
+    TerrainGenerator(int width, int height, int maxElevation, int chunkSize, int seed,
+                     const std::string& cacheDir = "") 
+        : width(width), height(height), maxElevation(maxElevation), chunkSize(chunkSize), 
+          seed(seed), noiseGen(seed), noiseKernel(bestNoiseKernel()),
+          presetKernels(true), chunkFormat(CHUNK_FORMAT_FLOAT32), chunkLayout(CHUNK_LAYOUT_LINEAR),
+          bufferPool(std::make_shared<ChunkBufferPool>(static_cast<size_t>(chunkSize) * chunkSize, false)),
+          storedParamsHash(0), edgeCostWeight(0.0),
+          pathHeuristic(PATH_HEURISTIC_OCTILE_CLIMB), landmarkCount(8), pathClearance{0.0, 0.0, 0.0},
+          changeSequence(0), resetSequence(0), cellsChanged(false),
+          loweringSequence(0), regeneratedSequence(0),
+          prefetcher([this](int chunkX, int chunkY) { getChunk(chunkX, chunkY); }) {
+        
+        lodCache.setByteBudget(kLodCacheBudget);
+        
+        // Default terrain parameters
+        scale = 0.01;
+        octaves = 6;
+        persistence = 0.5;
+        lacunarity = 2.0;
+        obstacleProb = 0.2;
+        
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 0 ? static_cast<int>(hardwareThreads) : 1;
+        
+        if (!cacheDir.empty()) {
+            store.reset(new ChunkStore(cacheDir, seed));
+            storedParamsHash = paramsHash();
+            store->setParamsHash(storedParamsHash);
+        }
+    }
+    
+    // Set terrain generation parameters. Queued prefetches are dropped and
+    // any in flight finished first; not safe to call while other threads
+    // are generating chunks.
+    void setParameters(double scale, int octaves, double persistence, double lacunarity, double obstacleProb) {
+        prefetcher.cancel(true);
+        
+        this->scale = scale;
+        this->octaves = octaves;
+        this->persistence = persistence;
+        this->lacunarity = lacunarity;
+        this->obstacleProb = obstacleProb;
+        
+        lodCache.clear();
+        clearAnnotations();
+        refreshParamsHash();
+        recordReset();
+    }
+    
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getMaxElevation() const { return maxElevation; }
+    int getChunkSize() const { return chunkSize; }
+    
+    // Select the noise kernel used for chunk generation. Unsupported kernels
+    // and NOISE_KERNEL_AUTO select the best one for this CPU. Returns the
+    // kernel actually selected. Not safe to call while chunks are generated.
+    NoiseKernel setNoiseKernel(NoiseKernel kernel) {
+        prefetcher.cancel(true);
+        noiseKernel = noiseKernelSupported(kernel) ? kernel : bestNoiseKernel();
+        lodCache.clear();
+        clearAnnotations();
+        refreshParamsHash();
+        recordReset();
+        return noiseKernel;
+    }
+    
+    // Enable or disable the compile-time specialized kernels for the preset
+    // octave counts and chunk sizes. They produce the same chunks as the
+    // generic kernels, so nothing cached is dropped; this exists to compare
+    // the two.
+    void setPresetKernels(bool enabled) {
+        presetKernels = enabled;
+    }
+    
+    // Back chunk cells with huge pages where the system provides them.
+    // Chunks built from now on come from a new pool; existing ones keep
+    // their buffers until released. Not safe to call while chunks are
+    // generated.
+    void setHugePages(bool enabled) {
+        if (enabled == bufferPool->usesHugePages()) {
+            return;
+        }
+        prefetcher.cancel(true);
+        bufferPool = std::make_shared<ChunkBufferPool>(static_cast<size_t>(chunkSize) * chunkSize, enabled);
+    }
+    
+    // Select how cached chunks are stored. Drops every cached chunk; not safe
+    // to call while chunks are generated.
+    void setChunkFormat(ChunkFormat format) {
+        prefetcher.cancel(true);
+        chunkFormat = format;
+        cache.clear();
+        recordReset();
+    }
+    
+    // Select the cell order of cached float chunks and mip tiles (see
+    // ChunkLayout). Layouts the chunk size does not support fall back to
+    // CHUNK_LAYOUT_LINEAR. Returns the layout actually selected. Drops every
+    // cached chunk and tile; not safe to call while chunks are generated.
+    ChunkLayout setChunkLayout(ChunkLayout layout) {
+        prefetcher.cancel(true);
+        chunkLayout = chunkLayoutSupported(layout, chunkSize) ? layout : CHUNK_LAYOUT_LINEAR;
+        cache.clear();
+        lodCache.clear();
+        clearAnnotations();
+        recordReset();
+        return chunkLayout;
+    }
+    
+    ChunkLayout getChunkLayout() const { return chunkLayout; }
+    
+    // Keep an 8-direction step cost field with each chunk for searches using
+    // this elevation weight (<= 0 to stop). Fields are built the first time
+    // a search reads a chunk and take 8 floats per cell. Not safe to call
+    // while searches run.
+    void setEdgeCostWeight(double weight) {
+        edgeCostWeight = weight > 0 ? weight : 0.0;
+    }
+    
+    double getEdgeCostWeight() const { return edgeCostWeight; }
+    
+    // Select the A* heuristic and how many landmarks ALT tables hold
+    // (clamped to 1..16). Not safe to call while searches run.
+    void setPathHeuristic(PathHeuristic heuristic, int landmarks) {
+        pathHeuristic = heuristic;
+        landmarks = std::max(1, std::min(16, landmarks));
+        if (landmarks != landmarkCount) {
+            landmarkCount = landmarks;
+            clearAnnotation(TERRAIN_ANNOTATION_LANDMARKS);
+        }
+    }
+    
+    PathHeuristic getPathHeuristic() const { return pathHeuristic; }
+    int getLandmarkCount() const { return landmarkCount; }
+    
+    // Keep path searches required cells from obstacles and steep cells, and
+    // charge weight per missing cell below preferred (both clamped to the
+    // clearance range; 0 and 0 to stop). Clearance fields are built with
+    // each chunk the first time a search reads it. Not safe to call while
+    // searches run.
+    void setPathClearance(double required, double preferred, double weight) {
+        double range = getClearanceRange();
+        pathClearance.required = std::max(0.0, std::min(range, required));
+        pathClearance.preferred = std::max(pathClearance.required, std::min(range, preferred));
+        pathClearance.weight = std::max(0.0, weight);
+        
+        // Step costs changed everywhere; incremental planners start over
+        std::lock_guard<std::mutex> lock(changeMutex);
+        resetSequence = ++changeSequence;
+        changes.clear();
+    }
+    
+    const ClearanceRule& getPathClearance() const { return pathClearance; }
+    
+    // Largest clearance fields measure. It stays below the chunk size so
+    // an edit only reaches the fields of its own and neighbouring chunks.
+    int getClearanceRange() const { return std::max(0, std::min(kMaxClearance, chunkSize - 1)); }
+    
+    // Derived data for the whole terrain, or nullptr if not computed yet
+    template <typename T>
+    std::shared_ptr<const T> getAnnotation(TerrainAnnotation slot) const {
+        std::lock_guard<std::mutex> lock(annotationMutex);
+        return std::static_pointer_cast<const T>(annotations[slot]);
+    }
+    
+    template <typename T>
+    void setAnnotation(TerrainAnnotation slot, std::shared_ptr<const T> annotation) {
+        std::lock_guard<std::mutex> lock(annotationMutex);
+        annotations[slot] = std::move(annotation);
+    }
+    
+    void clearAnnotation(TerrainAnnotation slot) {
+        std::lock_guard<std::mutex> lock(annotationMutex);
+        annotations[slot].reset();
+    }
+    
+    std::mutex& getAnnotationBuildMutex() { return annotationBuildMutex; }
+    
+    void clearAnnotations() {
+        std::lock_guard<std::mutex> lock(annotationMutex);
+        for (auto& annotation : annotations) {
+            annotation.reset();
+        }
+    }
+    
+    // Read or write a derived data file in the chunk store, named for the
+    // current seed and parameters. Without a store nothing is found or kept.
+    bool loadStoredBlob(const std::string& name, std::vector<char>& out) const {
+        return store && store->loadBlob(name, out);
+    }
+    
+    void saveStoredBlob(const std::string& name, const std::vector<char>& data) {
+        if (store) {
+            store->saveBlob(name, data);
+        }
+    }
+    
+    // Set the number of threads used for batch chunk generation
+    // (<= 0 uses one per hardware thread)
+    void setThreadCount(int count) {
+        if (count <= 0) {
+            unsigned int hardwareThreads = std::thread::hardware_concurrency();
+            count = hardwareThreads > 0 ? static_cast<int>(hardwareThreads) : 1;
+        }
+        
+        std::lock_guard<std::mutex> lock(poolMutex);
+        threadCount = count;
+        pool.reset();
+    }
+    
+    // Get chunk by coordinates, generating it on a cache miss. The returned
+    // pointer pins the chunk: it stays valid even after the chunk is unloaded.
+    ChunkPtr generateChunk(int chunkX, int chunkY) {
+        return getChunk(chunkX, chunkY);
+    }
+    
+    // Get the cached chunk, loading it from the chunk store or generating it
+    // on a miss. Safe to call from any
+    // thread. Costs a single hash lookup on a hit. If two threads miss on the
+    // same chunk at once both generate it and the first one stored wins.
+    ChunkPtr getChunk(int chunkX, int chunkY) {
+        std::pair<int, int> chunkKey(chunkX, chunkY);
+        
+        // Check if chunk already exists in cache
+        ChunkPtr chunk = cache.find(chunkKey);
+        if (chunk) {
+            return chunk;
+        }
+        
+        // Serve the stored tile, or generate the chunk and store it
+        if (store) {
+            chunk = store->load(chunkX, chunkY, chunkSize, bufferPool);
+        }
+        if (!chunk) {
+            chunk = buildChunk(chunkX, chunkY);
+            if (store) {
+                store->save(chunkX, chunkY, chunkSize, *chunk);
+            }
+        }
+        
+        // Tiles and freshly built chunks are float and linear; quantize or
+        // rearrange them for the cache
+        if (chunkFormat != CHUNK_FORMAT_FLOAT32) {
+            chunk = std::make_shared<ChunkData>(*chunk, chunkFormat);
+        } else if (chunkLayout != CHUNK_LAYOUT_LINEAR) {
+            chunk = std::make_shared<ChunkData>(*chunk, chunkLayout, bufferPool);
+        }
+        
+        // A chunk that was edited before being evicted has lost its edits
+        {
+            std::lock_guard<std::mutex> lock(changeMutex);
+            if (editedChunks.erase(chunkKey) > 0) {
+                recordChangeLocked(chunkX * chunkSize, chunkY * chunkSize, chunkSize, chunkSize);
+            }
+        }
+        
+        // Store the chunk in cache
+        return cache.insert(chunkKey, chunk);
+    }
+    
+    // Generate n chunks, given as interleaved (chunkX, chunkY) pairs, in
+    // parallel on the worker pool. Chunks already cached are skipped.
+    void generateChunks(const int* coords, int n) {
+        std::vector<std::pair<int, int>> pending;
+        pending.reserve(n);
+        for (int i = 0; i < n; i++) {
+            pending.push_back({coords[2 * i], coords[2 * i + 1]});
+        }
+        std::sort(pending.begin(), pending.end());
+        pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+        
+        getPool().parallelFor(static_cast<int>(pending.size()), [this, &pending](int i) {
+            getChunk(pending[i].first, pending[i].second);
+        });
+    }
+    
+    // Run fn(i) for every i in [0, n) on the worker pool and the calling
+    // thread, returning once all calls have finished
+    void parallelFor(int n, const std::function<void(int)>& fn) {
+        getPool().parallelFor(n, fn);
+    }
+    
+    // Queue n chunks, given as interleaved (chunkX, chunkY) pairs, for
+    // generation on the background thread. Higher priorities are generated
+    // first; chunks that are already cached or out of bounds are skipped.
+    void prefetchChunks(const int* coords, int n, int priority) {
+        int chunksX = (width + chunkSize - 1) / chunkSize;
+        int chunksY = (height + chunkSize - 1) / chunkSize;
+        
+        std::vector<ChunkPrefetcher::Key> keys;
+        keys.reserve(n);
+        for (int i = 0; i < n; i++) {
+            ChunkPrefetcher::Key key(coords[2 * i], coords[2 * i + 1]);
+            if (key.first < 0 || key.first >= chunksX || key.second < 0 || key.second >= chunksY) {
+                continue;
+            }
+            if (!cache.contains(key)) {
+                keys.push_back(key);
+            }
+        }
+        prefetcher.request(keys, priority);
+    }
+    
+    // Drop all queued prefetch requests
+    void cancelPrefetch() {
+        prefetcher.cancel(false);
+    }
+    
+    int pendingPrefetches() {
+        return prefetcher.pending();
+    }
+    
+    // Generate the elevation data for a chunk. Only reads immutable state,
+    // so any number of threads can build chunks at once.
+    ChunkPtr buildChunk(int chunkX, int chunkY) const {
+        return buildTile(chunkX * chunkSize, chunkY * chunkSize, 1, octaves);
+    }
+    
+    // Generate a chunkSize x chunkSize tile of samples stride cells apart
+    // starting at world cell (absX, absY), summing only the first
+    // octaveCount octaves. At stride 1 with every octave this is a chunk.
+    ChunkPtr buildTile(int absX, int absY, int stride, int octaveCount) const {
+        StatsTimer timer;
+        ChunkPtr chunk = generateTile(absX, absY, stride, octaveCount);
+        metrics.recordChunkGeneration(static_cast<uint64_t>(chunkSize) * chunkSize * octaveCount, timer.elapsedNs());
+        return chunk;
+    }
+    
+    // buildTile without the counters
+    ChunkPtr generateTile(int absX, int absY, int stride, int octaveCount) const {
+        // Create a new chunk
+        ChunkPtr chunkPtr = std::make_shared<ChunkData>(bufferPool);
+        float* chunk = chunkPtr->data();
+        
+        if (heightfield) {
+            heightfield->sampleTile(absX, absY, stride, chunkSize, chunk);
+            chunkPtr->updateObstacleMask();
+            return chunkPtr;
+        }
+        
+        if (noiseKernel != NOISE_KERNEL_REFERENCE) {
+            buildTileVectorized(absX, absY, stride, octaveCount, chunk);
+            chunkPtr->updateObstacleMask();
+            return chunkPtr;
+        }
+        
+        // Generate elevation values using simplex noise
+        for (int x = 0; x < chunkSize; x++) {
+            for (int y = 0; y < chunkSize; y++) {
+                // Calculate absolute coordinates
+                int worldX = absX + x * stride;
+                int worldY = absY + y * stride;
+                
+                // Generate elevation using multiple octaves of noise
+                double elevation = 0.0;
+                double amplitude = 1.0;
+                double frequency = 1.0;
+                
+                for (int i = 0; i < octaveCount; i++) {
+                    double nx = worldX * scale * frequency;
+                    double ny = worldY * scale * frequency;
+                    
+                    // Add noise contribution for this octave
+                    elevation += noiseGen.noise(nx, ny) * amplitude;
+                    
+                    // Update amplitude and frequency for next octave
+                    amplitude *= persistence;
+                    frequency *= lacunarity;
+                }
+                
+                chunk[x * chunkSize + y] = finishCell(elevation, worldX, worldY);
+            }
+        }
+        
+        chunkPtr->updateObstacleMask();
+        return chunkPtr;
+    }
+    
+    // Turn summed octave noise into the stored cell value
+    float finishCell(double noise, int worldX, int worldY) const {
+        // Randomly place obstacles (represented by -1)
+        if (cellRandom(seed, worldX, worldY) < obstacleProb) {
+            return -1.0f;
+        }
+        
+        // Normalize elevation to [0, 1] range and scale to max elevation
+        return static_cast<float>((noise + 1.0) / 2.0 * maxElevation);
+    }
+    
+    // Generate a tile with the SIMD noise kernel, one column (fixed x, all
+    // y) at a time
+    void buildTileVectorized(int absX, int absY, int stride, int octaveCount, float* chunk) const {
+        if (presetKernels && buildPresetTile(absX, absY, stride, octaveCount, chunk)) {
+            return;
+        }
+        
+        NoiseTables tables = {noiseGen.permTable(), noiseGen.permMod12Table(), kNoiseGradX, kNoiseGradY};
+        std::vector<NoiseOctave> columnOctaves(octaveCount);
+        std::vector<float> column(chunkSize);
+        
+        for (int x = 0; x < chunkSize; x++) {
+            int worldX = absX + x * stride;
+            
+            double amplitude = 1.0;
+            double frequency = 1.0;
+            for (int i = 0; i < octaveCount; i++) {
+                columnOctaves[i] = makeNoiseOctave(worldX * scale * frequency, absY * scale * frequency,
+                                                   stride * scale * frequency, amplitude);
+                amplitude *= persistence;
+                frequency *= lacunarity;
+            }
+            
+            fractalNoiseColumn(noiseKernel, tables, columnOctaves.data(), octaveCount, chunkSize, column.data());
+            
+            for (int y = 0; y < chunkSize; y++) {
+                chunk[x * chunkSize + y] = finishCell(column[y], worldX, absY + y * stride);
+            }
+        }
+    }
+    
+    // Generate a tile with a FractalNoise specialization if the parameters
+    // match a preset. Returns false, leaving the tile untouched, otherwise.
+    bool buildPresetTile(int absX, int absY, int stride, int octaveCount, float* chunk) const {
+        if (persistence != kPresetPersistence || lacunarity != kPresetLacunarity) {
+            return false;
+        }
+        switch (chunkSize) {
+            case 64:
+                return buildPresetTile<64>(absX, absY, stride, octaveCount, chunk);
+            case 128:
+                return buildPresetTile<128>(absX, absY, stride, octaveCount, chunk);
+            case 256:
+                return buildPresetTile<256>(absX, absY, stride, octaveCount, chunk);
+            default:
+                return false;
+        }
+    }
+    
+    template <int ChunkSize>
+    bool buildPresetTile(int absX, int absY, int stride, int octaveCount, float* chunk) const {
+        switch (octaveCount) {
+            case 4:
+                buildFixedTile<4, ChunkSize>(absX, absY, stride, chunk);
+                return true;
+            case 6:
+                buildFixedTile<6, ChunkSize>(absX, absY, stride, chunk);
+                return true;
+            case 8:
+                buildFixedTile<8, ChunkSize>(absX, absY, stride, chunk);
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    // buildTileVectorized with the octave count and chunk size fixed at
+    // compile time
+    template <int Octaves, int ChunkSize>
+    void buildFixedTile(int absX, int absY, int stride, float* chunk) const {
+        typedef FractalNoise<Octaves, ChunkSize> Noise;
+        NoiseTables tables = {noiseGen.permTable(), noiseGen.permMod12Table(), kNoiseGradX, kNoiseGradY};
+        NoiseOctave columnOctaves[Octaves];
+        float column[ChunkSize];
+        
+        for (int x = 0; x < ChunkSize; x++) {
+            int worldX = absX + x * stride;
+            Noise::columnOctaves(worldX, absY, stride, scale, columnOctaves);
+            Noise::column(noiseKernel, tables, columnOctaves, column);
+            
+            float* out = chunk + x * ChunkSize;
+            for (int y = 0; y < ChunkSize; y++) {
+                out[y] = finishCell(column[y], worldX, absY + y * stride);
+            }
+        }
+    }
+    
+    // Octaves worth evaluating at a level: those whose features still span
+    // at least one sample. The rest would only alias into noise.
+    static int getMaxLodLevel() { return kMaxLodLevel; }
+    
+    int lodOctaves(int level) const {
+        int count = 1;
+        double spacing = scale * lacunarity * (1 << level);
+        while (count < octaves && spacing <= 1.0) {
+            spacing *= lacunarity;
+            count++;
+        }
+        return count;
+    }
+    
+    // Floor division, for sample coordinates left of or above the world
+    static int floorDiv(int value, int divisor) {
+        int quotient = value / divisor;
+        return quotient * divisor > value ? quotient - 1 : quotient;
+    }
+    
+    // Get a level >= 1 tile, generating it straight from the noise on a miss
+    ChunkPtr getLodTile(int level, int tileX, int tileY) {
+        int tileSpan = chunkSize << level;
+        int tilesY = (height + tileSpan - 1) / tileSpan;
+        ChunkCache::Key key(level, tileX * tilesY + tileY);
+        
+        ChunkPtr tile = lodCache.find(key);
+        if (tile) {
+            return tile;
+        }
+        tile = buildTile(tileX * tileSpan, tileY * tileSpan, 1 << level, lodOctaves(level));
+        if (chunkLayout != CHUNK_LAYOUT_LINEAR) {
+            tile = std::make_shared<ChunkData>(*tile, chunkLayout, bufferPool);
+        }
+        return lodCache.insert(key, tile);
+    }
+    
+    // Get elevation at specified world coordinates
+    float getElevation(int x, int y) {
+        // Check if coordinates are within bounds
+        if (x < 0 || x >= width || y < 0 || y >= height) {
+            return -1.0f;  // Out of bounds - treated as obstacle
+        }
+        
+        // Calculate chunk coordinates
+        int chunkX = x / chunkSize;
+        int chunkY = y / chunkSize;
+        
+        // Calculate local coordinates within chunk
+        int localX = x % chunkSize;
+        int localY = y % chunkSize;
+        
+        // Get or generate the chunk
+        ChunkPtr chunk = getChunk(chunkX, chunkY);
+        
+        // Return elevation at specified position
+        return chunk->at(localX, localY);
+    }
+    
+    // Overwrite the elevation at the specified world coordinates. The change
+    // lives in the cached chunk and is lost if the chunk is unloaded.
+    void setElevation(int x, int y, float elevation) {
+        if (x < 0 || x >= width || y < 0 || y >= height) {
+            return;
+        }
+        
+        int chunkX = x / chunkSize;
+        int chunkY = y / chunkSize;
+        ChunkPtr chunk = getChunk(chunkX, chunkY);
+        chunk->set((x % chunkSize) * chunkSize + (y % chunkSize), elevation);
+        
+        {
+            std::lock_guard<std::mutex> lock(changeMutex);
+            editedChunks.insert({chunkX, chunkY});
+            recordChangeLocked(x, y, 1, 1, elevation >= 0);  // Placing an obstacle only removes steps
+        }
+        
+        // Derived data of this chunk, and of neighbours sharing its border
+        // or a corner, is now stale
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                ChunkPtr neighbour = cache.peek({chunkX + dx, chunkY + dy});
+                if (neighbour) {
+                    neighbour->clearAnnotations();
+                }
+            }
+        }
+    }
+    
+    // Check if a position is an obstacle
+    bool isObstacle(int x, int y) {
+        if (x < 0 || x >= width || y < 0 || y >= height) {
+            return true;  // Out of bounds - treated as obstacle
+        }
+        
+        ChunkPtr chunk = getChunk(x / chunkSize, y / chunkSize);
+        return chunk->isObstacle((x % chunkSize) * chunkSize + (y % chunkSize));
+    }
+    
+    // Get elevations for n arbitrary world coordinates. Consecutive
+    // coordinates in the same chunk share a single chunk lookup.
+    void getElevations(const int* xs, const int* ys, int n, float* out) {
+        forEachSample(xs, ys, n, [out](int i, float elevation) {
+            out[i] = elevation;
+        });
+    }
+    
+    // Check n arbitrary world coordinates for obstacles (1 = obstacle)
+    void getObstacles(const int* xs, const int* ys, int n, unsigned char* out) {
+        forEachSample(xs, ys, n, [out](int i, float elevation) {
+            out[i] = elevation < 0 ? 1 : 0;
+        });
+    }
+    
+    // Sample a w x h grid of elevations starting at (x0, y0) every step
+    // blocks. Output is x-major like chunk data: out[i * h + j] is the sample
+    // at (x0 + i * step, y0 + j * step). The region is walked chunk by chunk,
+    // so each chunk is looked up once however many samples fall inside it.
+    void getRegion(int x0, int y0, int w, int h, int step, float* out) {
+        if (w <= 0 || h <= 0) {
+            return;
+        }
+        if (step < 1) {
+            step = 1;
+        }
+        
+        // Out of bounds samples are treated as obstacles
+        std::fill(out, out + static_cast<size_t>(w) * h, -1.0f);
+        
+        // Range of sample indices that fall inside the world
+        int iBegin = std::min(w, firstSampleAtOrAfter(x0, step, 0));
+        int iEnd = std::min(w, firstSampleAtOrAfter(x0, step, width));
+        int jBegin = std::min(h, firstSampleAtOrAfter(y0, step, 0));
+        int jEnd = std::min(h, firstSampleAtOrAfter(y0, step, height));
+        
+        for (int i = iBegin; i < iEnd; ) {
+            int chunkX = (x0 + i * step) / chunkSize;
+            int iChunkEnd = std::min(iEnd, firstSampleAtOrAfter(x0, step, (chunkX + 1) * chunkSize));
+            
+            for (int j = jBegin; j < jEnd; ) {
+                int chunkY = (y0 + j * step) / chunkSize;
+                int jChunkEnd = std::min(jEnd, firstSampleAtOrAfter(y0, step, (chunkY + 1) * chunkSize));
+                
+                ChunkPtr chunk = getChunk(chunkX, chunkY);
+                
+                for (int ii = i; ii < iChunkEnd; ii++) {
+                    int localX = x0 + ii * step - chunkX * chunkSize;
+                    float* outColumn = out + static_cast<size_t>(ii) * h;
+                    
+                    for (int jj = j; jj < jChunkEnd; jj++) {
+                        outColumn[jj] = chunk->at(localX, y0 + jj * step - chunkY * chunkSize);
+                    }
+                }
+                
+                j = jChunkEnd;
+            }
+            
+            i = iChunkEnd;
+        }
+    }
+    
+    // Sample a w x h grid of mip level `level`, where samples lie 2^level
+    // cells apart on multiples of 2^level. out[i * h + j] is the sample at
+    // world cell ((x0 / 2^level + i) * 2^level, (y0 / 2^level + j) * 2^level),
+    // with x0 and y0 rounded down to the level's grid. Level 0 is the full
+    // resolution terrain; coarser levels come from their own cache of tiles
+    // evaluated from the noise with fewer octaves, so they never load
+    // full-resolution chunks and do not show setElevation edits.
+    void getRegionLod(int x0, int y0, int w, int h, int level, float* out) {
+        if (level <= 0) {
+            getRegion(x0, y0, w, h, 1, out);
+            return;
+        }
+        if (w <= 0 || h <= 0) {
+            return;
+        }
+        if (level > kMaxLodLevel) {
+            level = kMaxLodLevel;
+        }
+        
+        const int stride = 1 << level;
+        const int sx0 = floorDiv(x0, stride);
+        const int sy0 = floorDiv(y0, stride);
+        
+        // Samples of this level inside the world
+        const int levelWidth = (width + stride - 1) / stride;
+        const int levelHeight = (height + stride - 1) / stride;
+        
+        std::fill(out, out + static_cast<size_t>(w) * h, -1.0f);
+        
+        int iBegin = std::min(w, std::max(0, -sx0));
+        int iEnd = std::max(iBegin, std::min(w, levelWidth - sx0));
+        int jBegin = std::min(h, std::max(0, -sy0));
+        int jEnd = std::max(jBegin, std::min(h, levelHeight - sy0));
+        
+        for (int i = iBegin; i < iEnd; ) {
+            int tileX = (sx0 + i) / chunkSize;
+            int iTileEnd = std::min(iEnd, (tileX + 1) * chunkSize - sx0);
+            
+            for (int j = jBegin; j < jEnd; ) {
+                int tileY = (sy0 + j) / chunkSize;
+                int jTileEnd = std::min(jEnd, (tileY + 1) * chunkSize - sy0);
+                
+                ChunkPtr tile = getLodTile(level, tileX, tileY);
+                
+                for (int ii = i; ii < iTileEnd; ii++) {
+                    int localX = sx0 + ii - tileX * chunkSize;
+                    float* outColumn = out + static_cast<size_t>(ii) * h;
+                    
+                    for (int jj = j; jj < jTileEnd; jj++) {
+                        outColumn[jj] = tile->at(localX, sy0 + jj - tileY * chunkSize);
+                    }
+                }
+                
+                j = jTileEnd;
+            }
+            
+            i = iTileEnd;
+        }
+    }
+    
+    // Copy the obstacle mask of a w x h region starting at (x0, y0). Each of
+    // the w columns (fixed x) takes (h + 63) / 64 words of out, with bit j of
+    // a column set if (x0 + i, y0 + j) is an obstacle or out of bounds. The
+    // bits are copied from the chunk masks a word at a time.
+    void getObstacleMask(int x0, int y0, int w, int h, uint64_t* out) {
+        if (w <= 0 || h <= 0) {
+            return;
+        }
+        
+        size_t stride = (static_cast<size_t>(h) + 63) / 64;
+        std::fill(out, out + stride * w, 0);
+        
+        int jBegin = std::min(h, std::max(0, -y0));
+        int jEnd = std::max(jBegin, std::min(h, height - y0));
+        
+        for (int i = 0; i < w; i++) {
+            uint64_t* outColumn = out + stride * i;
+            int x = x0 + i;
+            if (x < 0 || x >= width) {
+                setBits(outColumn, 0, h);
+                continue;
+            }
+            setBits(outColumn, 0, jBegin);
+            setBits(outColumn, jEnd, h - jEnd);
+            
+            int chunkX = x / chunkSize;
+            int localX = x % chunkSize;
+            ChunkPtr chunk;
+            for (int j = jBegin; j < jEnd; ) {
+                int y = y0 + j;
+                int chunkY = y / chunkSize;
+                int count = std::min(jEnd - j, (chunkY + 1) * chunkSize - y);
+                
+                chunk = getChunk(chunkX, chunkY);
+                orBits(chunk->obstacleMask(), static_cast<size_t>(localX) * chunkSize + (y % chunkSize),
+                       outColumn, j, count);
+                j += count;
+            }
+        }
+    }
+    
+    // Unload distant chunks to save memory
+    void unloadDistantChunks(int centerX, int centerY, int maxViewRadius) {
+        int centerChunkX = centerX / chunkSize;
+        int centerChunkY = centerY / chunkSize;
+        
+        cache.eraseIf([=](const ChunkCache::Key& key) {
+            // Calculate Manhattan distance to center chunk
+            int dx = std::abs(key.first - centerChunkX);
+            int dy = std::abs(key.second - centerChunkY);
+            int distance = dx + dy;
+            
+            // If chunk is too far, remove it
+            return distance > maxViewRadius;
+        });
+    }
+    
+    // Get visible chunks from center point
+    std::vector<std::pair<int, int>> getVisibleChunks(int centerX, int centerY, int viewRadius) {
+        int centerChunkX = centerX / chunkSize;
+        int centerChunkY = centerY / chunkSize;
+        
+        std::vector<std::pair<int, int>> visibleChunks;
+        
+        for (int dx = -viewRadius; dx <= viewRadius; dx++) {
+            for (int dy = -viewRadius; dy <= viewRadius; dy++) {
+                int chunkX = centerChunkX + dx;
+                int chunkY = centerChunkY + dy;
+                
+                // Ensure chunk is within world bounds
+                if (chunkX >= 0 && chunkX < width / chunkSize &&
+                    chunkY >= 0 && chunkY < height / chunkSize) {
+                    visibleChunks.push_back({chunkX, chunkY});
+                }
+            }
+        }
+        
+        return visibleChunks;
+    }
+    
+    // Clear all generated chunks from memory
+    void clearChunks() {
+        prefetcher.cancel(true);
+        cache.clear();
+        lodCache.clear();
+        clearAnnotations();
+        bufferPool->trim();
+        recordReset();
+    }
+    
+    // Build chunks from an external heightfield instead of the noise (see
+    // HeightfieldSource). Every cached chunk, mip level and landmark table
+    // is dropped, and stored tiles are kept apart from the noise ones.
+    // Returns a HeightfieldStatus; on failure the current source stays. Not
+    // safe to call while chunks are generated.
+    int loadHeightfield(const std::string& path, int offsetX, int offsetY, double valueScale,
+                        double valueOffset) {
+        int status = HEIGHTFIELD_OK;
+        auto source = HeightfieldSource::open(path, offsetX, offsetY, valueScale, valueOffset, status);
+        if (!source) {
+            return status;
+        }
+        replaceHeightfield(source);
+        return HEIGHTFIELD_OK;
+    }
+    
+    // Go back to generating chunks from the noise
+    void clearHeightfield() {
+        if (heightfield) {
+            replaceHeightfield(nullptr);
+        }
+    }
+    
+    bool hasHeightfield() const { return heightfield != nullptr; }
+    
+    // Stream the w x h rectangle at (x0, y0) to a heightfield file without
+    // filling the cache. Cells come from cached chunks where there are any,
+    // so edits are included, and otherwise from stored tiles or freshly
+    // built chunks that are dropped once written; cells outside the world
+    // are written as -1, like obstacles. Rows of chunk-sized tiles are
+    // assembled on the worker pool while a writer thread writes the
+    // previous row, so only a few rows of tiles and chunks are held at
+    // once. The file is written under a temporary name and renamed into
+    // place. Returns a HeightfieldStatus.
+    int exportRegion(const std::string& path, int x0, int y0, int w, int h, HeightfieldFormat format) {
+        if (path.empty() || w <= 0 || h <= 0 ||
+            (format != HEIGHTFIELD_FORMAT_TILED && format != HEIGHTFIELD_FORMAT_GEOTIFF)) {
+            return HEIGHTFIELD_INVALID_ARGUMENT;
+        }
+        const bool tiled = format == HEIGHTFIELD_FORMAT_TILED;
+        const int tileSize = chunkSize;
+        const int tilesX = (w + tileSize - 1) / tileSize;
+        const int tilesY = (h + tileSize - 1) / tileSize;
+        
+        // Everything before the cells
+        std::vector<uint8_t> prefix;
+        if (tiled) {
+            HeightfieldHeader header = {kHeightfieldMagic, kHeightfieldVersion, w, h, tileSize,
+                                        x0, y0, seed, paramsHash(), 0};
+            prefix.resize(sizeof(header));
+            std::memcpy(prefix.data(), &header, sizeof(header));
+        } else if (!geoTiffPrefix(x0, y0, w, h, tileSize, prefix)) {
+            return HEIGHTFIELD_TOO_LARGE;
+        }
+        
+        // Unique per export, so concurrent exports to one path never share
+        // a temporary file
+        static std::atomic<uint64_t> exportCounter(0);
+        char suffix[64];
+        std::snprintf(suffix, sizeof(suffix), ".tmp%ld_%llu", static_cast<long>(getpid()),
+                      static_cast<unsigned long long>(exportCounter++));
+        const std::string tempPath = path + suffix;
+        FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) {
+            return HEIGHTFIELD_IO_ERROR;
+        }
+        bool failed = std::fwrite(prefix.data(), 1, prefix.size(), file) != prefix.size();
+        
+        // Rows of tiles handed to the writer: whole tiles for the tiled
+        // format, image rows for GeoTIFF strips
+        const size_t rowCells = static_cast<size_t>(tileSize) * (tiled ? tilesX * tileSize : w);
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::pair<size_t, std::vector<float>>> ready;
+        std::vector<std::vector<float>> spare;
+        bool finished = false;
+        
+        // Chunk columns the rectangle touches, and the chunks of the last
+        // two chunk rows read; a row of tiles spans at most two
+        const int chunkX0 = floorDiv(x0, chunkSize);
+        const int chunkColumns = floorDiv(x0 + w - 1, chunkSize) - chunkX0 + 1;
+        std::map<int, std::vector<ChunkPtr>> chunkRows;
+        
+        std::thread writer([&]() {
+            for (;;) {
+                std::pair<size_t, std::vector<float>> row;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&] { return finished || !ready.empty(); });
+                    if (ready.empty()) {
+                        return;
+                    }
+                    row = std::move(ready.front());
+                    ready.pop_front();
+                }
+                bool written = std::fwrite(row.second.data(), sizeof(float), row.first, file) == row.first;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    failed = failed || !written;
+                    spare.push_back(std::move(row.second));
+                }
+                changed.notify_all();
+            }
+        });
+        
+        for (int ty = 0; ty < tilesY; ty++) {
+            std::vector<float> cells;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return ready.empty(); });
+                if (failed) {
+                    break;
+                }
+                if (!spare.empty()) {
+                    cells = std::move(spare.back());
+                    spare.pop_back();
+                }
+            }
+            cells.resize(rowCells);
+            
+            const int absY = y0 + ty * tileSize;
+            const int rows = std::min(tileSize, h - ty * tileSize);
+            const int firstChunkY = floorDiv(absY, chunkSize);
+            const int lastChunkY = floorDiv(absY + tileSize - 1, chunkSize);
+            chunkRows.erase(chunkRows.begin(), chunkRows.lower_bound(firstChunkY));
+            for (int chunkY = firstChunkY; chunkY <= lastChunkY; chunkY++) {
+                if (chunkRows.count(chunkY)) {
+                    continue;
+                }
+                std::vector<ChunkPtr>& row = chunkRows[chunkY];
+                row.resize(chunkColumns);
+                getPool().parallelFor(chunkColumns, [&](int c) { row[c] = exportChunk(chunkX0 + c, chunkY); });
+            }
+            
+            getPool().parallelFor(tilesX, [&](int tx) {
+                const int absX = x0 + tx * tileSize;
+                const int columns = std::min(tileSize, w - tx * tileSize);
+                
+                for (int i = 0; i < tileSize; i++) {
+                    const int worldX = absX + i;
+                    const bool columnInside = i < columns && worldX >= 0 && worldX < width;
+                    for (int j = 0; j < tileSize; j++) {
+                        const int worldY = absY + j;
+                        float value = -1.0f;
+                        if (columnInside && j < rows && worldY >= 0 && worldY < height) {
+                            const ChunkData& chunk = *chunkRows.at(floorDiv(worldY, chunkSize))
+                                [floorDiv(worldX, chunkSize) - chunkX0];
+                            value = chunk.at(worldX % chunkSize, worldY % chunkSize);
+                        }
+                        if (tiled) {
+                            cells[(static_cast<size_t>(tx) * tileSize + i) * tileSize + j] = value;
+                        } else if (i < columns && j < rows) {
+                            cells[static_cast<size_t>(j) * w + tx * tileSize + i] = value;
+                        }
+                    }
+                }
+            });
+            
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready.push_back({tiled ? rowCells : static_cast<size_t>(rows) * w, std::move(cells)});
+            }
+            changed.notify_all();
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        changed.notify_all();
+        writer.join();
+        
+        failed = std::fclose(file) != 0 || failed;
+        if (failed || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            return HEIGHTFIELD_IO_ERROR;
+        }
+        return HEIGHTFIELD_OK;
+    }
+    
+    // Limit the memory used by cached chunks (0 = unlimited)
+    void setCacheBudget(uint64_t bytes) {
+        cache.setByteBudget(bytes);
+    }
+    
+    void setCachePolicy(CachePolicy policy) {
+        cache.setPolicy(policy);
+    }
+    
+    // Replace the set of chunks the cache budget never evicts, given as
+    // interleaved (chunkX, chunkY) pairs
+    void pinChunks(const int* coords, int n) {
+        std::vector<ChunkCache::Key> keys;
+        keys.reserve(n);
+        for (int i = 0; i < n; i++) {
+            keys.push_back({coords[2 * i], coords[2 * i + 1]});
+        }
+        cache.setPinned(keys);
+    }
+    
+    CacheStats getCacheStats() const {
+        return cache.stats();
+    }
+    
+    // Snapshot the generation, cache and planner counters
+    TerrainStats getStats() const {
+        TerrainStats stats;
+        metrics.snapshot(stats);
+        CacheStats cacheStats = cache.stats();
+        stats.cacheHits = cacheStats.hits;
+        stats.cacheMisses = cacheStats.misses;
+        stats.evictions = cacheStats.evictions;
+        stats.bytesResident = cacheStats.bytesResident;
+        stats.chunksResident = cacheStats.chunksResident;
+        bool hugePages = false;
+        bufferPool->usage(stats.poolBytes, stats.poolBuffersFree, hugePages);
+        stats.poolHugePages = hugePages ? 1 : 0;
+        return stats;
+    }
+    
+    // Record a finished path search; called by the path finders
+    void recordPathSearch(uint64_t expansions, uint64_t ns) const {
+        metrics.recordPathSearch(expansions, ns);
+    }
+    
+    // Record that cells in a rectangle changed outside setElevation, for
+    // example when new sensor data arrived
+    void notifyCellsChanged(int x0, int y0, int w, int h) {
+        std::lock_guard<std::mutex> lock(changeMutex);
+        recordChangeLocked(x0, y0, w, h);
+    }
+    
+    // Whether cells were edited or reported changed since chunks were last
+    // dropped or the terrain was reconfigured
+    bool hasCellChanges() {
+        std::lock_guard<std::mutex> lock(changeMutex);
+        return cellsChanged;
+    }
+    
+    // Sequence number of the newest change
+    uint64_t getChangeSequence() {
+        std::lock_guard<std::mutex> lock(changeMutex);
+        return changeSequence;
+    }
+    
+    // Sequence number of the newest change that may have lowered a step
+    // cost. Placing obstacles cannot; other edits, reported changes,
+    // regenerated chunks and resets may.
+    uint64_t getLoweringSequence() {
+        std::lock_guard<std::mutex> lock(changeMutex);
+        recordEvictedEditsLocked();
+        return loweringSequence;
+    }
+    
+    // Sequence number of the last reset, when every cell was as generated
+    uint64_t getRegeneratedSequence() {
+        std::lock_guard<std::mutex> lock(changeMutex);
+        return regeneratedSequence;
+    }
+    
+    // Append the changes recorded after sequence since to out and set latest
+    // to the newest sequence number. Returns false if the terrain was reset
+    // since then or the history no longer reaches back that far; every cell
+    // must then be assumed changed.
+    bool getChangesSince(uint64_t since, std::vector<TerrainChange>& out, uint64_t& latest) {
+        std::lock_guard<std::mutex> lock(changeMutex);
+        recordEvictedEditsLocked();
+        latest = changeSequence;
+        if (since < resetSequence) {
+            return false;
+        }
+        if (!changes.empty() && changes.front().sequence > since + 1) {
+            return false;
+        }
+        for (const TerrainChange& change : changes) {
+            if (change.sequence > since) {
+                out.push_back(change);
+            }
+        }
+        return true;
+    }
+};
+
+// Cost of a single step between two free cells: 1 (1.4 diagonally) plus the
+// weighted elevation difference, ten times heavier when steeper than
+// steepThreshold
+static inline double traversalCost(bool diagonal, float fromElevation, float toElevation,
+                                   double steepThreshold, double elevationWeight) {
+    double cost = diagonal ? 1.4 : 1.0;
+    double elevationDiff = std::abs(fromElevation - toElevation);
+    if (elevationDiff > steepThreshold) {
+        cost += elevationDiff * 10 * elevationWeight;
+    } else {
+        cost += elevationDiff * elevationWeight;
+    }
+    return cost;
+}
+
+// Records one search in the terrain's counters when it goes out of scope,
+// reading the finder's expansion count at that point
+class PathSearchRecorder {
+private:
+    const TerrainGenerator& terrain;
+    const int& expansions;
+    StatsTimer timer;
+
+public:
+    PathSearchRecorder(const TerrainGenerator& terrain, const int& expansions)
+        : terrain(terrain), expansions(expansions) {}
+    
+    ~PathSearchRecorder() {
+        terrain.recordPathSearch(static_cast<uint64_t>(expansions), timer.elapsedNs());
+    }
+};
+
+// Dense per-cell search state, reused across searches so that repeated
+// queries allocate nothing once warm. Cells are grouped into 64x64 pages
+// handed out on first touch, and a generation counter invalidates every
+// page and cell at once, so starting a search is O(1). Open cells sit in an
+// indexed binary heap with decrease-key, so each cell is queued at most once.
+class SearchArena {
+public:
+    typedef uint32_t Node;
+    static const Node kNoNode = 0xFFFFFFFFu;
+
+private:
+    static const int kPageShift = 6;
+    static const int kPageSide = 1 << kPageShift;
+    static const int kPageCells = kPageSide * kPageSide;
+    static const int32_t kNotQueued = -1;
+    static const int32_t kClosed = -2;
+    
+    int pagesY;
+    uint32_t generation;
+    
+    // Page table over the world; an entry is valid while its generation
+    // matches the current one
+    std::vector<uint32_t> pageSlot;
+    std::vector<uint32_t> pageGeneration;
+    std::vector<uint32_t> slotPage;
+    uint32_t slotsUsed;
+    
+    // Per-cell state, kPageCells entries per slot
+    std::vector<uint32_t> cellGeneration;
+    std::vector<double> gScore;
+    std::vector<double> priority;
+    std::vector<Node> parents;
+    std::vector<int32_t> heapIndex;
+    
+    std::vector<Node> heap;
+    
+    void place(size_t position, Node node) {
+        heap[position] = node;
+        heapIndex[node] = static_cast<int32_t>(position);
+    }
+    
+    void siftUp(size_t position) {
+        Node node = heap[position];
+        while (position > 0) {
+            size_t up = (position - 1) / 2;
+            if (priority[heap[up]] <= priority[node]) {
+                break;
+            }
+            place(position, heap[up]);
+            position = up;
+        }
+        place(position, node);
+    }
+    
+    void siftDown(size_t position) {
+        Node node = heap[position];
+        size_t count = heap.size();
+        while (true) {
+            size_t child = 2 * position + 1;
+            if (child >= count) {
+                break;
+            }
+            if (child + 1 < count && priority[heap[child + 1]] < priority[heap[child]]) {
+                child++;
+            }
+            if (priority[node] <= priority[heap[child]]) {
+                break;
+            }
+            place(position, heap[child]);
+            position = child;
+        }
+        place(position, node);
+    }
+
+public:
+    SearchArena() : pagesY(0), generation(0), slotsUsed(0) {}
+    
+    // Arena of the calling thread
+    static SearchArena& forThisThread() {
+        static thread_local SearchArena arena;
+        return arena;
+    }
+    
+    // Forget all state and prepare for a search over a width x height world
+    void reset(int width, int height) {
+        int pagesX = (width + kPageSide - 1) / kPageSide;
+        int newPagesY = (height + kPageSide - 1) / kPageSide;
+        size_t pages = static_cast<size_t>(pagesX) * newPagesY;
+        if (pages != pageSlot.size() || newPagesY != pagesY) {
+            pagesY = newPagesY;
+            pageSlot.assign(pages, 0);
+            pageGeneration.assign(pages, 0);
+        }
+        
+        // Stamps only repeat after 2^32 searches; clear them when they do
+        if (++generation == 0) {
+            std::fill(pageGeneration.begin(), pageGeneration.end(), 0);
+            std::fill(cellGeneration.begin(), cellGeneration.end(), 0);
+            generation = 1;
+        }
+        slotsUsed = 0;
+        heap.clear();
+    }
+    
+    // Node for an in-bounds cell, fresh (g infinite, not queued) on first
+    // touch in this search
+    Node node(int x, int y) {
+        size_t page = static_cast<size_t>(x >> kPageShift) * pagesY + (y >> kPageShift);
+        if (pageGeneration[page] != generation) {
+            pageGeneration[page] = generation;
+            pageSlot[page] = slotsUsed++;
+            if (slotPage.size() < slotsUsed) {
+                slotPage.resize(slotsUsed);
+                size_t cells = static_cast<size_t>(slotsUsed) * kPageCells;
+                cellGeneration.resize(cells, 0);
+                gScore.resize(cells);
+                priority.resize(cells);
+                parents.resize(cells);
+                heapIndex.resize(cells);
+            }
+            slotPage[pageSlot[page]] = static_cast<uint32_t>(page);
+        }
+        
+        Node node = pageSlot[page] * kPageCells + (x & (kPageSide - 1)) * kPageSide + (y & (kPageSide - 1));
+        if (cellGeneration[node] != generation) {
+            cellGeneration[node] = generation;
+            gScore[node] = std::numeric_limits<double>::infinity();
+            parents[node] = kNoNode;
+            heapIndex[node] = kNotQueued;
+        }
+        return node;
+    }
+    
+    int x(Node node) const {
+        uint32_t page = slotPage[node / kPageCells];
+        return static_cast<int>(page / pagesY) * kPageSide + static_cast<int>(node % kPageCells) / kPageSide;
+    }
+    
+    int y(Node node) const {
+        uint32_t page = slotPage[node / kPageCells];
+        return static_cast<int>(page % pagesY) * kPageSide + static_cast<int>(node % kPageCells) % kPageSide;
+    }
+    
+    double& g(Node node) { return gScore[node]; }
+    Node& parent(Node node) { return parents[node]; }
+    bool closed(Node node) const { return heapIndex[node] == kClosed; }
+    
+    // Queue a node, or lower the priority of a queued one
+    void push(Node node, double nodePriority) {
+        priority[node] = nodePriority;
+        if (heapIndex[node] < 0) {
+            heap.push_back(node);
+            siftUp(heap.size() - 1);
+        } else {
+            siftUp(heapIndex[node]);
+        }
+    }
+    
+    bool empty() const { return heap.empty(); }
+    
+    // Lowest queued priority; the queue must not be empty
+    double topPriority() const { return priority[heap[0]]; }
+    
+    // Nodes currently queued, in heap order
+    const std::vector<Node>& queuedNodes() const { return heap; }
+    
+    // Empty the queue, leaving its nodes neither queued nor closed
+    void clearQueue() {
+        for (Node node : heap) {
+            heapIndex[node] = kNotQueued;
+        }
+        heap.clear();
+    }
+    
+    // Remove the node with the lowest priority and mark it closed
+    Node pop() {
+        Node top = heap[0];
+        Node last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            place(0, last);
+            siftDown(0);
+        }
+        heapIndex[top] = kClosed;
+        return top;
+    }
+};
+
+const SearchArena::Node SearchArena::kNoNode;
+
+// Step directions in the order edge cost fields store them
+static const int kStepDirections[8][2] = {
+    {0, 1}, {1, 0}, {0, -1}, {-1, 0},
+    {1, 1}, {1, -1}, {-1, -1}, {-1, 1}
+};
+
+// Distances from every cell of a chunk to the nearest blocked cell, capped
+// at the terrain's clearance range
+struct ChunkClearance {
+    int range;
+    std::vector<float> distance;  // x * chunkSize + y, in cells
+};
+
+// Builds and caches ChunkClearance fields. A cell is blocked if it is an
+// obstacle, outside the world, or steep: a step between it and a free
+// neighbour climbs more than traversalCost's steep threshold. Distances
+// are exact Euclidean ones up to the range: a scan finds the nearest
+// blocked cell within each column, and the lower envelope of parabolas of
+// Felzenszwalb and Huttenlocher combines columns along each row. Both run
+// over the chunk and a halo of range cells (one more to tell which halo
+// cells are steep), so obstacles in neighbouring chunks count too.
+class ClearanceField {
+private:
+    // Squared distance transform of one row of n squared column distances:
+    // out[q - first] = min over i of f[i] + (q - i)^2 for q in [first,
+    // first + count). hull and bounds are scratch space for n and n + 1
+    // values.
+    static void transformLine(const float* f, int n, int first, int count, float* out, int* hull,
+                              double* bounds) {
+        auto intersection = [f](int q, int v) {
+            return ((f[q] + static_cast<double>(q) * q) - (f[v] + static_cast<double>(v) * v)) / (2.0 * (q - v));
+        };
+        int k = 0;
+        hull[0] = 0;
+        bounds[0] = -std::numeric_limits<double>::infinity();
+        bounds[1] = std::numeric_limits<double>::infinity();
+        for (int q = 1; q < n; q++) {
+            double s = intersection(q, hull[k]);
+            while (s <= bounds[k]) {
+                k--;
+                s = intersection(q, hull[k]);
+            }
+            k++;
+            hull[k] = q;
+            bounds[k] = s;
+            bounds[k + 1] = std::numeric_limits<double>::infinity();
+        }
+        
+        k = 0;
+        for (int q = first; q < first + count; q++) {
+            while (bounds[k + 1] < q) {
+                k++;
+            }
+            float offset = static_cast<float>(q - hull[k]);
+            out[q - first] = offset * offset + f[hull[k]];
+        }
+    }
+    
+    static std::shared_ptr<const ChunkClearance> build(TerrainGenerator& terrain, int chunkX, int chunkY) {
+        static const int forward[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+        const int chunkSize = terrain.getChunkSize();
+        const int range = terrain.getClearanceRange();
+        const float steepThreshold = static_cast<float>(terrain.getMaxElevation() / 10.0);
+        
+        // Elevations of the chunk and its halo; outside the world reads -1
+        const int halo = range + 1;
+        const int side = chunkSize + 2 * halo;
+        std::vector<float> elevations(static_cast<size_t>(side) * side);
+        terrain.getRegion(chunkX * chunkSize - halo, chunkY * chunkSize - halo, side, side, 1, elevations.data());
+        
+        // Blocked cells, checking each pair of neighbours once
+        std::vector<uint8_t> blocked(elevations.size());
+        for (int i = 0; i < side; i++) {
+            for (int j = 0; j < side; j++) {
+                size_t cell = static_cast<size_t>(i) * side + j;
+                if (elevations[cell] < 0) {
+                    blocked[cell] = 1;
+                    continue;
+                }
+                for (const auto& dir : forward) {
+                    int ni = i + dir[0];
+                    int nj = j + dir[1];
+                    if (ni >= side || nj < 0 || nj >= side) {
+                        continue;
+                    }
+                    size_t neighbor = static_cast<size_t>(ni) * side + nj;
+                    if (elevations[neighbor] >= 0 && std::abs(elevations[cell] - elevations[neighbor]) > steepThreshold) {
+                        blocked[cell] = 1;
+                        blocked[neighbor] = 1;
+                    }
+                }
+            }
+        }
+        
+        // Squared distance to the nearest blocked cell of the same column,
+        // for the rows of the chunk. Anything beyond range + 1 is as good as
+        // unreachable. Stored row by row for the second pass.
+        const int inner = chunkSize + 2 * range;
+        const int far = range + 1;
+        std::vector<float> rows(static_cast<size_t>(chunkSize) * inner);
+        std::vector<int> run(inner);
+        for (int i = 0; i < inner; i++) {
+            const uint8_t* column = &blocked[static_cast<size_t>(i + 1) * side + 1];
+            int distance = far;
+            for (int j = 0; j < inner; j++) {
+                distance = column[j] ? 0 : std::min(distance + 1, far);
+                run[j] = distance;
+            }
+            distance = far;
+            for (int j = inner - 1; j >= range; j--) {
+                distance = column[j] ? 0 : std::min(distance + 1, far);
+                if (j < range + chunkSize) {
+                    float nearest = static_cast<float>(std::min(distance, run[j]));
+                    rows[static_cast<size_t>(j - range) * inner + i] = nearest * nearest;
+                }
+            }
+        }
+        
+        // Combine the columns along each row of the chunk
+        auto field = std::make_shared<ChunkClearance>();
+        field->range = range;
+        field->distance.resize(static_cast<size_t>(chunkSize) * chunkSize);
+        std::vector<float> squared(chunkSize);
+        std::vector<int> hull(inner);
+        std::vector<double> bounds(inner + 1);
+        for (int y = 0; y < chunkSize; y++) {
+            transformLine(&rows[static_cast<size_t>(y) * inner], inner, range, chunkSize, squared.data(),
+                          hull.data(), bounds.data());
+            for (int x = 0; x < chunkSize; x++) {
+                field->distance[static_cast<size_t>(x) * chunkSize + y] =
+                    std::min(std::sqrt(squared[x]), static_cast<float>(range));
+            }
+        }
+        return field;
+    }
+
+public:
+    // The field of a cached chunk, built and kept with it on first use
+    static std::shared_ptr<const ChunkClearance> forChunk(TerrainGenerator& terrain, ChunkData& chunk,
+                                                         int chunkX, int chunkY) {
+        auto field = chunk.getAnnotation<ChunkClearance>(CHUNK_ANNOTATION_CLEARANCE);
+        if (!field || field->range != terrain.getClearanceRange()) {
+            field = build(terrain, chunkX, chunkY);
+            chunk.setAnnotation<ChunkClearance>(CHUNK_ANNOTATION_CLEARANCE, field);
+        }
+        return field;
+    }
+    
+    // Build the fields of n chunks, given as interleaved (chunkX, chunkY)
+    // pairs, on the worker pool: first every chunk their halos reach, then
+    // the fields. Chunks outside the world are skipped.
+    static void prepare(TerrainGenerator& terrain, const int* coords, int n) {
+        const int chunkSize = terrain.getChunkSize();
+        const int chunksX = (terrain.getWidth() + chunkSize - 1) / chunkSize;
+        const int chunksY = (terrain.getHeight() + chunkSize - 1) / chunkSize;
+        
+        std::vector<std::pair<int, int>> targets;
+        std::vector<int> reached;
+        for (int i = 0; i < n; i++) {
+            int chunkX = coords[2 * i];
+            int chunkY = coords[2 * i + 1];
+            if (chunkX < 0 || chunkY < 0 || chunkX >= chunksX || chunkY >= chunksY) {
+                continue;
+            }
+            targets.push_back({chunkX, chunkY});
+            for (int dx = -1; dx <= 1; dx++) {
+                for (int dy = -1; dy <= 1; dy++) {
+                    if (chunkX + dx >= 0 && chunkY + dy >= 0 && chunkX + dx < chunksX && chunkY + dy < chunksY) {
+                        reached.push_back(chunkX + dx);
+                        reached.push_back(chunkY + dy);
+                    }
+                }
+            }
+        }
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+        
+        terrain.generateChunks(reached.data(), static_cast<int>(reached.size() / 2));
+        terrain.parallelFor(static_cast<int>(targets.size()), [&terrain, &targets](int i) {
+            ChunkPtr chunk = terrain.getChunk(targets[i].first, targets[i].second);
+            forChunk(terrain, *chunk, targets[i].first, targets[i].second);
+        });
+    }
+    
+    // Clearance of n arbitrary world cells, 0 outside the world.
+    // Consecutive cells in the same chunk share one field lookup.
+    static void sample(TerrainGenerator& terrain, const int* xs, const int* ys, int n, float* out) {
+        const int chunkSize = terrain.getChunkSize();
+        int lastChunkX = 0;
+        int lastChunkY = 0;
+        std::shared_ptr<const ChunkClearance> field;
+        for (int i = 0; i < n; i++) {
+            int x = xs[i];
+            int y = ys[i];
+            if (x < 0 || x >= terrain.getWidth() || y < 0 || y >= terrain.getHeight()) {
+                out[i] = 0.0f;
+                continue;
+            }
+            if (!field || x / chunkSize != lastChunkX || y / chunkSize != lastChunkY) {
+                lastChunkX = x / chunkSize;
+                lastChunkY = y / chunkSize;
+                ChunkPtr chunk = terrain.getChunk(lastChunkX, lastChunkY);
+                field = forChunk(terrain, *chunk, lastChunkX, lastChunkY);
+            }
+            out[i] = field->distance[static_cast<size_t>(x % chunkSize) * chunkSize + y % chunkSize];
+        }
+    }
+};
+
+// Costs of the 8 steps out of every cell of a chunk for one elevation
+// weight, including steps into neighbouring chunks; infinite where the step
+// leaves the world or ends on an obstacle
+struct ChunkEdgeCosts {
+    double elevationWeight;
+    std::vector<float> costs;  // (x * chunkSize + y) * 8 + direction
+};
+
+// Step costs for one elevation weight. When the terrain keeps edge cost
+// fields for that weight each cost is one load from the chunk's field;
+// otherwise it is computed from the two elevations. Under the terrain's
+// clearance rule, steps are then checked and charged against the
+// clearance fields of the chunks.
+class EdgeCostReader {
+private:
+    TerrainGenerator& terrain;
+    const double elevationWeight;
+    const double steepThreshold;
+    const int chunkSize;
+    bool useFields;
+    ClearanceRule clearance;
+    
+    int lastChunkX;
+    int lastChunkY;
+    ChunkPtr lastChunk;
+    std::shared_ptr<const ChunkEdgeCosts> lastField;
+    std::shared_ptr<const ChunkClearance> lastClearance;
+    
+    void bindChunk(int chunkX, int chunkY) {
+        if (lastChunk && chunkX == lastChunkX && chunkY == lastChunkY) {
+            return;
+        }
+        lastChunk = terrain.getChunk(chunkX, chunkY);
+        lastChunkX = chunkX;
+        lastChunkY = chunkY;
+        
+        if (useFields) {
+            lastField = lastChunk->getAnnotation<ChunkEdgeCosts>(CHUNK_ANNOTATION_EDGE_COSTS);
+            if (!lastField || lastField->elevationWeight != elevationWeight) {
+                lastField = buildField(*lastChunk, chunkX, chunkY);
+                lastChunk->setAnnotation<ChunkEdgeCosts>(CHUNK_ANNOTATION_EDGE_COSTS, lastField);
+            }
+        }
+        if (clearance.active()) {
+            lastClearance = ClearanceField::forChunk(terrain, *lastChunk, chunkX, chunkY);
+        }
+    }
+    
+    std::shared_ptr<const ChunkEdgeCosts> buildField(const ChunkData& chunk, int chunkX, int chunkY) {
+        auto field = std::make_shared<ChunkEdgeCosts>();
+        field->elevationWeight = elevationWeight;
+        field->costs.assign(static_cast<size_t>(chunkSize) * chunkSize * 8,
+                            std::numeric_limits<float>::infinity());
+        
+        for (int ix = 0; ix < chunkSize; ix++) {
+            for (int iy = 0; iy < chunkSize; iy++) {
+                size_t i = static_cast<size_t>(ix) * chunkSize + iy;
+                if (chunk.isObstacle(i)) {
+                    continue;
+                }
+                float elevation = chunk.at(ix, iy);
+                bool border = ix == 0 || iy == 0 || ix == chunkSize - 1 || iy == chunkSize - 1;
+                
+                for (int d = 0; d < 8; d++) {
+                    int nx = ix + kStepDirections[d][0];
+                    int ny = iy + kStepDirections[d][1];
+                    
+                    // The halo of steps leaving the chunk reads its neighbours
+                    float neighborElevation = border
+                        ? terrain.getElevation(chunkX * chunkSize + nx, chunkY * chunkSize + ny)
+                        : chunk.at(nx, ny);
+                    if (neighborElevation < 0) {
+                        continue;
+                    }
+                    field->costs[i * 8 + d] = static_cast<float>(
+                        traversalCost(d >= 4, elevation, neighborElevation, steepThreshold, elevationWeight));
+                }
+            }
+        }
+        return field;
+    }
+
+public:
+    EdgeCostReader(TerrainGenerator& terrain, double elevationWeight)
+        : terrain(terrain), elevationWeight(elevationWeight),
+          steepThreshold(terrain.getMaxElevation() / 10.0), chunkSize(terrain.getChunkSize()),
+          useFields(terrain.getEdgeCostWeight() > 0 && terrain.getEdgeCostWeight() == elevationWeight),
+          clearance(terrain.getPathClearance()), lastChunkX(0), lastChunkY(0) {}
+    
+    // Drop the chunks held from earlier searches and pick up a changed
+    // terrain edge cost weight or clearance rule
+    void reset() {
+        lastChunk.reset();
+        lastField.reset();
+        lastClearance.reset();
+        useFields = terrain.getEdgeCostWeight() > 0 && terrain.getEdgeCostWeight() == elevationWeight;
+        clearance = terrain.getPathClearance();
+    }
+    
+    // Cells around a changed cell whose step costs may change with it
+    int reach() const {
+        return clearance.active() ? terrain.getClearanceRange() + 2 : 1;
+    }
+    
+    // Clearance of in-bounds cell (x, y) from obstacles and steep cells,
+    // while a clearance rule is active
+    float clearanceAt(int x, int y) {
+        bindChunk(x / chunkSize, y / chunkSize);
+        return lastClearance->distance[static_cast<size_t>(x % chunkSize) * chunkSize + y % chunkSize];
+    }
+    
+    // A free cell a path may pass through under the clearance rule
+    bool fits(int x, int y) {
+        return elevationAt(x, y) >= 0 && (!clearance.active() || clearanceAt(x, y) >= clearance.required);
+    }
+    
+    // Elevation of a cell, -1 for obstacles and outside the world
+    float elevationAt(int x, int y) {
+        if (x < 0 || x >= terrain.getWidth() || y < 0 || y >= terrain.getHeight()) {
+            return -1.0f;
+        }
+        bindChunk(x / chunkSize, y / chunkSize);
+        return lastChunk->at(x % chunkSize, y % chunkSize);
+    }
+    
+    // Costs of the 8 steps out of in-bounds cell (x, y), in kStepDirections
+    // order; infinite where a step leaves the world, starts or ends on an
+    // obstacle, or lacks the required clearance. Steps cost the same in
+    // both directions.
+    void stepCosts(int x, int y, double costs[8]) {
+        bindChunk(x / chunkSize, y / chunkSize);
+        const int localX = x % chunkSize;
+        const int localY = y % chunkSize;
+        const size_t i = static_cast<size_t>(localX) * chunkSize + localY;
+        const bool interior = localX > 0 && localY > 0 && localX < chunkSize - 1 && localY < chunkSize - 1;
+        if (lastField) {
+            const float* field = &lastField->costs[i * 8];
+            for (int d = 0; d < 8; d++) {
+                costs[d] = field[d];
+            }
+        } else {
+            const float elevation = lastChunk->at(localX, localY);
+            for (int d = 0; d < 8; d++) {
+                float neighborElevation = interior
+                    ? lastChunk->at(localX + kStepDirections[d][0], localY + kStepDirections[d][1])
+                    : elevationAt(x + kStepDirections[d][0], y + kStepDirections[d][1]);
+                costs[d] = elevation < 0 || neighborElevation < 0
+                    ? std::numeric_limits<double>::infinity()
+                    : traversalCost(d >= 4, elevation, neighborElevation, steepThreshold, elevationWeight);
+            }
+        }
+        if (!clearance.active()) {
+            return;
+        }
+        
+        // Each end of a step pays half its penalty per unit of step length.
+        // Border cells read their neighbours through clearanceAt, which may
+        // bind another chunk.
+        const double ownPenalty = clearance.penalty(interior ? lastClearance->distance[i] : clearanceAt(x, y));
+        const float* field = interior ? &lastClearance->distance[i] : nullptr;
+        for (int d = 0; d < 8; d++) {
+            if (std::isinf(costs[d])) {
+                continue;
+            }
+            const int dx = kStepDirections[d][0];
+            const int dy = kStepDirections[d][1];
+            double penalty = ownPenalty + clearance.penalty(
+                field ? field[dx * chunkSize + dy] : clearanceAt(x + dx, y + dy));
+            costs[d] += 0.5 * penalty * (d >= 4 ? 1.4 : 1.0);
+        }
+    }
+};
+
+// Distance bounds from a few landmarks to every cell, for the ALT heuristic:
+// by the triangle inequality, a cell v is at least d(L, goal) - d(L, v) and
+// d(L, v) - d(L, goal) from the goal for every landmark L. Landmarks are
+// picked among chunk centres, each as far as possible from the ones before
+// it by Dijkstra over the coarsest mip level that still has up to 512
+// samples per side. Each landmark's distances then come from a Dijkstra
+// over every cell under the plain step costs, kept as the least and
+// greatest distance within each block of cells one coarse sample covers,
+// so the heuristic never overestimates. Tables are built only by prepare,
+// again after edits that may lower step costs, and kept per elevation
+// weight with the terrain and, as generated, in its chunk store if it has
+// one.
+class LandmarkTable {
+private:
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        int32_t level;
+        int32_t columns;
+        int32_t rows;
+        int32_t count;
+        double elevationWeight;
+    };
+    
+    static const uint32_t kMagic = 0x544C544D;  // "MTLT"
+    static const uint32_t kVersion = 2;
+    static const int kMaxSamplesPerSide = 512;
+    static const int kPageSide = 64;
+    static const size_t kMaxTablesKept = 4;
+    
+    // Tables built so far for one terrain, newest last
+    struct Tables {
+        std::vector<std::shared_ptr<const LandmarkTable>> tables;
+    };
+    
+    double elevationWeight;
+    int level;
+    int stride;
+    int columns;
+    int rows;
+    std::vector<std::pair<int, int>> landmarks;  // World coordinates
+    std::vector<float> lower;                    // (landmark * columns + i) * rows + j
+    std::vector<float> upper;                    // Same layout
+    uint64_t sequence;                           // Terrain change the bounds hold since
+    
+    // Dijkstra from one sample over the coarse grid of elevations, costing a
+    // step between samples like a straight run of full-resolution steps
+    // climbing the same height. Only used to spread the landmarks out.
+    void coarseDistances(const std::vector<float>& elevations, int source, float* out) const {
+        const size_t sampleCount = static_cast<size_t>(columns) * rows;
+        std::fill(out, out + sampleCount, std::numeric_limits<float>::infinity());
+        
+        typedef std::pair<float, int> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        out[source] = 0.0f;
+        open.push({0.0f, source});
+        
+        while (!open.empty()) {
+            Entry entry = open.top();
+            open.pop();
+            int current = entry.second;
+            if (entry.first > out[current]) {
+                continue;  // Stale entry
+            }
+            
+            int ci = current / rows;
+            int cj = current % rows;
+            for (int d = 0; d < 8; d++) {
+                int ni = ci + kStepDirections[d][0];
+                int nj = cj + kStepDirections[d][1];
+                if (ni < 0 || ni >= columns || nj < 0 || nj >= rows) {
+                    continue;
+                }
+                int neighbor = ni * rows + nj;
+                double step = (d >= 4 ? 1.4 : 1.0) * stride +
+                              elevationWeight * std::abs(elevations[current] - elevations[neighbor]);
+                float candidate = static_cast<float>(entry.first + step);
+                if (candidate < out[neighbor]) {
+                    out[neighbor] = candidate;
+                    open.push({candidate, neighbor});
+                }
+            }
+        }
+    }
+    
+    // Sample elevations of the table's level, with obstacle samples replaced
+    // by the mean of their free neighbours
+    std::vector<float> sampleElevations(TerrainGenerator& terrain) const {
+        std::vector<float> elevations(static_cast<size_t>(columns) * rows);
+        terrain.getRegionLod(0, 0, columns, rows, level, elevations.data());
+        
+        std::vector<float> filled = elevations;
+        for (int i = 0; i < columns; i++) {
+            for (int j = 0; j < rows; j++) {
+                if (elevations[static_cast<size_t>(i) * rows + j] >= 0) {
+                    continue;
+                }
+                float sum = 0.0f;
+                int free = 0;
+                for (int d = 0; d < 8; d++) {
+                    int ni = i + kStepDirections[d][0];
+                    int nj = j + kStepDirections[d][1];
+                    if (ni >= 0 && ni < columns && nj >= 0 && nj < rows &&
+                        elevations[static_cast<size_t>(ni) * rows + nj] >= 0) {
+                        sum += elevations[static_cast<size_t>(ni) * rows + nj];
+                        free++;
+                    }
+                }
+                filled[static_cast<size_t>(i) * rows + j] = free > 0 ? sum / free : 0.0f;
+            }
+        }
+        return filled;
+    }
+    
+    // Free cell nearest (x, y), searched in growing square rings; (x, y)
+    // itself if there is none
+    static std::pair<int, int> nearestFreeCell(TerrainGenerator& terrain, int x, int y) {
+        const int reach = std::max(terrain.getWidth(), terrain.getHeight());
+        for (int r = 0; r < reach; r++) {
+            for (int dx = -r; dx <= r; dx++) {
+                for (int dy = -r; dy <= r; dy += (std::abs(dx) == r ? 1 : 2 * r)) {
+                    int cx = x + dx;
+                    int cy = y + dy;
+                    if (cx >= 0 && cx < terrain.getWidth() && cy >= 0 && cy < terrain.getHeight() &&
+                        terrain.getElevation(cx, cy) >= 0) {
+                        return {cx, cy};
+                    }
+                }
+            }
+        }
+        return {x, y};
+    }
+    
+    // Dijkstra from cell (sourceX, sourceY) over every cell, reduced to the
+    // least and greatest distance within each block. elevations holds every
+    // cell, x-major, and no step costs more than maxStepCost. Blocks holding
+    // a free cell the search cannot reach get the bounds 0 and infinity,
+    // which rule nothing out. Distances live in pages that are dropped once
+    // all their cells are settled, so memory follows the search frontier.
+    void blockBounds(const TerrainGenerator& terrain, const std::vector<float>& elevations, double maxStepCost,
+                     int sourceX, int sourceY, float* lo, float* hi) const {
+        const int width = terrain.getWidth();
+        const int height = terrain.getHeight();
+        const double steepThreshold = terrain.getMaxElevation() / 10.0;
+        const double infinity = std::numeric_limits<double>::infinity();
+        const int pagesY = (height + kPageSide - 1) / kPageSide;
+        const size_t pageCount = static_cast<size_t>((width + kPageSide - 1) / kPageSide) * pagesY;
+        
+        struct Page {
+            std::vector<double> distances;
+            int unsettled;
+        };
+        std::vector<std::unique_ptr<Page>> pages(pageCount);
+        std::vector<uint64_t> settledBits((static_cast<size_t>(width) * height + 63) / 64, 0);
+        auto elevationAt = [&](int x, int y) { return elevations[static_cast<size_t>(x) * height + y]; };
+        
+        auto settled = [&](size_t cell) { return (settledBits[cell >> 6] >> (cell & 63)) & 1; };
+        auto pageIndex = [&](int x, int y) { return static_cast<size_t>(x / kPageSide) * pagesY + y / kPageSide; };
+        auto page = [&](int x, int y) -> Page& {
+            std::unique_ptr<Page>& entry = pages[pageIndex(x, y)];
+            if (!entry) {
+                int x0 = x / kPageSide * kPageSide;
+                int y0 = y / kPageSide * kPageSide;
+                entry.reset(new Page);
+                entry->distances.assign(kPageSide * kPageSide, infinity);
+                entry->unsettled = std::min(kPageSide, width - x0) * std::min(kPageSide, height - y0);
+            }
+            return *entry;
+        };
+        auto distanceAt = [&](int x, int y) -> double& {
+            return page(x, y).distances[(x % kPageSide) * kPageSide + y % kPageSide];
+        };
+        auto settle = [&](int x, int y) {
+            size_t cell = static_cast<size_t>(x) * height + y;
+            settledBits[cell >> 6] |= uint64_t(1) << (cell & 63);
+            if (--page(x, y).unsettled == 0) {
+                pages[pageIndex(x, y)].reset();
+            }
+        };
+        
+        const size_t blockCount = static_cast<size_t>(columns) * rows;
+        std::vector<double> blockLo(blockCount, infinity);
+        std::vector<double> blockHi(blockCount, 0.0);
+        
+        // Steps cost at least 1, so cells whose distances share an integer
+        // part cannot shorten each other's paths and are settled in any
+        // order. Buckets hold cells by that integer part, in a ring long
+        // enough that no step reaches past its end.
+        std::vector<std::vector<size_t>> buckets(static_cast<size_t>(maxStepCost) + 2);
+        size_t queued = 1;
+        distanceAt(sourceX, sourceY) = 0.0;
+        buckets[0].push_back(static_cast<size_t>(sourceX) * height + sourceY);
+        
+        for (size_t b = 0; queued > 0; b++) {
+            std::vector<size_t>& bucket = buckets[b % buckets.size()];
+            while (!bucket.empty()) {
+                size_t cell = bucket.back();
+                bucket.pop_back();
+                queued--;
+                if (settled(cell)) {
+                    continue;  // Stale entry
+                }
+                int x = static_cast<int>(cell / height);
+                int y = static_cast<int>(cell % height);
+                const double distance = distanceAt(x, y);
+                settle(x, y);
+                
+                size_t block = static_cast<size_t>(x / stride) * rows + y / stride;
+                blockLo[block] = std::min(blockLo[block], distance);
+                blockHi[block] = std::max(blockHi[block], distance);
+                
+                float elevation = elevationAt(x, y);
+                for (int d = 0; d < 8; d++) {
+                    int nx = x + kStepDirections[d][0];
+                    int ny = y + kStepDirections[d][1];
+                    if (nx < 0 || nx >= width || ny < 0 || ny >= height ||
+                        settled(static_cast<size_t>(nx) * height + ny)) {
+                        continue;
+                    }
+                    float neighborElevation = elevationAt(nx, ny);
+                    if (neighborElevation < 0) {
+                        settle(nx, ny);  // Obstacles are never entered
+                        continue;
+                    }
+                    double candidate = distance + traversalCost(d >= 4, elevation, neighborElevation,
+                                                                steepThreshold, elevationWeight);
+                    double& known = distanceAt(nx, ny);
+                    if (candidate < known) {
+                        known = candidate;
+                        buckets[static_cast<size_t>(candidate) % buckets.size()].push_back(
+                            static_cast<size_t>(nx) * height + ny);
+                        queued++;
+                    }
+                }
+            }
+        }
+        
+        // Free cells left unsettled are unreachable from the landmark. Pages
+        // never touched have no settled cells; dropped ones have only those.
+        std::vector<uint8_t> unknown(blockCount, 0);
+        for (int px = 0; px * kPageSide < width; px++) {
+            for (int py = 0; py * kPageSide < height; py++) {
+                int x0 = px * kPageSide;
+                int y0 = py * kPageSide;
+                if (!pages[pageIndex(x0, y0)] && settled(static_cast<size_t>(x0) * height + y0)) {
+                    continue;
+                }
+                for (int x = x0; x < std::min(width, x0 + kPageSide); x++) {
+                    for (int y = y0; y < std::min(height, y0 + kPageSide); y++) {
+                        if (!settled(static_cast<size_t>(x) * height + y) && elevationAt(x, y) >= 0) {
+                            unknown[static_cast<size_t>(x / stride) * rows + y / stride] = 1;
+                        }
+                    }
+                }
+            }
+        }
+        
+        // Round outwards so the stored floats still bound the distances
+        for (size_t b = 0; b < blockCount; b++) {
+            if (unknown[b] || std::isinf(blockLo[b])) {
+                lo[b] = 0.0f;
+                hi[b] = std::numeric_limits<float>::infinity();
+                continue;
+            }
+            lo[b] = static_cast<float>(blockLo[b]);
+            if (lo[b] > blockLo[b]) {
+                lo[b] = std::nextafter(lo[b], 0.0f);
+            }
+            hi[b] = static_cast<float>(blockHi[b]);
+            if (hi[b] < blockHi[b]) {
+                hi[b] = std::nextafter(hi[b], std::numeric_limits<float>::infinity());
+            }
+        }
+    }
+    
+    void build(TerrainGenerator& terrain, int count) {
+        std::vector<float> elevations = sampleElevations(terrain);
+        const size_t sampleCount = static_cast<size_t>(columns) * rows;
+        
+        // Candidate landmarks: the sample nearest each chunk centre
+        const int chunkSize = terrain.getChunkSize();
+        std::vector<int> candidates;
+        for (int cx = 0; cx * chunkSize < terrain.getWidth(); cx++) {
+            for (int cy = 0; cy * chunkSize < terrain.getHeight(); cy++) {
+                int x = std::min(terrain.getWidth() - 1, cx * chunkSize + chunkSize / 2);
+                int y = std::min(terrain.getHeight() - 1, cy * chunkSize + chunkSize / 2);
+                int i = std::min(columns - 1, (x + stride / 2) / stride);
+                int j = std::min(rows - 1, (y + stride / 2) / stride);
+                candidates.push_back(i * rows + j);
+            }
+        }
+        count = std::min(count, static_cast<int>(candidates.size()));
+        
+        // Start from the candidate farthest from the centre, then repeatedly
+        // add the one farthest from every landmark so far
+        std::vector<float> nearest(sampleCount);
+        std::vector<float> coarse(sampleCount);
+        coarseDistances(elevations, candidates[candidates.size() / 2], nearest.data());
+        
+        for (int k = 0; k < count; k++) {
+            int chosen = candidates[0];
+            for (int candidate : candidates) {
+                if (nearest[candidate] > nearest[chosen]) {
+                    chosen = candidate;
+                }
+            }
+            landmarks.push_back(nearestFreeCell(terrain, std::min(terrain.getWidth() - 1, chosen / rows * stride),
+                                                std::min(terrain.getHeight() - 1, chosen % rows * stride)));
+            
+            coarseDistances(elevations, chosen, coarse.data());
+            for (size_t s = 0; s < sampleCount; s++) {
+                nearest[s] = k == 0 ? coarse[s] : std::min(nearest[s], coarse[s]);
+            }
+        }
+        
+        // Every cell, read a column of chunks at a time
+        const int height = terrain.getHeight();
+        std::vector<float> cells(static_cast<size_t>(terrain.getWidth()) * height);
+        terrain.parallelFor((terrain.getWidth() + chunkSize - 1) / chunkSize, [&](int cx) {
+            int x0 = cx * chunkSize;
+            terrain.getRegion(x0, 0, std::min(chunkSize, terrain.getWidth() - x0), height, 1,
+                              &cells[static_cast<size_t>(x0) * height]);
+        });
+        
+        float least = std::numeric_limits<float>::infinity();
+        float greatest = 0.0f;
+        for (float cell : cells) {
+            if (cell >= 0) {
+                least = std::min(least, cell);
+                greatest = std::max(greatest, cell);
+            }
+        }
+        const double maxStepCost = 1.4 + 10 * elevationWeight * std::max(0.0f, greatest - least);
+        
+        lower.resize(sampleCount * count);
+        upper.resize(sampleCount * count);
+        terrain.parallelFor(count, [&](int k) {
+            blockBounds(terrain, cells, maxStepCost, landmarks[k].first, landmarks[k].second,
+                        &lower[sampleCount * k], &upper[sampleCount * k]);
+        });
+    }
+    
+    std::string blobName(int count) const {
+        uint64_t weightBits;
+        std::memcpy(&weightBits, &elevationWeight, sizeof(weightBits));
+        char name[96];
+        std::snprintf(name, sizeof(name), "landmarks_l%d_k%d_w%016llx.alt", level,
+                      count, static_cast<unsigned long long>(weightBits));
+        return name;
+    }
+    
+    std::vector<char> serialize() const {
+        FileHeader header = {kMagic, kVersion, level, columns, rows,
+                             static_cast<int32_t>(landmarks.size()), elevationWeight};
+        std::vector<char> data(sizeof(header) + landmarks.size() * 2 * sizeof(int32_t) +
+                               (lower.size() + upper.size()) * sizeof(float));
+        char* out = data.data();
+        std::memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+        for (const auto& landmark : landmarks) {
+            int32_t coords[2] = {landmark.first, landmark.second};
+            std::memcpy(out, coords, sizeof(coords));
+            out += sizeof(coords);
+        }
+        std::memcpy(out, lower.data(), lower.size() * sizeof(float));
+        out += lower.size() * sizeof(float);
+        std::memcpy(out, upper.data(), upper.size() * sizeof(float));
+        return data;
+    }
+    
+    bool deserialize(const std::vector<char>& data, int count) {
+        FileHeader header;
+        if (data.size() < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+        const size_t sampleCount = static_cast<size_t>(columns) * rows;
+        if (header.magic != kMagic || header.version != kVersion || header.level != level ||
+            header.columns != columns || header.rows != rows || header.count != count ||
+            header.elevationWeight != elevationWeight ||
+            data.size() != sizeof(header) + header.count * (2 * sizeof(int32_t) + 2 * sampleCount * sizeof(float))) {
+            return false;
+        }
+        
+        const char* in = data.data() + sizeof(header);
+        for (int k = 0; k < header.count; k++) {
+            int32_t coords[2];
+            std::memcpy(coords, in, sizeof(coords));
+            in += sizeof(coords);
+            landmarks.push_back({coords[0], coords[1]});
+        }
+        lower.resize(sampleCount * header.count);
+        std::memcpy(lower.data(), in, lower.size() * sizeof(float));
+        in += lower.size() * sizeof(float);
+        upper.resize(sampleCount * header.count);
+        std::memcpy(upper.data(), in, upper.size() * sizeof(float));
+        return true;
+    }
+    
+    LandmarkTable(const TerrainGenerator& terrain, double elevationWeight)
+        : elevationWeight(elevationWeight), level(1), sequence(0) {
+        while (level < TerrainGenerator::getMaxLodLevel() &&
+               ((terrain.getWidth() - 1) >> level) + 1 > kMaxSamplesPerSide) {
+            level++;
+        }
+        while (level < TerrainGenerator::getMaxLodLevel() &&
+               ((terrain.getHeight() - 1) >> level) + 1 > kMaxSamplesPerSide) {
+            level++;
+        }
+        stride = 1 << level;
+        columns = (terrain.getWidth() + stride - 1) / stride;
+        rows = (terrain.getHeight() + stride - 1) / stride;
+    }
+    
+    // The kept table for an elevation weight, current or not
+    static std::shared_ptr<const LandmarkTable> kept(const TerrainGenerator& terrain, double elevationWeight) {
+        auto tables = terrain.getAnnotation<Tables>(TERRAIN_ANNOTATION_LANDMARKS);
+        if (tables) {
+            for (const auto& table : tables->tables) {
+                if (table->elevationWeight == elevationWeight && table->getCount() == terrain.getLandmarkCount()) {
+                    return table;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    static const int kMaxLandmarks = 16;
+    
+    // Largest world prepare builds tables for, in cells. The build holds
+    // every cell in memory and takes seconds per million cells on one core.
+    static const int64_t kMaxBuildCells = int64_t(1) << 24;
+    
+    // The terrain's table for an elevation weight if one was prepared and no
+    // change since may have lowered a step cost, else nullptr. Never
+    // builds, so searches can call it.
+    static std::shared_ptr<const LandmarkTable> current(TerrainGenerator& terrain, double elevationWeight) {
+        std::shared_ptr<const LandmarkTable> table = kept(terrain, elevationWeight);
+        if (table && table->sequence < terrain.getLoweringSequence()) {
+            return nullptr;
+        }
+        return table;
+    }
+    
+    // The terrain's table for an elevation weight, made current: a kept
+    // table that still holds, else the one in the chunk store while cells
+    // are as generated, else a new one. A build generates every chunk and
+    // runs a full-resolution Dijkstra per landmark, in parallel; it is
+    // refused, returning nullptr, for worlds of more than kMaxBuildCells
+    // cells.
+    static std::shared_ptr<const LandmarkTable> prepare(TerrainGenerator& terrain, double elevationWeight) {
+        // One build per terrain at a time, so concurrent callers wait for
+        // the first
+        std::lock_guard<std::mutex> lock(terrain.getAnnotationBuildMutex());
+        std::shared_ptr<const LandmarkTable> found = current(terrain, elevationWeight);
+        if (found) {
+            return found;
+        }
+        
+        const int count = terrain.getLandmarkCount();
+        std::shared_ptr<LandmarkTable> table(new LandmarkTable(terrain, elevationWeight));
+        const std::string name = table->blobName(count);
+        std::vector<char> data;
+        table->sequence = terrain.getRegeneratedSequence();
+        if (table->sequence < terrain.getLoweringSequence() || !terrain.loadStoredBlob(name, data) ||
+            !table->deserialize(data, count)) {
+            if (static_cast<int64_t>(terrain.getWidth()) * terrain.getHeight() > kMaxBuildCells) {
+                return nullptr;
+            }
+            table.reset(new LandmarkTable(terrain, elevationWeight));
+            table->sequence = terrain.getChangeSequence();
+            table->build(terrain, count);
+            
+            // The store holds tables of the terrain as generated
+            if (!terrain.hasCellChanges()) {
+                terrain.saveStoredBlob(name, table->serialize());
+            }
+        }
+        
+        // Replace any stale table for the weight
+        std::shared_ptr<const LandmarkTable> stale = kept(terrain, elevationWeight);
+        auto tables = terrain.getAnnotation<Tables>(TERRAIN_ANNOTATION_LANDMARKS);
+        auto updated = std::make_shared<Tables>();
+        if (tables) {
+            updated->tables = tables->tables;
+        }
+        auto replaced = std::find(updated->tables.begin(), updated->tables.end(), stale);
+        if (replaced != updated->tables.end()) {
+            updated->tables.erase(replaced);
+        }
+        if (updated->tables.size() >= kMaxTablesKept) {
+            updated->tables.erase(updated->tables.begin());
+        }
+        updated->tables.push_back(table);
+        terrain.setAnnotation<Tables>(TERRAIN_ANNOTATION_LANDMARKS, updated);
+        return table;
+    }
+    
+    int getCount() const { return static_cast<int>(landmarks.size()); }
+    double getElevationWeight() const { return elevationWeight; }
+    const std::vector<std::pair<int, int>>& getLandmarks() const { return landmarks; }
+    
+    // Least and greatest distance from landmark k to any cell in the block
+    // holding (x, y)
+    double lowerBound(int k, int x, int y) const {
+        return lower[(static_cast<size_t>(columns) * k + x / stride) * rows + y / stride];
+    }
+    
+    double upperBound(int k, int x, int y) const {
+        return upper[(static_cast<size_t>(columns) * k + x / stride) * rows + y / stride];
+    }
+};
+
+// Remaining-cost estimate of one A* search towards a fixed goal. The
+// octile distance bounds the base step costs, and since steps cost at
+// least the weighted height they climb, the elevation difference to the
+// goal bounds the rest; both are admissible and consistent. The landmark
+// bound is tighter around ridges and long detours. It is admissible too but
+// not consistent, so searches using it reopen cells they find a cheaper way
+// to. Searches never build or repair tables: until one is prepared, and
+// again after a change that may lower step costs until it is prepared once
+// more, they fall back to the octile bound.
+class SearchHeuristic {
+private:
+    PathHeuristic kind;
+    int goalX;
+    int goalY;
+    float goalElevation;
+    double elevationWeight;
+    
+    std::shared_ptr<const LandmarkTable> landmarks;
+    double goalLower[LandmarkTable::kMaxLandmarks];
+    double goalUpper[LandmarkTable::kMaxLandmarks];
+
+public:
+    SearchHeuristic(TerrainGenerator& terrain, PathHeuristic kind, int goalX, int goalY,
+                    float goalElevation, double elevationWeight)
+        : kind(kind), goalX(goalX), goalY(goalY), goalElevation(goalElevation),
+          elevationWeight(std::max(0.0, elevationWeight)) {
+        if (kind == PATH_HEURISTIC_LANDMARKS) {
+            landmarks = LandmarkTable::current(terrain, elevationWeight);
+        }
+        if (landmarks) {
+            for (int k = 0; k < landmarks->getCount(); k++) {
+                goalLower[k] = landmarks->lowerBound(k, goalX, goalY);
+                goalUpper[k] = landmarks->upperBound(k, goalX, goalY);
+            }
+        }
+    }
+    
+    // Whether searches must reopen closed cells to stay optimal
+    bool reopens() const { return landmarks != nullptr; }
+    
+    // Octile distance: diagonal steps for the shorter axis, straight ones
+    // for the rest
+    static double octile(int dx, int dy) {
+        dx = std::abs(dx);
+        dy = std::abs(dy);
+        return std::max(dx, dy) + 0.4 * std::min(dx, dy);
+    }
+    
+    // Estimate from cell (x, y), whose elevation is given
+    double operator()(int x, int y, float elevation) const {
+        if (kind == PATH_HEURISTIC_MANHATTAN) {
+            return std::abs(x - goalX) + std::abs(y - goalY);
+        }
+        
+        double estimate = octile(x - goalX, y - goalY) + elevationWeight * std::abs(elevation - goalElevation);
+        if (landmarks) {
+            double alt = 0.0;
+            for (int k = 0; k < landmarks->getCount(); k++) {
+                alt = std::max(alt, std::max(goalLower[k] - landmarks->upperBound(k, x, y),
+                                             landmarks->lowerBound(k, x, y) - goalUpper[k]));
+            }
+            estimate = std::max(estimate, alt);
+        }
+        return estimate;
+    }
+};
+
+// Shared between a search and the thread waiting on it. The search checks
+// for cancellation and publishes its best partial path every few thousand
+// expansions.
+class SearchProgress {
+private:
+    std::atomic<bool> cancelled;
+    mutable std::mutex mutex;
+    std::vector<std::pair<int, int>> partial;
+    double partialBound;
+
+public:
+    static const int kPublishInterval = 4096;  // Expansions between checks
+    
+    SearchProgress() : cancelled(false), partialBound(std::numeric_limits<double>::infinity()) {}
+    
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+    
+    // Replace the published path. bound is its suboptimality bound if it
+    // reaches the goal, infinity for a partial path.
+    void publish(std::vector<std::pair<int, int>> path,
+                 double bound = std::numeric_limits<double>::infinity()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        partial.swap(path);
+        partialBound = bound;
+    }
+    
+    // Last published path: the path to the searched cell closest to the goal
+    // so far, or for anytime searches the best full path so far
+    std::vector<std::pair<int, int>> partialPath(double* bound = nullptr) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (bound) {
+            *bound = partialBound;
+        }
+        return partial;
+    }
+};
+
+// A* pathfinder that reads elevations straight from the TerrainGenerator
+// chunk cache. Uses the same cost model as PathFinder.compute_cost in
+// mars_terrain/terrain.py.
+class PathFinder {
+private:
+    TerrainGenerator& terrain;
+    
+    int expansions;
+    SearchProgress* progress;
+    
+    // Walk parents back from node to the start
+    static std::vector<std::pair<int, int>> tracePath(SearchArena& arena, SearchArena::Node node) {
+        std::vector<std::pair<int, int>> path;
+        for (; node != SearchArena::kNoNode; node = arena.parent(node)) {
+            path.push_back({arena.x(node), arena.y(node)});
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+public:
+    explicit PathFinder(TerrainGenerator& terrain)
+        : terrain(terrain), expansions(0), progress(nullptr) {}
+    
+    // Cells expanded by the last search
+    int getExpansions() const { return expansions; }
+    
+    // Report partial paths to progress and stop early once it is cancelled
+    // (nullptr to stop reporting). The caller keeps progress alive.
+    void setProgress(SearchProgress* newProgress) { progress = newProgress; }
+    
+    // Find a path from start to goal. Returns an empty vector if either end is
+    // an obstacle or short of the required clearance, no path exists, or
+    // maxIterations expansions are exceeded (maxIterations <= 0 means
+    // unlimited). Search state lives in the calling thread's SearchArena.
+    std::vector<std::pair<int, int>> findPath(int startX, int startY, int goalX, int goalY,
+                                              double elevationWeight, int maxIterations) {
+        std::vector<std::pair<int, int>> path;
+        expansions = 0;
+        PathSearchRecorder recorder(terrain, expansions);
+        
+        EdgeCostReader edges(terrain, elevationWeight);
+        if (!edges.fits(startX, startY) || !edges.fits(goalX, goalY)) {
+            return path;
+        }
+        
+        SearchArena& arena = SearchArena::forThisThread();
+        arena.reset(terrain.getWidth(), terrain.getHeight());
+        const SearchArena::Node startNode = arena.node(startX, startY);
+        const SearchArena::Node goalNode = arena.node(goalX, goalY);
+        
+        // The terrain's heuristic, matching PathFinder.heuristic
+        SearchHeuristic heuristic(terrain, terrain.getPathHeuristic(), goalX, goalY,
+                                  edges.elevationAt(goalX, goalY), elevationWeight);
+        
+        arena.g(startNode) = 0.0;
+        arena.push(startNode, heuristic(startX, startY, edges.elevationAt(startX, startY)));
+        
+        bool found = false;
+        
+        // Expanded cell closest to the goal, for partial paths
+        SearchArena::Node best = startNode;
+        SearchArena::Node published = SearchArena::kNoNode;
+        double bestDistance = SearchHeuristic::octile(startX - goalX, startY - goalY);
+        
+        while (!arena.empty()) {
+            SearchArena::Node current = arena.pop();
+            if (current == goalNode) {
+                found = true;
+                break;
+            }
+            
+            if (maxIterations > 0 && expansions >= maxIterations) {
+                break;
+            }
+            expansions++;
+            
+            int cx = arena.x(current);
+            int cy = arena.y(current);
+            
+            if (progress) {
+                double distance = SearchHeuristic::octile(cx - goalX, cy - goalY);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = current;
+                }
+                if (expansions % SearchProgress::kPublishInterval == 0) {
+                    if (progress->isCancelled()) {
+                        break;
+                    }
+                    if (best != published) {
+                        progress->publish(tracePath(arena, best));
+                        published = best;
+                    }
+                }
+            }
+            
+            double currentG = arena.g(current);
+            double costs[8];
+            edges.stepCosts(cx, cy, costs);
+            
+            for (int d = 0; d < 8; d++) {
+                double cost = costs[d];
+                if (std::isinf(cost)) {
+                    continue;  // Out of bounds or obstacle
+                }
+                
+                int nx = cx + kStepDirections[d][0];
+                int ny = cy + kStepDirections[d][1];
+                SearchArena::Node neighbor = arena.node(nx, ny);
+                if (arena.closed(neighbor) && !heuristic.reopens()) {
+                    continue;
+                }
+                
+                double tentativeG = currentG + cost;
+                if (tentativeG < arena.g(neighbor)) {
+                    arena.g(neighbor) = tentativeG;
+                    arena.parent(neighbor) = current;
+                    arena.push(neighbor, tentativeG + heuristic(nx, ny, edges.elevationAt(nx, ny)));
+                }
+            }
+        }
+        
+        if (!found) {
+            return path;
+        }
+        
+        // Reconstruct the path by walking back from the goal
+        return tracePath(arena, goalNode);
+    }
+    
+    friend class AnytimePathFinder;
+};
+
+// Inflation schedule and time budget of an anytime search, laid out for the
+// C API
+struct AnytimeSchedule {
+    double initialEpsilon;  // Heuristic inflation of the first search, at least 1
+    double finalEpsilon;    // Stop improving after a search at this inflation, at least 1
+    double epsilonStep;     // Decrease between searches; <= 0 goes straight to finalEpsilon
+    double deadlineMs;      // Wall-clock budget for the search, <= 0 for none
+};
+
+// Anytime repairing A* (ARA*). The first search is weighted A* with the
+// heuristic inflated by initialEpsilon, which finds a path quickly whose cost
+// is at most epsilon times optimal. Each later search lowers epsilon and
+// reuses the previous one's costs, re-expanding only cells whose cost
+// improved, until finalEpsilon is done or the deadline passes. Equal initial
+// and final epsilons give plain weighted A*.
+//
+// The heuristic is the octile distance plus the weighted climb to the goal
+// (see SearchHeuristic), which never overestimates the step costs, so the
+// reported bound holds against the true optimum.
+// The deadline only stops improvement: the first path is always searched
+// for, limited only by maxIterations.
+class AnytimePathFinder {
+private:
+    TerrainGenerator& terrain;
+    
+    int expansions;
+    int improvements;
+    double bound;
+    SearchProgress* progress;
+    
+    // Search iteration each node was last expanded in. Stamps keep growing
+    // across searches on a thread, so they never need clearing.
+    struct ExpandStamps {
+        std::vector<uint32_t> iteration;
+        uint32_t current;
+        
+        ExpandStamps() : current(0) {}
+        
+        uint32_t next() {
+            if (++current == 0) {
+                std::fill(iteration.begin(), iteration.end(), 0);
+                current = 1;
+            }
+            return current;
+        }
+        
+        uint32_t& at(SearchArena::Node node) {
+            if (node >= iteration.size()) {
+                iteration.resize(std::max<size_t>(node + 1, iteration.size() * 2), 0);
+            }
+            return iteration[node];
+        }
+    };
+    
+    static ExpandStamps& stampsForThisThread() {
+        static thread_local ExpandStamps stamps;
+        return stamps;
+    }
+
+public:
+    explicit AnytimePathFinder(TerrainGenerator& terrain)
+        : terrain(terrain), expansions(0), improvements(0),
+          bound(std::numeric_limits<double>::infinity()), progress(nullptr) {}
+    
+    // Cells expanded by the last search, over all its passes
+    int getExpansions() const { return expansions; }
+    
+    // Paths found by the last search; each one is cheaper than the last
+    int getImprovements() const { return improvements; }
+    
+    // Suboptimality bound of the returned path: its cost is at most this
+    // many times the optimum. Infinite if no path was returned.
+    double getBound() const { return bound; }
+    
+    // As for PathFinder; each improved path is published with its bound
+    void setProgress(SearchProgress* newProgress) { progress = newProgress; }
+    
+    // Find a path from start to goal under schedule. Returns the best path
+    // found, or an empty vector if either end is an obstacle or short of the
+    // required clearance, no path exists, or maxIterations expansions (<= 0
+    // means unlimited) ran out or the search was cancelled before the first
+    // one.
+    std::vector<std::pair<int, int>> findPath(int startX, int startY, int goalX, int goalY,
+                                              double elevationWeight, const AnytimeSchedule& schedule,
+                                              int maxIterations) {
+        std::vector<std::pair<int, int>> path;
+        expansions = 0;
+        improvements = 0;
+        bound = std::numeric_limits<double>::infinity();
+        PathSearchRecorder recorder(terrain, expansions);
+        
+        EdgeCostReader edges(terrain, elevationWeight);
+        if (!edges.fits(startX, startY) || !edges.fits(goalX, goalY)) {
+            return path;
+        }
+        
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point started = Clock::now();
+        bool hasDeadline = schedule.deadlineMs > 0;
+        Clock::time_point deadline = started + std::chrono::microseconds(
+            static_cast<int64_t>(hasDeadline ? schedule.deadlineMs * 1000.0 : 0.0));
+        
+        double epsilon = std::max(1.0, schedule.initialEpsilon);
+        double finalEpsilon = std::min(epsilon, std::max(1.0, schedule.finalEpsilon));
+        
+        SearchArena& arena = SearchArena::forThisThread();
+        arena.reset(terrain.getWidth(), terrain.getHeight());
+        ExpandStamps& stamps = stampsForThisThread();
+        const SearchArena::Node startNode = arena.node(startX, startY);
+        const SearchArena::Node goalNode = arena.node(goalX, goalY);
+        
+        SearchHeuristic heuristic(terrain, PATH_HEURISTIC_OCTILE_CLIMB, goalX, goalY,
+                                  edges.elevationAt(goalX, goalY), elevationWeight);
+        auto estimate = [&](int x, int y) { return heuristic(x, y, edges.elevationAt(x, y)); };
+        
+        arena.g(startNode) = 0.0;
+        arena.push(startNode, epsilon * estimate(startX, startY));
+        
+        // Cells whose cost improved after they were expanded in this pass
+        std::vector<SearchArena::Node> inconsistent;
+        
+        // Expanded cell closest to the goal, for partial paths before the first one
+        SearchArena::Node best = startNode;
+        SearchArena::Node published = SearchArena::kNoNode;
+        double bestDistance = SearchHeuristic::octile(startX - goalX, startY - goalY);
+        
+        for (;;) {
+            uint32_t pass = stamps.next();
+            bool stopped = false;
+            
+            while (!arena.empty() && arena.topPriority() < arena.g(goalNode)) {
+                if (maxIterations > 0 && expansions >= maxIterations) {
+                    stopped = true;
+                    break;
+                }
+                if (expansions % SearchProgress::kPublishInterval == 0 && expansions > 0) {
+                    if ((progress && progress->isCancelled()) || (!path.empty() && hasDeadline &&
+                                                                  Clock::now() >= deadline)) {
+                        stopped = true;
+                        break;
+                    }
+                    if (progress && path.empty() && best != published) {
+                        progress->publish(PathFinder::tracePath(arena, best));
+                        published = best;
+                    }
+                }
+                
+                SearchArena::Node current = arena.pop();
+                stamps.at(current) = pass;
+                expansions++;
+                
+                int cx = arena.x(current);
+                int cy = arena.y(current);
+                if (path.empty()) {
+                    double distance = SearchHeuristic::octile(cx - goalX, cy - goalY);
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        best = current;
+                    }
+                }
+                
+                double currentG = arena.g(current);
+                double costs[8];
+                edges.stepCosts(cx, cy, costs);
+                
+                for (int d = 0; d < 8; d++) {
+                    double cost = costs[d];
+                    if (std::isinf(cost)) {
+                        continue;  // Out of bounds or obstacle
+                    }
+                    
+                    int nx = cx + kStepDirections[d][0];
+                    int ny = cy + kStepDirections[d][1];
+                    SearchArena::Node neighbor = arena.node(nx, ny);
+                    double tentativeG = currentG + cost;
+                    if (tentativeG >= arena.g(neighbor)) {
+                        continue;
+                    }
+                    
+                    arena.g(neighbor) = tentativeG;
+                    arena.parent(neighbor) = current;
+                    if (stamps.at(neighbor) == pass) {
+                        inconsistent.push_back(neighbor);  // Requeued by the next pass
+                    } else {
+                        arena.push(neighbor, tentativeG + epsilon * estimate(nx, ny));
+                    }
+                }
+            }
+            
+            if (std::isinf(arena.g(goalNode))) {
+                break;  // No path, or stopped before the first one
+            }
+            
+            // The goal's parents always form a path no dearer than its cost,
+            // even when a pass stops early
+            path = PathFinder::tracePath(arena, goalNode);
+            if (!stopped) {
+                // Nothing left to expand can reach the goal more cheaply than
+                // the cheapest g + h among the remaining cells
+                double lowerBound = std::numeric_limits<double>::infinity();
+                for (SearchArena::Node node : arena.queuedNodes()) {
+                    lowerBound = std::min(lowerBound, arena.g(node) + estimate(arena.x(node), arena.y(node)));
+                }
+                for (SearchArena::Node node : inconsistent) {
+                    lowerBound = std::min(lowerBound, arena.g(node) + estimate(arena.x(node), arena.y(node)));
+                }
+                double ratio = lowerBound > 0 ? arena.g(goalNode) / lowerBound : 1.0;
+                bound = std::max(1.0, std::min(epsilon, ratio));
+                improvements++;
+            }
+            if (progress) {
+                progress->publish(path, bound);
+            }
+            
+            if (stopped || epsilon <= finalEpsilon || bound <= 1.0 ||
+                (hasDeadline && Clock::now() >= deadline)) {
+                break;
+            }
+            
+            // Next pass: lower epsilon and requeue every open and
+            // inconsistent cell under the new priorities
+            epsilon = schedule.epsilonStep > 0 ? std::max(finalEpsilon, epsilon - schedule.epsilonStep)
+                                               : finalEpsilon;
+            std::vector<SearchArena::Node> open(arena.queuedNodes());
+            arena.clearQueue();
+            open.insert(open.end(), inconsistent.begin(), inconsistent.end());
+            inconsistent.clear();
+            for (SearchArena::Node node : open) {
+                arena.push(node, arena.g(node) + epsilon * estimate(arena.x(node), arena.y(node)));
+            }
+        }
+        
+        return path;
+    }
+};
+
+// Search algorithms accepted by terrain_find_path_with
+enum PathAlgorithm {
+    PATH_ALGORITHM_ASTAR = 0,         // Exact A* over every cell
+    PATH_ALGORITHM_HIERARCHICAL = 1,  // HPA* over cluster border transitions, a few percent over optimal
+    PATH_ALGORITHM_JUMP_POINT = 2     // A* with jump point pruning on flat terrain
+};
+
+// One query of a terrain_find_paths batch, laid out for the C API
+struct PathQuery {
+    int startX;
+    int startY;
+    int goalX;
+    int goalY;
+    int algorithm;           // PathAlgorithm
+    double elevationWeight;
+    int maxIterations;       // As for terrain_find_path_with
+    double jumpTolerance;    // For PATH_ALGORITHM_JUMP_POINT, as for terrain_find_path_jps
+};
+
+// Outcome of one batch query. The caller sets path and capacity; the rest
+// is filled in.
+struct PathResult {
+    int* path;               // Receives up to capacity (x, y) pairs; may be NULL
+    int capacity;
+    int length;              // Points in the full path, 0 if none was found
+    int expansions;          // Nodes expanded for the query, or by its shared field
+    double cost;             // Path cost under the query's elevation weight
+    double latencyMs;        // Wall time from starting the query to its result
+    int sharedField;         // 1 if answered from a shared goal field
+};
+
+// Cells of one chunk whose every step costs its base within tolerance,
+// cached with the chunk for one elevation weight and tolerance
+struct ChunkSmoothness {
+    double elevationWeight;
+    double tolerance;
+    std::vector<uint64_t> bits;  // Bit x * chunkSize + y
+};
+
+// A* with jump point pruning. Around a cell whose every step has an
+// elevation term within tolerance, costs are treated as uniform: straight
+// and diagonal runs are followed without queuing the cells on them, stopping
+// at forced neighbours, rough cells and the goal. Rough cells are expanded
+// in every direction like plain A*. Path costs are exact; pruning can make
+// them exceed the optimum by about tolerance per step, and with tolerance 0
+// only perfectly flat regions are pruned.
+class JumpPointPathFinder {
+private:
+    TerrainGenerator& terrain;
+    double elevationWeight;
+    double steepThreshold;
+    double tolerance;
+    int goalX;
+    int goalY;
+    int expansions;
+    SearchProgress* progress;
+    
+    const int chunkSize;
+    int lastChunkX;
+    int lastChunkY;
+    ChunkPtr lastChunk;
+    
+    int lastMaskX;
+    int lastMaskY;
+    std::shared_ptr<const ChunkSmoothness> lastMask;
+    
+    float elevationAt(int x, int y) {
+        if (x < 0 || x >= terrain.getWidth() || y < 0 || y >= terrain.getHeight()) {
+            return -1.0f;
+        }
+        
+        int chunkX = x / chunkSize;
+        int chunkY = y / chunkSize;
+        
+        if (!lastChunk || chunkX != lastChunkX || chunkY != lastChunkY) {
+            lastChunk = terrain.getChunk(chunkX, chunkY);
+            lastChunkX = chunkX;
+            lastChunkY = chunkY;
+        }
+        
+        return lastChunk->at(x % chunkSize, y % chunkSize);
+    }
+    
+    bool blocked(int x, int y) {
+        return elevationAt(x, y) < 0;
+    }
+    
+    double stepCost(int dx, int dy, float from, float to) const {
+        return traversalCost(dx != 0 && dy != 0, from, to, steepThreshold, elevationWeight);
+    }
+    
+    // Every step out of the free cell costs its base within tolerance
+    bool cellIsSmooth(int x, int y, float elevation) {
+        for (const auto& dir : kStepDirections) {
+            float neighborElevation = terrain.getElevation(x + dir[0], y + dir[1]);
+            if (neighborElevation < 0) {
+                continue;
+            }
+            double base = dir[0] != 0 && dir[1] != 0 ? 1.4 : 1.0;
+            if (stepCost(dir[0], dir[1], elevation, neighborElevation) - base > tolerance) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    std::shared_ptr<const ChunkSmoothness> buildSmoothness(const ChunkData& chunk, int chunkX, int chunkY) {
+        auto mask = std::make_shared<ChunkSmoothness>();
+        mask->elevationWeight = elevationWeight;
+        mask->tolerance = tolerance;
+        mask->bits.assign((static_cast<size_t>(chunkSize) * chunkSize + 63) / 64, 0);
+        
+        for (int ix = 0; ix < chunkSize; ix++) {
+            for (int iy = 0; iy < chunkSize; iy++) {
+                size_t i = static_cast<size_t>(ix) * chunkSize + iy;
+                if (chunk.isObstacle(i)) {
+                    continue;
+                }
+                float elevation = chunk.at(ix, iy);
+                bool smooth = true;
+                
+                // Border cells need the neighbouring chunks
+                if (ix == 0 || iy == 0 || ix == chunkSize - 1 || iy == chunkSize - 1) {
+                    smooth = cellIsSmooth(chunkX * chunkSize + ix, chunkY * chunkSize + iy, elevation);
+                } else {
+                    for (const auto& dir : kStepDirections) {
+                        size_t j = static_cast<size_t>(ix + dir[0]) * chunkSize + iy + dir[1];
+                        if (chunk.isObstacle(j)) {
+                            continue;
+                        }
+                        double base = dir[0] != 0 && dir[1] != 0 ? 1.4 : 1.0;
+                        if (stepCost(dir[0], dir[1], elevation, chunk.at(ix + dir[0], iy + dir[1])) - base > tolerance) {
+                            smooth = false;
+                            break;
+                        }
+                    }
+                }
+                
+                if (smooth) {
+                    mask->bits[i / 64] |= uint64_t(1) << (i % 64);
+                }
+            }
+        }
+        return mask;
+    }
+    
+    // Smoothness of a free cell, from the chunk's cached bits
+    bool isSmooth(int x, int y) {
+        int chunkX = x / chunkSize;
+        int chunkY = y / chunkSize;
+        
+        if (!lastMask || chunkX != lastMaskX || chunkY != lastMaskY) {
+            ChunkPtr chunk = terrain.getChunk(chunkX, chunkY);
+            auto mask = chunk->getAnnotation<ChunkSmoothness>(CHUNK_ANNOTATION_SMOOTH_CELLS);
+            if (!mask || mask->elevationWeight != elevationWeight || mask->tolerance != tolerance) {
+                mask = buildSmoothness(*chunk, chunkX, chunkY);
+                chunk->setAnnotation<ChunkSmoothness>(CHUNK_ANNOTATION_SMOOTH_CELLS, mask);
+            }
+            lastMask = mask;
+            lastMaskX = chunkX;
+            lastMaskY = chunkY;
+        }
+        
+        size_t i = static_cast<size_t>(x % chunkSize) * chunkSize + y % chunkSize;
+        return (lastMask->bits[i / 64] >> (i % 64)) & 1;
+    }
+    
+    // Octile distance to the goal; a lower bound on path cost
+    double heuristic(int x, int y) const {
+        return SearchHeuristic::octile(x - goalX, y - goalY);
+    }
+    
+    // Follow a run from (x, y) in direction (dx, dy) to the next jump point.
+    // Returns false if the run ends at an obstacle; otherwise sets the jump
+    // point and the exact cost of the run.
+    bool jump(int x, int y, int dx, int dy, int& outX, int& outY, double& cost) {
+        float elevation = elevationAt(x, y);
+        cost = 0.0;
+        
+        while (true) {
+            float nextElevation = elevationAt(x + dx, y + dy);
+            if (nextElevation < 0) {
+                return false;
+            }
+            cost += stepCost(dx, dy, elevation, nextElevation);
+            x += dx;
+            y += dy;
+            elevation = nextElevation;
+            
+            if ((x == goalX && y == goalY) || !isSmooth(x, y)) {
+                break;
+            }
+            
+            if (dx != 0 && dy != 0) {
+                if ((blocked(x - dx, y) && !blocked(x - dx, y + dy)) ||
+                    (blocked(x, y - dy) && !blocked(x + dx, y - dy))) {
+                    break;
+                }
+                
+                // A diagonal cell is a jump point if either straight run
+                // leaving it reaches one
+                int jumpX;
+                int jumpY;
+                double jumpCost;
+                if (jump(x, y, dx, 0, jumpX, jumpY, jumpCost) || jump(x, y, 0, dy, jumpX, jumpY, jumpCost)) {
+                    break;
+                }
+            } else if (dx != 0) {
+                if ((blocked(x, y + 1) && !blocked(x + dx, y + 1)) ||
+                    (blocked(x, y - 1) && !blocked(x + dx, y - 1))) {
+                    break;
+                }
+            } else {
+                if ((blocked(x + 1, y) && !blocked(x + 1, y + dy)) ||
+                    (blocked(x - 1, y) && !blocked(x - 1, y + dy))) {
+                    break;
+                }
+            }
+        }
+        
+        outX = x;
+        outY = y;
+        return true;
+    }
+    
+    static int sign(int v) {
+        return (v > 0) - (v < 0);
+    }
+
+public:
+    JumpPointPathFinder(TerrainGenerator& terrain, double elevationWeight, double tolerance)
+        : terrain(terrain), elevationWeight(elevationWeight),
+          steepThreshold(terrain.getMaxElevation() / 10.0), tolerance(tolerance),
+          goalX(0), goalY(0), expansions(0), progress(nullptr), chunkSize(terrain.getChunkSize()),
+          lastChunkX(0), lastChunkY(0), lastMaskX(0), lastMaskY(0) {}
+    
+    // Jump points expanded by the last search
+    int getExpansions() const { return expansions; }
+    
+    // Stop early once progress is cancelled (nullptr to stop checking).
+    // Partial paths are not reported. The caller keeps progress alive.
+    void setProgress(SearchProgress* newProgress) { progress = newProgress; }
+    
+    // Find a path as PathFinder::findPath does; maxIterations limits the
+    // jump points expanded. Pruning assumes the plain cost model, so under
+    // a clearance rule this is a plain A* search.
+    std::vector<std::pair<int, int>> findPath(int startX, int startY, int goalX, int goalY,
+                                              int maxIterations) {
+        if (terrain.getPathClearance().active()) {
+            PathFinder pathfinder(terrain);
+            pathfinder.setProgress(progress);
+            std::vector<std::pair<int, int>> path = pathfinder.findPath(startX, startY, goalX, goalY,
+                                                                        elevationWeight, maxIterations);
+            expansions = pathfinder.getExpansions();
+            return path;
+        }
+        
+        std::vector<std::pair<int, int>> path;
+        expansions = 0;
+        PathSearchRecorder recorder(terrain, expansions);
+        lastChunk.reset();
+        lastMask.reset();
+        this->goalX = goalX;
+        this->goalY = goalY;
+        
+        if (elevationAt(startX, startY) < 0 || elevationAt(goalX, goalY) < 0) {
+            return path;
+        }
+        
+        SearchArena& arena = SearchArena::forThisThread();
+        arena.reset(terrain.getWidth(), terrain.getHeight());
+        const SearchArena::Node startNode = arena.node(startX, startY);
+        const SearchArena::Node goalNode = arena.node(goalX, goalY);
+        
+        arena.g(startNode) = 0.0;
+        arena.push(startNode, heuristic(startX, startY));
+        
+        bool found = false;
+        std::vector<std::pair<int, int>> directions;
+        
+        while (!arena.empty()) {
+            SearchArena::Node current = arena.pop();
+            if (current == goalNode) {
+                found = true;
+                break;
+            }
+            
+            if (maxIterations > 0 && expansions >= maxIterations) {
+                break;
+            }
+            // Each jump point may scan a long run, so check every one
+            if (progress && progress->isCancelled()) {
+                break;
+            }
+            expansions++;
+            
+            int cx = arena.x(current);
+            int cy = arena.y(current);
+            double currentG = arena.g(current);
+            SearchArena::Node parent = arena.parent(current);
+            
+            // Start and rough cells step to every neighbour like plain A*;
+            // smooth cells jump towards the natural and forced neighbours of
+            // the run that reached them
+            directions.clear();
+            bool rough = parent == SearchArena::kNoNode || !isSmooth(cx, cy);
+            if (rough) {
+                for (const auto& dir : kStepDirections) {
+                    directions.push_back({dir[0], dir[1]});
+                }
+            } else {
+                int dx = sign(cx - arena.x(parent));
+                int dy = sign(cy - arena.y(parent));
+                
+                if (dx != 0 && dy != 0) {
+                    directions.push_back({dx, 0});
+                    directions.push_back({0, dy});
+                    directions.push_back({dx, dy});
+                    if (blocked(cx - dx, cy)) {
+                        directions.push_back({-dx, dy});
+                    }
+                    if (blocked(cx, cy - dy)) {
+                        directions.push_back({dx, -dy});
+                    }
+                } else if (dx != 0) {
+                    directions.push_back({dx, 0});
+                    if (blocked(cx, cy + 1)) {
+                        directions.push_back({dx, 1});
+                    }
+                    if (blocked(cx, cy - 1)) {
+                        directions.push_back({dx, -1});
+                    }
+                } else {
+                    directions.push_back({0, dy});
+                    if (blocked(cx + 1, cy)) {
+                        directions.push_back({1, dy});
+                    }
+                    if (blocked(cx - 1, cy)) {
+                        directions.push_back({-1, dy});
+                    }
+                }
+            }
+            
+            for (const auto& dir : directions) {
+                int jx = cx + dir.first;
+                int jy = cy + dir.second;
+                double cost;
+                if (rough) {
+                    float neighborElevation = elevationAt(jx, jy);
+                    if (neighborElevation < 0) {
+                        continue;
+                    }
+                    cost = stepCost(dir.first, dir.second, elevationAt(cx, cy), neighborElevation);
+                } else if (!jump(cx, cy, dir.first, dir.second, jx, jy, cost)) {
+                    continue;
+                }
+                
+                SearchArena::Node jumpNode = arena.node(jx, jy);
+                double tentativeG = currentG + cost;
+                if (!arena.closed(jumpNode) && tentativeG < arena.g(jumpNode)) {
+                    arena.g(jumpNode) = tentativeG;
+                    arena.parent(jumpNode) = current;
+                    arena.push(jumpNode, tentativeG + heuristic(jx, jy));
+                }
+            }
+        }
+        
+        if (!found) {
+            return path;
+        }
+        
+        // Walk back through the jump points, filling in the runs between them
+        for (SearchArena::Node node = goalNode; node != startNode; node = arena.parent(node)) {
+            SearchArena::Node parent = arena.parent(node);
+            int x = arena.x(node);
+            int y = arena.y(node);
+            int px = arena.x(parent);
+            int py = arena.y(parent);
+            int dx = sign(px - x);
+            int dy = sign(py - y);
+            while (x != px || y != py) {
+                path.push_back({x, y});
+                x += dx;
+                y += dy;
+            }
+        }
+        path.push_back({startX, startY});
+        std::reverse(path.begin(), path.end());
+        
+        return path;
+    }
+};
+
+// Dijkstra and A* confined to a square window, over dense window-sized
+// arrays
+class WindowSearch {
+private:
+    typedef std::pair<double, int> QueueEntry;
+    
+    TerrainGenerator& terrain;
+    int size;  // Window side length
+    double steepThreshold;
+    double elevationWeight;
+    
+    // Bound window; local cell index is lx * size + ly
+    int originX;
+    int originY;
+    int limitX;  // Local extents, clipped to the world
+    int limitY;
+    std::vector<float> elevations;
+    
+    std::vector<double> dist;
+    std::vector<int> parent;
+    std::vector<char> closed;
+    std::vector<char> isTarget;
+    
+    // Shared Dijkstra/A* loop. With goal >= 0 runs A* and stops at the goal;
+    // otherwise stops once every entry of targets has been settled.
+    void run(int source, int goal, const std::vector<int>& targets) {
+        std::fill(dist.begin(), dist.end(), std::numeric_limits<double>::infinity());
+        std::fill(closed.begin(), closed.end(), 0);
+        
+        int remaining = 0;
+        for (int target : targets) {
+            if (!isTarget[target]) {
+                isTarget[target] = 1;
+                remaining++;
+            }
+        }
+        
+        int goalX = goal / size;
+        int goalY = goal % size;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open;
+        dist[source] = 0.0;
+        parent[source] = -1;
+        open.push({goal >= 0 ? SearchHeuristic::octile(source / size - goalX, source % size - goalY) : 0.0,
+                   source});
+        
+        while (!open.empty()) {
+            int current = open.top().second;
+            open.pop();
+            if (closed[current]) {
+                continue;
+            }
+            closed[current] = 1;
+            
+            if (current == goal) {
+                break;
+            }
+            if (isTarget[current] && --remaining == 0 && goal < 0) {
+                break;
+            }
+            
+            int cx = current / size;
+            int cy = current % size;
+            float currentElevation = elevations[current];
+            
+            for (const auto& dir : kStepDirections) {
+                int nx = cx + dir[0];
+                int ny = cy + dir[1];
+                if (nx < 0 || nx >= limitX || ny < 0 || ny >= limitY) {
+                    continue;
+                }
+                
+                int neighbor = nx * size + ny;
+                float neighborElevation = elevations[neighbor];
+                if (closed[neighbor] || neighborElevation < 0) {
+                    continue;
+                }
+                
+                double g = dist[current] + traversalCost(dir[0] != 0 && dir[1] != 0, currentElevation,
+                                                         neighborElevation, steepThreshold, elevationWeight);
+                if (g < dist[neighbor]) {
+                    dist[neighbor] = g;
+                    parent[neighbor] = current;
+                    open.push({g + (goal >= 0 ? SearchHeuristic::octile(nx - goalX, ny - goalY) : 0.0), neighbor});
+                }
+            }
+        }
+        
+        for (int target : targets) {
+            isTarget[target] = 0;
+        }
+    }
+
+public:
+    WindowSearch(TerrainGenerator& terrain, int size, double elevationWeight)
+        : terrain(terrain), size(size), steepThreshold(terrain.getMaxElevation() / 10.0),
+          elevationWeight(elevationWeight), originX(0), originY(0), limitX(0), limitY(0),
+          elevations(static_cast<size_t>(size) * size), dist(elevations.size()),
+          parent(elevations.size()), closed(elevations.size()), isTarget(elevations.size(), 0) {}
+    
+    // Confine following searches to the window starting at (x0, y0)
+    void bind(int x0, int y0) {
+        originX = x0;
+        originY = y0;
+        limitX = std::min(size, terrain.getWidth() - x0);
+        limitY = std::min(size, terrain.getHeight() - y0);
+        
+        int chunkSize = terrain.getChunkSize();
+        std::fill(elevations.begin(), elevations.end(), -1.0f);
+        for (int cx = x0 / chunkSize; cx * chunkSize < x0 + limitX; cx++) {
+            for (int cy = y0 / chunkSize; cy * chunkSize < y0 + limitY; cy++) {
+                ChunkPtr chunk = terrain.getChunk(cx, cy);
+                int fromX = std::max(x0, cx * chunkSize);
+                int toX = std::min(x0 + limitX, (cx + 1) * chunkSize);
+                int fromY = std::max(y0, cy * chunkSize);
+                int toY = std::min(y0 + limitY, (cy + 1) * chunkSize);
+                for (int x = fromX; x < toX; x++) {
+                    for (int y = fromY; y < toY; y++) {
+                        elevations[(x - x0) * size + (y - y0)] = chunk->at(x - cx * chunkSize, y - cy * chunkSize);
+                    }
+                }
+            }
+        }
+    }
+    
+    int toLocal(int x, int y) const {
+        return (x - originX) * size + (y - originY);
+    }
+    
+    // Cost from (x, y) to each target within the bound window, +infinity for
+    // targets that cannot be reached without leaving it
+    std::vector<double> costsFrom(int x, int y, const std::vector<std::pair<int, int>>& targets) {
+        std::vector<int> locals;
+        locals.reserve(targets.size());
+        for (const auto& target : targets) {
+            locals.push_back(toLocal(target.first, target.second));
+        }
+        
+        std::vector<double> costs;
+        costs.reserve(targets.size());
+        if (!locals.empty()) {
+            run(toLocal(x, y), -1, locals);
+        }
+        for (int local : locals) {
+            costs.push_back(dist[local]);
+        }
+        return costs;
+    }
+    
+    // Append the cells of the cheapest path from (fromX, fromY) to (toX, toY)
+    // within the bound window to path, excluding the first cell. Returns
+    // false if there is no such path.
+    bool appendPath(int fromX, int fromY, int toX, int toY, std::vector<std::pair<int, int>>& path) {
+        int goal = toLocal(toX, toY);
+        run(toLocal(fromX, fromY), goal, std::vector<int>());
+        if (!closed[goal]) {
+            return false;
+        }
+        
+        size_t begin = path.size();
+        for (int cell = goal; parent[cell] != -1; cell = parent[cell]) {
+            path.push_back({originX + cell / size, originY + cell % size});
+        }
+        std::reverse(path.begin() + begin, path.end());
+        return true;
+    }
+};
+
+// Border graph of one cluster for HierarchicalPathFinder
+struct ClusterGraph {
+    // A step from a transition cell into the neighbouring cluster
+    struct Crossing {
+        int transition;   // Index into cells
+        int outsideX;     // Cell on the other side, a transition of the neighbour
+        int outsideY;
+        double cost;
+    };
+    
+    std::vector<std::pair<int, int>> cells;  // World coordinates of the transitions
+    std::vector<Crossing> crossings;
+    std::vector<double> costs;               // Cost within the cluster between each pair of cells
+    
+    int indexOf(int x, int y) const {
+        for (size_t i = 0; i < cells.size(); i++) {
+            if (cells[i].first == x && cells[i].second == y) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+};
+
+// Cluster graphs of one chunk, cached with the chunk and filled in lazily
+struct ChunkTransitions {
+    double elevationWeight;  // Weight the costs were computed for
+    mutable std::mutex mutex;
+    mutable std::vector<std::shared_ptr<const ClusterGraph>> clusters;
+};
+
+// Hierarchical A* (HPA*). Chunks are divided into square clusters, and
+// each cluster side into segments; every segment gets one transition, at
+// the free cell pair nearest its centre. Costs between the transitions of a
+// cluster are computed the first time a search reaches it and cached with
+// the chunk. A search runs A* over the transitions only, then refines each
+// abstract step with a search confined to one cluster. Last, the stretch
+// of path around each cluster crossing is searched again in a window two
+// clusters wide centred on it, so the path need not cross exactly at the
+// transitions. Paths still cost a few percent more than optimal, and the
+// first searches through a region pay for building its cluster graphs.
+class HierarchicalPathFinder {
+private:
+    struct NodeState {
+        double g;
+        long long parent;
+        bool closed;
+    };
+    
+    typedef std::pair<double, long long> OpenEntry;
+    
+    static const long long kStartNode = -2;
+    static const long long kGoalNode = -3;
+    static const int kMaxClusterSize = 64;
+    static const int kSegmentLength = 32;
+    
+    TerrainGenerator& terrain;
+    int chunkSize;
+    int clusterSize;
+    int clustersPerChunk;
+    double steepThreshold;
+    double elevationWeight;
+    WindowSearch local;
+    WindowSearch smoother;
+    int expansions;
+    SearchProgress* progress;
+    
+    long long encode(int x, int y) const {
+        return static_cast<long long>(x) * terrain.getHeight() + y;
+    }
+    
+    // Search the stretch of path around each cluster crossing again within
+    // a window two clusters wide centred on it. The window holds the old
+    // stretch, so the path never gets dearer.
+    void smooth(std::vector<std::pair<int, int>>& path) {
+        const int window = 2 * clusterSize;
+        for (size_t i = 1; i < path.size(); i++) {
+            if (path[i - 1].first / clusterSize == path[i].first / clusterSize &&
+                path[i - 1].second / clusterSize == path[i].second / clusterSize) {
+                continue;
+            }
+            if (cancelled()) {
+                return;
+            }
+            
+            int x0 = std::max(0, std::min(terrain.getWidth() - window, path[i].first - clusterSize));
+            int y0 = std::max(0, std::min(terrain.getHeight() - window, path[i].second - clusterSize));
+            auto inside = [&](const std::pair<int, int>& cell) {
+                return cell.first >= x0 && cell.first < x0 + window &&
+                       cell.second >= y0 && cell.second < y0 + window;
+            };
+            size_t first = i;
+            size_t last = i;
+            while (first > 0 && inside(path[first - 1])) {
+                first--;
+            }
+            while (last + 1 < path.size() && inside(path[last + 1])) {
+                last++;
+            }
+            
+            std::vector<std::pair<int, int>> stretch(1, path[first]);
+            smoother.bind(x0, y0);
+            if (!smoother.appendPath(path[first].first, path[first].second,
+                                     path[last].first, path[last].second, stretch)) {
+                continue;
+            }
+            path.erase(path.begin() + first, path.begin() + last + 1);
+            path.insert(path.begin() + first, stretch.begin(), stretch.end());
+            i = first + stretch.size() - 1;
+        }
+    }
+    
+    bool cancelled() const {
+        return progress && progress->isCancelled();
+    }
+    
+    // Add one transition per segment of a cluster side. (insideX, insideY)
+    // walks the side in steps of (stepX, stepY); (outX, outY) is the offset
+    // to the matching cell of the neighbour. Both clusters sharing a side
+    // pick the same cell pairs.
+    void addSide(ClusterGraph& graph, int insideX, int insideY, int stepX, int stepY, int length,
+                 int outX, int outY) {
+        for (int segment = 0; segment < length; segment += kSegmentLength) {
+            int segmentEnd = std::min(length, segment + kSegmentLength);
+            int centre = (segment + segmentEnd - 1) / 2;
+            
+            // Scan outwards from the centre for the nearest free pair
+            for (int offset = 0; offset <= kSegmentLength; offset++) {
+                int candidates[2] = {centre - offset, centre + offset + 1};
+                int chosen = -1;
+                for (int i : candidates) {
+                    if (i < segment || i >= segmentEnd) {
+                        continue;
+                    }
+                    int x = insideX + i * stepX;
+                    int y = insideY + i * stepY;
+                    if (terrain.getElevation(x, y) >= 0 && terrain.getElevation(x + outX, y + outY) >= 0) {
+                        chosen = i;
+                        break;
+                    }
+                }
+                if (chosen >= 0) {
+                    addCrossing(graph, insideX + chosen * stepX, insideY + chosen * stepY, outX, outY);
+                    break;
+                }
+            }
+        }
+    }
+    
+    void addCrossing(ClusterGraph& graph, int x, int y, int outX, int outY) {
+        int index = graph.indexOf(x, y);
+        if (index < 0) {
+            index = static_cast<int>(graph.cells.size());
+            graph.cells.push_back({x, y});
+        }
+        double cost = traversalCost(false, terrain.getElevation(x, y), terrain.getElevation(x + outX, y + outY),
+                                    steepThreshold, elevationWeight);
+        graph.crossings.push_back({index, x + outX, y + outY, cost});
+    }
+    
+    // Cluster graph of a cluster, or nullptr if the search was cancelled
+    // while building it
+    std::shared_ptr<const ClusterGraph> buildCluster(int clusterX, int clusterY) {
+        auto graph = std::make_shared<ClusterGraph>();
+        
+        int x0 = clusterX * clusterSize;
+        int y0 = clusterY * clusterSize;
+        int lengthX = std::min(clusterSize, terrain.getWidth() - x0);
+        int lengthY = std::min(clusterSize, terrain.getHeight() - y0);
+        
+        // Only full cluster sides can have a neighbour beyond them
+        if (x0 > 0) {
+            addSide(*graph, x0, y0, 0, 1, lengthY, -1, 0);
+        }
+        if (x0 + clusterSize < terrain.getWidth()) {
+            addSide(*graph, x0 + clusterSize - 1, y0, 0, 1, lengthY, 1, 0);
+        }
+        if (y0 > 0) {
+            addSide(*graph, x0, y0, 1, 0, lengthX, 0, -1);
+        }
+        if (y0 + clusterSize < terrain.getHeight()) {
+            addSide(*graph, x0, y0 + clusterSize - 1, 1, 0, lengthX, 0, 1);
+        }
+        
+        // Costs are symmetric, so each search only needs the later cells
+        size_t n = graph->cells.size();
+        graph->costs.assign(n * n, 0.0);
+        local.bind(x0, y0);
+        for (size_t i = 0; i + 1 < n; i++) {
+            if (cancelled()) {
+                return nullptr;
+            }
+            std::vector<std::pair<int, int>> targets(graph->cells.begin() + i + 1, graph->cells.end());
+            std::vector<double> costs = local.costsFrom(graph->cells[i].first, graph->cells[i].second, targets);
+            for (size_t j = i + 1; j < n; j++) {
+                graph->costs[i * n + j] = costs[j - i - 1];
+                graph->costs[j * n + i] = costs[j - i - 1];
+            }
+        }
+        
+        return graph;
+    }
+    
+    // Cluster graph for the cluster containing (x, y), or nullptr if the
+    // search was cancelled while building it
+    std::shared_ptr<const ClusterGraph> clusterAt(int x, int y) {
+        int clusterX = x / clusterSize;
+        int clusterY = y / clusterSize;
+        ChunkPtr chunk = terrain.getChunk(x / chunkSize, y / chunkSize);
+        
+        auto transitions = chunk->getAnnotation<ChunkTransitions>(CHUNK_ANNOTATION_TRANSITIONS);
+        if (!transitions || transitions->elevationWeight != elevationWeight) {
+            auto fresh = std::make_shared<ChunkTransitions>();
+            fresh->elevationWeight = elevationWeight;
+            fresh->clusters.resize(clustersPerChunk * clustersPerChunk);
+            chunk->setAnnotation<ChunkTransitions>(CHUNK_ANNOTATION_TRANSITIONS, fresh);
+            transitions = fresh;
+        }
+        
+        size_t slot = (clusterX % clustersPerChunk) * clustersPerChunk + clusterY % clustersPerChunk;
+        {
+            std::lock_guard<std::mutex> lock(transitions->mutex);
+            if (transitions->clusters[slot]) {
+                return transitions->clusters[slot];
+            }
+        }
+        
+        // Built outside the lock; if two searches race, both results are equal
+        auto graph = buildCluster(clusterX, clusterY);
+        if (!graph) {
+            return graph;
+        }
+        std::lock_guard<std::mutex> lock(transitions->mutex);
+        transitions->clusters[slot] = graph;
+        return graph;
+    }
+    
+    // Largest cluster size up to kMaxClusterSize that tiles a chunk exactly
+    static int chooseClusterSize(int chunkSize) {
+        for (int size = std::min(chunkSize, static_cast<int>(kMaxClusterSize)); size > 1; size--) {
+            if (chunkSize % size == 0) {
+                return size;
+            }
+        }
+        return chunkSize;
+    }
+
+public:
+    HierarchicalPathFinder(TerrainGenerator& terrain, double elevationWeight)
+        : terrain(terrain), chunkSize(terrain.getChunkSize()), clusterSize(chooseClusterSize(chunkSize)),
+          clustersPerChunk(chunkSize / clusterSize), steepThreshold(terrain.getMaxElevation() / 10.0),
+          elevationWeight(elevationWeight), local(terrain, clusterSize, elevationWeight),
+          smoother(terrain, 2 * clusterSize, elevationWeight), expansions(0), progress(nullptr) {}
+    
+    // Abstract nodes expanded by the last search
+    int getExpansions() const { return expansions; }
+    
+    // Stop early once progress is cancelled, checked per abstract node and
+    // between the searches of a cluster build (nullptr to stop checking).
+    // Partial paths are not reported. The caller keeps progress alive.
+    void setProgress(SearchProgress* newProgress) { progress = newProgress; }
+    
+    // Find a path from start to goal. Returns an empty vector if either end is
+    // an obstacle, no path exists, or maxIterations abstract expansions are
+    // exceeded (maxIterations <= 0 means unlimited). Cluster graphs assume
+    // the plain cost model, so under a clearance rule this is a plain A*
+    // search and maxIterations limits its expansions.
+    std::vector<std::pair<int, int>> findPath(int startX, int startY, int goalX, int goalY, int maxIterations) {
+        if (terrain.getPathClearance().active()) {
+            PathFinder pathfinder(terrain);
+            pathfinder.setProgress(progress);
+            std::vector<std::pair<int, int>> path = pathfinder.findPath(startX, startY, goalX, goalY,
+                                                                        elevationWeight, maxIterations);
+            expansions = pathfinder.getExpansions();
+            return path;
+        }
+        
+        std::vector<std::pair<int, int>> path;
+        expansions = 0;
+        PathSearchRecorder recorder(terrain, expansions);
+        if (terrain.getElevation(startX, startY) < 0 || terrain.getElevation(goalX, goalY) < 0) {
+            return path;
+        }
+        
+        int goalClusterX = goalX / clusterSize;
+        int goalClusterY = goalY / clusterSize;
+        bool sameCluster = startX / clusterSize == goalClusterX && startY / clusterSize == goalClusterY;
+        
+        // Connect the start and goal to the transitions of their clusters
+        auto startGraph = clusterAt(startX, startY);
+        auto goalGraph = clusterAt(goalX, goalY);
+        if (!startGraph || !goalGraph) {
+            return path;
+        }
+        
+        std::vector<std::pair<int, int>> startTargets = startGraph->cells;
+        if (sameCluster) {
+            startTargets.push_back({goalX, goalY});
+        }
+        local.bind(startX / clusterSize * clusterSize, startY / clusterSize * clusterSize);
+        std::vector<double> startCosts = local.costsFrom(startX, startY, startTargets);
+        local.bind(goalClusterX * clusterSize, goalClusterY * clusterSize);
+        std::vector<double> goalCosts = local.costsFrom(goalX, goalY, goalGraph->cells);
+        
+        // A* over the abstract graph. Every step costs at least its octile
+        // length, and the weighted elevation changes along a path add up
+        // to at least the weighted difference between its ends.
+        const float goalElevation = terrain.getElevation(goalX, goalY);
+        auto heuristic = [&](int x, int y) {
+            return SearchHeuristic::octile(x - goalX, y - goalY) +
+                   std::abs(terrain.getElevation(x, y) - goalElevation) * elevationWeight;
+        };
+        
+        std::unordered_map<long long, NodeState> states;
+        std::unordered_map<long long, std::pair<int, int>> cellOf;
+        std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openSet;
+        const double unreachable = std::numeric_limits<double>::infinity();
+        
+        auto relax = [&](long long node, int x, int y, double g, long long parent) {
+            auto it = states.find(node);
+            if (it == states.end()) {
+                states.emplace(node, NodeState{g, parent, false});
+                cellOf[node] = {x, y};
+            } else if (!it->second.closed && g < it->second.g) {
+                it->second.g = g;
+                it->second.parent = parent;
+            } else {
+                return;
+            }
+            openSet.push({g + heuristic(x, y), node});
+        };
+        
+        states[kStartNode] = {0.0, -1, false};
+        cellOf[kStartNode] = {startX, startY};
+        openSet.push({heuristic(startX, startY), kStartNode});
+        
+        bool found = false;
+        
+        while (!openSet.empty()) {
+            long long node = openSet.top().second;
+            openSet.pop();
+            
+            NodeState& state = states[node];
+            if (state.closed) {
+                continue;
+            }
+            state.closed = true;
+            double g = state.g;
+            
+            if (node == kGoalNode) {
+                found = true;
+                break;
+            }
+            
+            if ((maxIterations > 0 && expansions >= maxIterations) || cancelled()) {
+                break;
+            }
+            expansions++;
+            
+            if (node == kStartNode) {
+                for (size_t i = 0; i < startGraph->cells.size(); i++) {
+                    const auto& cell = startGraph->cells[i];
+                    if (startCosts[i] < unreachable) {
+                        relax(encode(cell.first, cell.second), cell.first, cell.second, g + startCosts[i], node);
+                    }
+                }
+                if (sameCluster && startCosts.back() < unreachable) {
+                    relax(kGoalNode, goalX, goalY, g + startCosts.back(), node);
+                }
+                continue;
+            }
+            
+            std::pair<int, int> cell = cellOf[node];
+            auto graph = clusterAt(cell.first, cell.second);
+            if (!graph) {
+                break;  // Cancelled
+            }
+            int index = graph->indexOf(cell.first, cell.second);
+            if (index < 0) {
+                continue;
+            }
+            size_t n = graph->cells.size();
+            
+            for (size_t j = 0; j < n; j++) {
+                double cost = graph->costs[index * n + j];
+                if (static_cast<int>(j) != index && cost < unreachable) {
+                    const auto& other = graph->cells[j];
+                    relax(encode(other.first, other.second), other.first, other.second, g + cost, node);
+                }
+            }
+            
+            for (const auto& crossing : graph->crossings) {
+                if (crossing.transition == index) {
+                    relax(encode(crossing.outsideX, crossing.outsideY), crossing.outsideX, crossing.outsideY,
+                          g + crossing.cost, node);
+                }
+            }
+            
+            if (cell.first / clusterSize == goalClusterX && cell.second / clusterSize == goalClusterY &&
+                goalCosts[index] < unreachable) {
+                relax(kGoalNode, goalX, goalY, g + goalCosts[index], node);
+            }
+        }
+        
+        if (!found) {
+            return path;
+        }
+        
+        std::vector<std::pair<int, int>> waypoints;
+        for (long long node = kGoalNode; node != -1; node = states[node].parent) {
+            waypoints.push_back(cellOf[node]);
+        }
+        std::reverse(waypoints.begin(), waypoints.end());
+        
+        // Refine: steps within a cluster are searched locally, crossings are
+        // single steps
+        path.push_back(waypoints.front());
+        for (size_t i = 1; i < waypoints.size(); i++) {
+            const auto& from = waypoints[i - 1];
+            const auto& to = waypoints[i];
+            int clusterX = from.first / clusterSize;
+            int clusterY = from.second / clusterSize;
+            
+            if (clusterX == to.first / clusterSize && clusterY == to.second / clusterSize) {
+                local.bind(clusterX * clusterSize, clusterY * clusterSize);
+                if (cancelled() || !local.appendPath(from.first, from.second, to.first, to.second, path)) {
+                    path.clear();
+                    return path;
+                }
+            } else {
+                path.push_back(to);
+            }
+        }
+        
+        smooth(path);
+        return path;
+    }
+};
+
+const long long HierarchicalPathFinder::kStartNode;
+const long long HierarchicalPathFinder::kGoalNode;
+
+// D* Lite: an incremental search from the goal back towards the start that
+// keeps its state between queries. Moving the start and changing cells only
+// repairs the part of the search they affect, so replanning while following
+// a path costs a fraction of a fresh search. Not thread safe; the terrain
+// must outlive the planner.
+class IncrementalPathFinder {
+private:
+    struct NodeState {
+        double g;    // Settled cost to the goal
+        double rhs;  // One-step lookahead cost; differs from g while queued
+    };
+    
+    struct Key {
+        double primary;
+        double secondary;
+        
+        bool operator<(const Key& other) const {
+            return primary < other.primary ||
+                   (primary == other.primary && secondary < other.secondary);
+        }
+    };
+    
+    struct QueueEntry {
+        Key key;
+        long long node;
+        
+        bool operator>(const QueueEntry& other) const {
+            return other.key < key;
+        }
+    };
+    
+    TerrainGenerator& terrain;
+    EdgeCostReader edges;
+    
+    int goalX;
+    int goalY;
+    int startX;
+    int startY;
+    bool hasGoal;
+    bool initialized;  // The search has been seeded from the current goal
+    
+    // Sum of heuristic distances the start has moved, keeping old queue keys
+    // valid lower bounds without reordering the queue
+    double keyModifier;
+    uint64_t changeSequence;
+    int expansions;
+    bool searching;  // The last replan ran out of expansions or was cancelled
+    SearchProgress* progress;
+    
+    std::unordered_map<long long, NodeState> states;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open;
+    
+    static double infinity() {
+        return std::numeric_limits<double>::infinity();
+    }
+    
+    long long encode(int x, int y) const {
+        return static_cast<long long>(x) * terrain.getHeight() + y;
+    }
+    
+    // Octile distance to the start; a consistent lower bound on path cost
+    double heuristic(int x, int y) const {
+        return SearchHeuristic::octile(x - startX, y - startY);
+    }
+    
+    Key keyOf(int x, int y, const NodeState& state) const {
+        double best = std::min(state.g, state.rhs);
+        return {best + heuristic(x, y) + keyModifier, best};
+    }
+    
+    void enqueue(long long node, const NodeState& state) {
+        int height = terrain.getHeight();
+        int x = static_cast<int>(node / height);
+        int y = static_cast<int>(node % height);
+        open.push({keyOf(x, y, state), node});
+    }
+    
+    // Recompute rhs of a cell from its neighbours' costs to the goal and
+    // queue it if that leaves it inconsistent
+    void updateVertex(long long node) {
+        int height = terrain.getHeight();
+        int x = static_cast<int>(node / height);
+        int y = static_cast<int>(node % height);
+        
+        double best = infinity();
+        if (x == goalX && y == goalY) {
+            best = edges.fits(x, y) ? 0.0 : infinity();
+        } else {
+            double costs[8];
+            edges.stepCosts(x, y, costs);
+            for (int d = 0; d < 8; d++) {
+                if (std::isinf(costs[d])) {
+                    continue;
+                }
+                auto it = states.find(encode(x + kStepDirections[d][0], y + kStepDirections[d][1]));
+                if (it == states.end() || it->second.g == infinity()) {
+                    continue;
+                }
+                best = std::min(best, costs[d] + it->second.g);
+            }
+        }
+        
+        auto it = states.find(node);
+        if (it == states.end()) {
+            if (best == infinity()) {
+                return;  // Unreached and still unreachable
+            }
+            it = states.emplace(node, NodeState{infinity(), best}).first;
+        }
+        it->second.rhs = best;
+        if (it->second.g != it->second.rhs) {
+            enqueue(node, it->second);
+        }
+    }
+    
+    // Seed a fresh search from the goal
+    void initialize() {
+        states.clear();
+        open = decltype(open)();
+        keyModifier = 0.0;
+        
+        // Searches around obstacles settle up to about twice the box
+        // between the ends. Room for that up front keeps a search spread
+        // over capped replans from stalling one of them rehashing.
+        const size_t span = static_cast<size_t>(std::abs(startX - goalX) + 1) * (std::abs(startY - goalY) + 1);
+        states.reserve(std::min<size_t>(2 * span, size_t(1) << 22));
+        initialized = true;
+        updateVertex(encode(goalX, goalY));
+    }
+    
+    // Recompute every cell whose edges touch the rectangle, or whose
+    // clearance it can change
+    void repair(int x0, int y0, int w, int h) {
+        const int reach = edges.reach();
+        int x1 = std::min(x0 + w + reach, terrain.getWidth());
+        int y1 = std::min(y0 + h + reach, terrain.getHeight());
+        x0 = std::max(x0 - reach, 0);
+        y0 = std::max(y0 - reach, 0);
+        if (x0 >= x1 || y0 >= y1) {
+            return;
+        }
+        
+        for (int x = x0; x < x1; x++) {
+            for (int y = y0; y < y1; y++) {
+                updateVertex(encode(x, y));
+            }
+        }
+    }
+    
+    // Settle cells until the start is consistent and nothing queued could
+    // improve it. Returns false if maxIterations expansions ran out first;
+    // the search then resumes on the next call.
+    bool computeShortestPath(int maxIterations) {
+        const int height = terrain.getHeight();
+        const long long startNode = encode(startX, startY);
+        
+        while (!open.empty()) {
+            NodeState start = {infinity(), infinity()};
+            auto startIt = states.find(startNode);
+            if (startIt != states.end()) {
+                start = startIt->second;
+            }
+            
+            QueueEntry top = open.top();
+            if (!(top.key < keyOf(startX, startY, start)) && start.g == start.rhs) {
+                break;
+            }
+            if (maxIterations > 0 && expansions >= maxIterations) {
+                return false;
+            }
+            if (progress && expansions % SearchProgress::kPublishInterval == 0 && progress->isCancelled()) {
+                return false;
+            }
+            open.pop();
+            
+            NodeState& state = states[top.node];
+            if (state.g == state.rhs) {
+                continue;  // Stale entry for a cell that is consistent again
+            }
+            
+            int x = static_cast<int>(top.node / height);
+            int y = static_cast<int>(top.node % height);
+            Key current = keyOf(x, y, state);
+            if (top.key < current) {
+                open.push({current, top.node});  // Key grew as the start moved
+                continue;
+            }
+            
+            expansions++;
+            
+            if (state.g > state.rhs) {
+                // Cost improved: neighbours may now reach the goal through here
+                state.g = state.rhs;
+                double costs[8];
+                edges.stepCosts(x, y, costs);
+                for (int d = 0; d < 8; d++) {
+                    int nx = x + kStepDirections[d][0];
+                    int ny = y + kStepDirections[d][1];
+                    double cost = costs[d];
+                    if (std::isinf(cost) || (nx == goalX && ny == goalY)) {
+                        continue;
+                    }
+                    long long neighbor = encode(nx, ny);
+                    auto it = states.find(neighbor);
+                    if (it == states.end()) {
+                        it = states.emplace(neighbor, NodeState{infinity(), infinity()}).first;
+                    }
+                    if (state.g + cost < it->second.rhs) {
+                        it->second.rhs = state.g + cost;
+                        enqueue(neighbor, it->second);
+                    }
+                }
+            } else {
+                // Cost got worse: this cell and every neighbour that may have
+                // relied on it are recomputed
+                state.g = infinity();
+                updateVertex(top.node);
+                for (const auto& dir : kStepDirections) {
+                    long long neighbor = encode(x + dir[0], y + dir[1]);
+                    if (x + dir[0] >= 0 && x + dir[0] < terrain.getWidth() &&
+                        y + dir[1] >= 0 && y + dir[1] < height && states.count(neighbor)) {
+                        updateVertex(neighbor);
+                    }
+                }
+            }
+        }
+        
+        return true;
+    }
+
+public:
+    IncrementalPathFinder(TerrainGenerator& terrain, double elevationWeight)
+        : terrain(terrain), edges(terrain, elevationWeight), goalX(0), goalY(0),
+          startX(0), startY(0), hasGoal(false), initialized(false), keyModifier(0.0),
+          changeSequence(0), expansions(0), searching(false), progress(nullptr) {}
+    
+    // Stop replans early once progress is cancelled (nullptr to stop
+    // checking); the search resumes on the next replan. Partial paths are
+    // not reported. The caller keeps progress alive.
+    void setProgress(SearchProgress* newProgress) { progress = newProgress; }
+    
+    // Plan towards a new goal; the search state is discarded
+    void setGoal(int x, int y) {
+        goalX = x;
+        goalY = y;
+        hasGoal = true;
+        initialized = false;
+        states.clear();
+        open = decltype(open)();
+    }
+    
+    // Cells in the rectangle changed; repaired on the next replan. Changes
+    // made through the terrain are picked up without this.
+    void notifyCellsChanged(int x0, int y0, int w, int h) {
+        if (initialized) {
+            edges.reset();
+            repair(x0, y0, w, h);
+        }
+    }
+    
+    // Path from (x, y) to the goal, reusing the previous search. Terrain
+    // changes recorded since the last call are repaired first. Returns an
+    // empty vector if no path exists or maxIterations expansions (<= 0 means
+    // unlimited) were not enough; a later call continues the search.
+    std::vector<std::pair<int, int>> replan(int x, int y, int maxIterations) {
+        std::vector<std::pair<int, int>> path;
+        expansions = 0;
+        searching = false;
+        PathSearchRecorder recorder(terrain, expansions);
+        edges.reset();  // Chunks may have been evicted and regenerated
+        if (!hasGoal) {
+            return path;
+        }
+        
+        if (initialized) {
+            keyModifier += heuristic(x, y);
+        }
+        startX = x;
+        startY = y;
+        
+        std::vector<TerrainChange> changed;
+        uint64_t latest = 0;
+        bool complete = terrain.getChangesSince(changeSequence, changed, latest);
+        changeSequence = latest;
+        if (!initialized || !complete) {
+            initialize();
+        } else {
+            for (const TerrainChange& change : changed) {
+                repair(change.x0, change.y0, change.width, change.height);
+            }
+        }
+        
+        if (!edges.fits(startX, startY)) {
+            return path;
+        }
+        if (!computeShortestPath(maxIterations)) {
+            searching = true;
+            return path;
+        }
+        
+        auto startIt = states.find(encode(startX, startY));
+        if (startIt == states.end() || startIt->second.g == infinity()) {
+            return path;
+        }
+        
+        // Descend the cost-to-goal field from the start
+        int cx = startX;
+        int cy = startY;
+        path.push_back({cx, cy});
+        while (cx != goalX || cy != goalY) {
+            double best = infinity();
+            int bestX = cx;
+            int bestY = cy;
+            double costs[8];
+            edges.stepCosts(cx, cy, costs);
+            for (int d = 0; d < 8; d++) {
+                double cost = costs[d];
+                if (std::isinf(cost)) {
+                    continue;
+                }
+                int nx = cx + kStepDirections[d][0];
+                int ny = cy + kStepDirections[d][1];
+                auto it = states.find(encode(nx, ny));
+                if (it == states.end()) {
+                    continue;
+                }
+                if (cost + it->second.g < best) {
+                    best = cost + it->second.g;
+                    bestX = nx;
+                    bestY = ny;
+                }
+            }
+            
+            // A cycle can only come from an inconsistent field; give up
+            if (best == infinity() || path.size() > states.size()) {
+                path.clear();
+                return path;
+            }
+            cx = bestX;
+            cy = bestY;
+            path.push_back({cx, cy});
+        }
+        
+        return path;
+    }
+    
+    // Cells expanded by the last replan
+    int getExpansions() const { return expansions; }
+    
+    // Whether the last replan returned no path only because it ran out of
+    // expansions or was cancelled
+    bool isSearching() const { return searching; }
+};
+
+// Runs batches of path queries concurrently on the terrain's worker pool.
+// Each worker searches with its own thread-local SearchArena over the
+// shared chunk cache, so the terrain must not be edited during a batch.
+// With goal sharing, A* queries towards the same goal with the same weight
+// are answered together by one Dijkstra search outward from the goal, which
+// stops once every start is settled and gives exact shortest paths.
+class BatchPathFinder {
+private:
+    typedef std::chrono::steady_clock Clock;
+    
+    TerrainGenerator& terrain;
+    
+    static double elapsedMs(Clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    }
+    
+    double pathCost(const std::vector<std::pair<int, int>>& path, double elevationWeight) {
+        const double steepThreshold = terrain.getMaxElevation() / 10.0;
+        const ClearanceRule& clearance = terrain.getPathClearance();
+        EdgeCostReader edges(terrain, elevationWeight);
+        double cost = 0.0;
+        for (size_t i = 1; i < path.size(); i++) {
+            bool diagonal = path[i].first != path[i - 1].first && path[i].second != path[i - 1].second;
+            cost += traversalCost(diagonal, terrain.getElevation(path[i - 1].first, path[i - 1].second),
+                                  terrain.getElevation(path[i].first, path[i].second),
+                                  steepThreshold, elevationWeight);
+            if (clearance.active()) {
+                double penalty = clearance.penalty(edges.clearanceAt(path[i - 1].first, path[i - 1].second))
+                               + clearance.penalty(edges.clearanceAt(path[i].first, path[i].second));
+                cost += 0.5 * penalty * (diagonal ? 1.4 : 1.0);
+            }
+        }
+        return cost;
+    }
+    
+    void store(const std::vector<std::pair<int, int>>& path, double elevationWeight, PathResult& result) {
+        result.length = static_cast<int>(path.size());
+        result.cost = pathCost(path, elevationWeight);
+        if (result.path) {
+            int count = std::min(result.length, result.capacity);
+            for (int i = 0; i < count; i++) {
+                result.path[2 * i] = path[i].first;
+                result.path[2 * i + 1] = path[i].second;
+            }
+        }
+    }
+    
+    void runSingle(const PathQuery& query, PathResult& result) {
+        Clock::time_point started = Clock::now();
+        std::vector<std::pair<int, int>> path;
+        
+        if (query.algorithm == PATH_ALGORITHM_HIERARCHICAL) {
+            HierarchicalPathFinder pathfinder(terrain, query.elevationWeight);
+            path = pathfinder.findPath(query.startX, query.startY, query.goalX, query.goalY, query.maxIterations);
+            result.expansions = pathfinder.getExpansions();
+        } else if (query.algorithm == PATH_ALGORITHM_JUMP_POINT) {
+            JumpPointPathFinder pathfinder(terrain, query.elevationWeight, query.jumpTolerance);
+            path = pathfinder.findPath(query.startX, query.startY, query.goalX, query.goalY, query.maxIterations);
+            result.expansions = pathfinder.getExpansions();
+        } else {
+            PathFinder pathfinder(terrain);
+            path = pathfinder.findPath(query.startX, query.startY, query.goalX, query.goalY,
+                                       query.elevationWeight, query.maxIterations);
+            result.expansions = pathfinder.getExpansions();
+        }
+        
+        store(path, query.elevationWeight, result);
+        result.latencyMs = elapsedMs(started);
+    }
+    
+    // Answer queries sharing a goal and weight from one backward Dijkstra
+    // field. It expands at most the largest maxIterations of the group, or
+    // without limit if any query has none.
+    void runShared(const PathQuery* queries, const std::vector<int>& group, PathResult* results) {
+        Clock::time_point started = Clock::now();
+        const PathQuery& first = queries[group.front()];
+        EdgeCostReader edges(terrain, first.elevationWeight);
+        
+        int maxIterations = 0;
+        for (int index : group) {
+            if (queries[index].maxIterations <= 0) {
+                maxIterations = 0;
+                break;
+            }
+            maxIterations = std::max(maxIterations, queries[index].maxIterations);
+        }
+        
+        SearchArena& arena = SearchArena::forThisThread();
+        arena.reset(terrain.getWidth(), terrain.getHeight());
+        
+        // Starts still waiting to be settled, counted once per query
+        std::unordered_map<SearchArena::Node, int> waiting;
+        int remaining = 0;
+        if (edges.fits(first.goalX, first.goalY)) {
+            for (int index : group) {
+                const PathQuery& query = queries[index];
+                if (edges.fits(query.startX, query.startY)) {
+                    waiting[arena.node(query.startX, query.startY)]++;
+                    remaining++;
+                }
+            }
+        }
+        
+        int expansions = 0;
+        PathSearchRecorder recorder(terrain, expansions);
+        if (remaining > 0) {
+            SearchArena::Node goalNode = arena.node(first.goalX, first.goalY);
+            arena.g(goalNode) = 0.0;
+            arena.push(goalNode, 0.0);
+        }
+        
+        while (remaining > 0 && !arena.empty()) {
+            SearchArena::Node current = arena.pop();
+            auto it = waiting.find(current);
+            if (it != waiting.end()) {
+                remaining -= it->second;
+                if (remaining == 0) {
+                    break;
+                }
+            }
+            
+            if (maxIterations > 0 && expansions >= maxIterations) {
+                break;
+            }
+            expansions++;
+            
+            int cx = arena.x(current);
+            int cy = arena.y(current);
+            double currentG = arena.g(current);
+            double costs[8];
+            edges.stepCosts(cx, cy, costs);
+            
+            for (int d = 0; d < 8; d++) {
+                // Steps cost the same in both directions
+                double cost = costs[d];
+                if (std::isinf(cost)) {
+                    continue;
+                }
+                
+                SearchArena::Node neighbor = arena.node(cx + kStepDirections[d][0], cy + kStepDirections[d][1]);
+                if (arena.closed(neighbor)) {
+                    continue;
+                }
+                
+                double tentativeG = currentG + cost;
+                if (tentativeG < arena.g(neighbor)) {
+                    arena.g(neighbor) = tentativeG;
+                    arena.parent(neighbor) = current;
+                    arena.push(neighbor, tentativeG);
+                }
+            }
+        }
+        
+        // Parents point towards the goal, so each path reads off in order
+        std::vector<std::pair<int, int>> path;
+        for (int index : group) {
+            const PathQuery& query = queries[index];
+            PathResult& result = results[index];
+            result.expansions = expansions;
+            result.sharedField = 1;
+            
+            path.clear();
+            if (edges.elevationAt(query.startX, query.startY) >= 0) {
+                SearchArena::Node node = arena.node(query.startX, query.startY);
+                if (arena.closed(node)) {
+                    for (; node != SearchArena::kNoNode; node = arena.parent(node)) {
+                        path.push_back({arena.x(node), arena.y(node)});
+                    }
+                }
+            }
+            
+            store(path, query.elevationWeight, result);
+            result.latencyMs = elapsedMs(started);
+        }
+    }
+
+public:
+    explicit BatchPathFinder(TerrainGenerator& terrain) : terrain(terrain) {}
+    
+    void run(const PathQuery* queries, int n, PathResult* results, bool shareGoals) {
+        for (int i = 0; i < n; i++) {
+            results[i].length = 0;
+            results[i].expansions = 0;
+            results[i].cost = 0.0;
+            results[i].latencyMs = 0.0;
+            results[i].sharedField = 0;
+        }
+        
+        // Group A* queries by goal and weight; every other query runs alone
+        std::vector<std::vector<int>> jobs;
+        std::map<std::tuple<int, int, double>, size_t> groupOf;
+        for (int i = 0; i < n; i++) {
+            const PathQuery& query = queries[i];
+            if (!shareGoals || query.algorithm != PATH_ALGORITHM_ASTAR) {
+                jobs.push_back({i});
+                continue;
+            }
+            auto key = std::make_tuple(query.goalX, query.goalY, query.elevationWeight);
+            auto it = groupOf.find(key);
+            if (it == groupOf.end()) {
+                groupOf[key] = jobs.size();
+                jobs.push_back({i});
+            } else {
+                jobs[it->second].push_back(i);
+            }
+        }
+        
+        // Largest groups first, so they do not finish last
+        std::stable_sort(jobs.begin(), jobs.end(), [](const std::vector<int>& a, const std::vector<int>& b) {
+            return a.size() > b.size();
+        });
+        
+        terrain.parallelFor(static_cast<int>(jobs.size()), [&](int i) {
+            const std::vector<int>& job = jobs[i];
+            if (job.size() > 1) {
+                runShared(queries, job, results);
+            } else {
+                runSingle(queries[job.front()], results[job.front()]);
+            }
+        });
+    }
+};
+
+// State of an asynchronous plan, as reported by terrain_plan_poll
+enum PlanStatus {
+    PLAN_STATUS_UNKNOWN = -1,  // No such ticket, or it was cancelled
+    PLAN_STATUS_QUEUED = 0,    // Waiting for the planner thread
+    PLAN_STATUS_RUNNING = 1,   // Searching; the path is the best partial one so far
+    PLAN_STATUS_DONE = 2,      // Finished with a full path
+    PLAN_STATUS_FAILED = 3     // Finished without a path
+};
+
+// Plans paths on a dedicated thread, started on first use, so callers never
+// block on a search. Plans run one at a time in submission order. While an
+// A* plan runs, polls return its best partial path so far, from the start to
+// the expanded cell closest to the goal, and anytime plans return each
+// improved path as soon as it is found; other algorithms only report their
+// final path. Replan plans run D* Lite with one planner kept on the thread,
+// so consecutive replans towards the same goal repair the previous search.
+// Cancelling stops a plan of any algorithm at its next check.
+// The terrain must not be edited while a plan runs.
+class AsyncPathPlanner {
+private:
+    struct Plan {
+        int algorithm;
+        int startX;
+        int startY;
+        int goalX;
+        int goalY;
+        double elevationWeight;
+        double jumpTolerance;
+        int maxIterations;
+        bool anytime;             // Search with AnytimePathFinder under schedule
+        AnytimeSchedule schedule;
+        bool replan;              // Search with the thread's IncrementalPathFinder
+        
+        PlanStatus status;                       // Guarded by the planner mutex
+        std::vector<std::pair<int, int>> path;   // Final path, once finished
+        double bound;                            // Its suboptimality bound, for anytime plans
+        SearchProgress progress;
+    };
+    
+    TerrainGenerator& terrain;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<uint64_t> queue;
+    std::unordered_map<uint64_t, std::shared_ptr<Plan>> plans;
+    uint64_t nextTicket;
+    bool stopping;
+    
+    // Incremental planner of replan plans, only used by the worker. It is
+    // kept while replans head for the same goal with the same weight.
+    std::unique_ptr<IncrementalPathFinder> replanner;
+    int replanGoalX;
+    int replanGoalY;
+    double replanWeight;
+    
+    std::vector<std::pair<int, int>> search(Plan& plan, double& bound) {
+        bound = 0.0;
+        if (plan.replan) {
+            if (!replanner || replanGoalX != plan.goalX || replanGoalY != plan.goalY ||
+                replanWeight != plan.elevationWeight) {
+                replanner.reset(new IncrementalPathFinder(terrain, plan.elevationWeight));
+                replanner->setGoal(plan.goalX, plan.goalY);
+                replanGoalX = plan.goalX;
+                replanGoalY = plan.goalY;
+                replanWeight = plan.elevationWeight;
+            }
+            replanner->setProgress(&plan.progress);
+            std::vector<std::pair<int, int>> path = replanner->replan(plan.startX, plan.startY,
+                                                                      plan.maxIterations);
+            replanner->setProgress(nullptr);
+            return path;
+        }
+        if (plan.anytime) {
+            AnytimePathFinder pathfinder(terrain);
+            pathfinder.setProgress(&plan.progress);
+            std::vector<std::pair<int, int>> path = pathfinder.findPath(
+                plan.startX, plan.startY, plan.goalX, plan.goalY, plan.elevationWeight, plan.schedule,
+                plan.maxIterations);
+            bound = pathfinder.getBound();
+            return path;
+        }
+        if (plan.algorithm == PATH_ALGORITHM_HIERARCHICAL) {
+            HierarchicalPathFinder pathfinder(terrain, plan.elevationWeight);
+            pathfinder.setProgress(&plan.progress);
+            return pathfinder.findPath(plan.startX, plan.startY, plan.goalX, plan.goalY, plan.maxIterations);
+        }
+        if (plan.algorithm == PATH_ALGORITHM_JUMP_POINT) {
+            JumpPointPathFinder pathfinder(terrain, plan.elevationWeight, plan.jumpTolerance);
+            pathfinder.setProgress(&plan.progress);
+            return pathfinder.findPath(plan.startX, plan.startY, plan.goalX, plan.goalY, plan.maxIterations);
+        }
+        
+        PathFinder pathfinder(terrain);
+        pathfinder.setProgress(&plan.progress);
+        return pathfinder.findPath(plan.startX, plan.startY, plan.goalX, plan.goalY, plan.elevationWeight,
+                                   plan.maxIterations);
+    }
+    
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            changed.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return;
+            }
+            
+            uint64_t ticket = queue.front();
+            queue.pop_front();
+            auto it = plans.find(ticket);
+            if (it == plans.end()) {
+                continue;  // Cancelled while queued
+            }
+            
+            std::shared_ptr<Plan> plan = it->second;
+            plan->status = PLAN_STATUS_RUNNING;
+            lock.unlock();
+            double bound;
+            std::vector<std::pair<int, int>> path = search(*plan, bound);
+            lock.lock();
+            
+            plan->path.swap(path);
+            plan->bound = bound;
+            plan->status = plan->path.empty() ? PLAN_STATUS_FAILED : PLAN_STATUS_DONE;
+        }
+    }
+
+public:
+    explicit AsyncPathPlanner(TerrainGenerator& terrain)
+        : terrain(terrain), nextTicket(0), stopping(false), replanGoalX(0), replanGoalY(0),
+          replanWeight(0.0) {}
+    
+    // Stops the running plan at its next progress check and drops the rest
+    ~AsyncPathPlanner() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            for (auto& entry : plans) {
+                entry.second->progress.cancel();
+            }
+        }
+        changed.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    
+    // Queue a plan and return its ticket, never 0. With schedule set the
+    // plan is an anytime search, and with replan set a D* Lite replan that
+    // repairs the previous replan's search; algorithm is then ignored.
+    uint64_t submit(int algorithm, int startX, int startY, int goalX, int goalY, double elevationWeight,
+                    double jumpTolerance, int maxIterations, const AnytimeSchedule* schedule = nullptr,
+                    bool replan = false) {
+        std::shared_ptr<Plan> plan = std::make_shared<Plan>();
+        plan->anytime = schedule != nullptr;
+        if (schedule) {
+            plan->schedule = *schedule;
+        }
+        plan->replan = replan && !schedule;
+        plan->bound = 0.0;
+        plan->algorithm = algorithm;
+        plan->startX = startX;
+        plan->startY = startY;
+        plan->goalX = goalX;
+        plan->goalY = goalY;
+        plan->elevationWeight = elevationWeight;
+        plan->jumpTolerance = jumpTolerance;
+        plan->maxIterations = maxIterations;
+        plan->status = PLAN_STATUS_QUEUED;
+        
+        uint64_t ticket;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ticket = ++nextTicket;
+            plans[ticket] = plan;
+            queue.push_back(ticket);
+            
+            if (!worker.joinable()) {
+                worker = std::thread(&AsyncPathPlanner::workerLoop, this);
+            }
+        }
+        changed.notify_all();
+        return ticket;
+    }
+    
+    // Copy the plan's current path into path: the final one once finished,
+    // the best partial one while running, and none while queued. bound
+    // receives the path's suboptimality bound for anytime plans (infinite
+    // for a partial path) and 0 otherwise.
+    PlanStatus poll(uint64_t ticket, std::vector<std::pair<int, int>>& path, double& bound) {
+        std::shared_ptr<Plan> plan;
+        PlanStatus status;
+        bound = 0.0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = plans.find(ticket);
+            if (it == plans.end()) {
+                path.clear();
+                return PLAN_STATUS_UNKNOWN;
+            }
+            plan = it->second;
+            status = plan->status;
+            path = plan->path;
+            bound = plan->bound;
+        }
+        
+        if (status == PLAN_STATUS_RUNNING) {
+            path = plan->progress.partialPath(&bound);
+            if (!plan->anytime) {
+                bound = 0.0;
+            }
+        }
+        return status;
+    }
+    
+    // Forget a plan, stopping it at its next progress check if it is running.
+    // Finished plans must be cancelled too, to release their paths.
+    void cancel(uint64_t ticket) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = plans.find(ticket);
+        if (it != plans.end()) {
+            it->second->progress.cancel();
+            plans.erase(it);
+        }
+    }
+};
+
+// Camera of a first-person view for terrain_render_view
+struct ViewCamera {
+    double x;              // World position
+    double y;
+    double eyeHeight;      // Eye elevation, in elevation units
+    double direction;      // Heading in radians, 0 = +x
+    double verticalAngle;  // Pitch in radians, positive looks up
+    double fov;            // Horizontal field of view in radians
+    double viewDistance;   // Farthest distance drawn, in cells
+    double heightScale;    // Cells of height drawn per elevation unit
+};
+
+// Voxel-space renderer of first-person views. Each screen column is a ray
+// marched front to back over the heightfield, filling the rows between the
+// highest row drawn so far and the terrain's projected height, so every
+// pixel is written once. Steps grow with distance and read the mip level
+// whose spacing matches them, keeping far terrain off full-resolution
+// chunks. Columns are shared out over the terrain's worker pool.
+class HeightfieldRaycaster {
+private:
+    // Reads samples of one mip level, reusing the last tile
+    class MipSampler {
+    private:
+        TerrainGenerator& terrain;
+        int level;
+        int tileX;
+        int tileY;
+        ChunkPtr tile;
+    
+    public:
+        explicit MipSampler(TerrainGenerator& terrain)
+            : terrain(terrain), level(-1), tileX(0), tileY(0) {}
+        
+        // Elevation of the level sample covering in-bounds point (x, y)
+        float sample(double x, double y, int sampleLevel) {
+            const int chunkSize = terrain.getChunkSize();
+            int sx = static_cast<int>(x) >> sampleLevel;
+            int sy = static_cast<int>(y) >> sampleLevel;
+            int tx = sx / chunkSize;
+            int ty = sy / chunkSize;
+            
+            if (!tile || sampleLevel != level || tx != tileX || ty != tileY) {
+                tile = sampleLevel == 0 ? terrain.getChunk(tx, ty) : terrain.getLodTile(sampleLevel, tx, ty);
+                level = sampleLevel;
+                tileX = tx;
+                tileY = ty;
+            }
+            return tile->at(sx - tx * chunkSize, sy - ty * chunkSize);
+        }
+    };
+    
+    // Surface colors by elevation band, matching TerrainColors in gui.py
+    static void baseColor(float elevation, double maxElevation, double rgb[3]) {
+        static const unsigned char palette[8][3] = {
+            {173, 139, 115}, {194, 162, 126}, {210, 180, 140}, {222, 192, 158},
+            {200, 170, 120}, {180, 150, 100}, {160, 130, 80}, {40, 40, 40}
+        };
+        static const double bounds[6] = {0.1, 0.25, 0.4, 0.6, 0.75, 0.9};
+        
+        int band = 7;
+        if (elevation >= 0) {
+            double normalized = elevation / maxElevation;
+            band = 0;
+            while (band < 6 && normalized >= bounds[band]) {
+                band++;
+            }
+        }
+        for (int c = 0; c < 3; c++) {
+            rgb[c] = palette[band][c];
+        }
+    }
+    
+    static void writePixel(unsigned char* out, const double rgb[3]) {
+        for (int c = 0; c < 3; c++) {
+            out[c] = static_cast<unsigned char>(std::max(0.0, std::min(255.0, rgb[c])));
+        }
+    }
+    
+    // Sky gradient and horizon colors, matching TerrainRenderer
+    static void skyColor(int row, double horizonRow, double rgb[3]) {
+        static const double sky[3] = {135, 206, 235};
+        static const double horizon[3] = {225, 225, 200};
+        double t = horizonRow > 0 ? std::max(0.0, std::min(1.0, row / horizonRow)) : 1.0;
+        for (int c = 0; c < 3; c++) {
+            rgb[c] = sky[c] * (1 - t) + horizon[c] * t;
+        }
+    }
+    
+    TerrainGenerator& terrain;
+
+public:
+    explicit HeightfieldRaycaster(TerrainGenerator& terrain) : terrain(terrain) {}
+    
+    // Render a width x height view into out as 8-bit RGB, column-major like
+    // chunk data: pixel (x, y) starts at out[(x * height + y) * 3].
+    void render(const ViewCamera& camera, int width, int height, unsigned char* out) {
+        if (width <= 0 || height <= 0) {
+            return;
+        }
+        
+        // View plane one unit ahead of the eye, spanning the field of view
+        const double halfWidth = std::tan(std::max(0.01, std::min(3.1, camera.fov)) / 2);
+        const double focal = (width / 2.0) / halfWidth;
+        const double forwardX = std::cos(camera.direction);
+        const double forwardY = std::sin(camera.direction);
+        const double rightX = -forwardY;
+        const double rightY = forwardX;
+        const double horizonRow = height / 2.0 + std::tan(camera.verticalAngle) * focal;
+        const double maxElevation = terrain.getMaxElevation();
+        const double viewDistance = std::max(1.0, camera.viewDistance);
+        
+        static const int kColumnsPerJob = 16;
+        const int jobs = (width + kColumnsPerJob - 1) / kColumnsPerJob;
+        
+        terrain.parallelFor(jobs, [&](int job) {
+            MipSampler sampler(terrain);
+            int end = std::min(width, (job + 1) * kColumnsPerJob);
+            
+            for (int column = job * kColumnsPerJob; column < end; column++) {
+                // Ray through the column's centre, scaled so that moving one
+                // unit along it advances one unit of depth
+                double offset = (2.0 * (column + 0.5) / width - 1.0) * halfWidth;
+                double rayX = forwardX + rightX * offset;
+                double rayY = forwardY + rightY * offset;
+                unsigned char* columnOut = out + static_cast<size_t>(column) * height * 3;
+                
+                // Rows at and below lowestRow are drawn
+                int lowestRow = height;
+                double rgb[3];
+                
+                // Obstacles are drawn dark at the height of the ground before them
+                double lastSurface = camera.eyeHeight;
+                
+                for (double depth = 1.0, step = 1.0; depth < viewDistance && lowestRow > 0; depth += step) {
+                    // One mip level per doubling of the step
+                    step = std::max(1.0, depth / 128.0);
+                    int level = 0;
+                    while (level < TerrainGenerator::getMaxLodLevel() && (2 << level) <= step) {
+                        level++;
+                    }
+                    
+                    double sampleX = camera.x + rayX * depth;
+                    double sampleY = camera.y + rayY * depth;
+                    if (sampleX < 0 || sampleY < 0 || sampleX >= terrain.getWidth() || sampleY >= terrain.getHeight()) {
+                        continue;  // Nothing past the world's edge
+                    }
+                    float elevation = sampler.sample(sampleX, sampleY, level);
+                    double surface = elevation < 0 ? lastSurface : elevation;
+                    lastSurface = surface;
+                    double projected = horizonRow + (camera.eyeHeight - surface) * camera.heightScale * focal / depth;
+                    int top = static_cast<int>(std::max(0.0, std::ceil(projected)));
+                    if (top >= lowestRow) {
+                        continue;
+                    }
+                    
+                    // Distance fog and shading by height relative to the eye
+                    baseColor(elevation, maxElevation, rgb);
+                    double shade = 1.0 - std::min(0.8, depth / viewDistance);
+                    double heightDiff = surface - camera.eyeHeight;
+                    if (heightDiff > 0) {
+                        shade *= std::min(1.2, 1.0 + heightDiff / 50);
+                    } else if (heightDiff < 0) {
+                        shade *= std::max(0.7, 1.0 + heightDiff / 30);
+                    }
+                    for (int c = 0; c < 3; c++) {
+                        rgb[c] *= shade;
+                    }
+                    
+                    for (int row = top; row < lowestRow; row++) {
+                        writePixel(columnOut + row * 3, rgb);
+                    }
+                    lowestRow = top;
+                }
+                
+                // Whatever the terrain left uncovered is sky
+                for (int row = 0; row < lowestRow; row++) {
+                    skyColor(row, horizonRow, rgb);
+                    writePixel(columnOut + row * 3, rgb);
+                }
+            }
+        });
+    }
+};
+
+// Find a path with the search algorithm selected by algorithm (see
+// PathAlgorithm) for the C API; tolerance only applies to jump point search
+static std::vector<std::pair<int, int>> findPathWith(TerrainGenerator& terrain, int algorithm, int startX,
+                                                     int startY, int goalX, int goalY, double elevationWeight,
+                                                     double tolerance, int maxIterations) {
+    if (algorithm == PATH_ALGORITHM_HIERARCHICAL) {
+        HierarchicalPathFinder pathfinder(terrain, elevationWeight);
+        return pathfinder.findPath(startX, startY, goalX, goalY, maxIterations);
+    }
+    if (algorithm == PATH_ALGORITHM_JUMP_POINT) {
+        JumpPointPathFinder pathfinder(terrain, elevationWeight, tolerance);
+        return pathfinder.findPath(startX, startY, goalX, goalY, maxIterations);
+    }
+    PathFinder pathfinder(terrain);
+    return pathfinder.findPath(startX, startY, goalX, goalY, elevationWeight, maxIterations);
+}
+
+// Write up to outLen (x, y) pairs of path into outBuf (may be NULL) and
+// return the full path length in points
+static int copyPath(const std::vector<std::pair<int, int>>& path, int* outBuf, int outLen) {
+    if (outBuf) {
+        int count = std::min(static_cast<int>(path.size()), outLen);
+        for (int i = 0; i < count; i++) {
+            outBuf[2 * i] = path[i].first;
+            outBuf[2 * i + 1] = path[i].second;
+        }
+    }
+    
+    return static_cast<int>(path.size());
+}
+
+extern "C" {
+    // Create and manage terrain generator instances
+    // cacheDir names a directory for the on-disk chunk store (NULL or empty
+    // to disable it)
+    TerrainGenerator* terrain_create(int width, int height, int maxElevation, int chunkSize, int seed,
+                                     const char* cacheDir) {
+        return new TerrainGenerator(width, height, maxElevation, chunkSize, seed, cacheDir ? cacheDir : "");
+    }
+    
+    void terrain_set_parameters(TerrainGenerator* terrain, double scale, int octaves, 
+                             double persistence, double lacunarity, double obstacleProb) {
+        if (terrain) {
+            terrain->setParameters(scale, octaves, persistence, lacunarity, obstacleProb);
+        }
+    }
+    
+    // Get and copy chunk data
+    void terrain_generate_chunk(TerrainGenerator* terrain, int chunkX, int chunkY, float* result) {
+        if (!terrain || !result) return;
+        
+        ChunkPtr chunk = terrain->getChunk(chunkX, chunkY);
+        chunk->decode(0, chunk->size(), result);
+    }
+    
+    // Borrow chunk data without copying. Returns a pointer to the cached
+    // chunkSize * chunkSize floats and stores a pin in *handle; the data stays
+    // valid until terrain_release_chunk is called, even if the chunk is unloaded.
+    // Quantized chunks have no float cells to borrow: returns NULL and leaves
+    // *handle NULL, so use terrain_generate_chunk instead.
+    const float* terrain_acquire_chunk(TerrainGenerator* terrain, int chunkX, int chunkY, void** handle) {
+        if (!terrain || !handle) return nullptr;
+        
+        ChunkPtr chunk = terrain->generateChunk(chunkX, chunkY);
+        if (!chunk->data()) {
+            *handle = nullptr;
+            return nullptr;
+        }
+        
+        ChunkPtr* pin = new ChunkPtr(chunk);
+        *handle = pin;
+        return (*pin)->data();
+    }
+    
+    void terrain_release_chunk(void* handle) {
+        delete static_cast<ChunkPtr*>(handle);
+    }
+    
+    float terrain_get_elevation(TerrainGenerator* terrain, int x, int y) {
+        if (!terrain) return -1.0f;
+        return terrain->getElevation(x, y);
+    }
+    
+    // Generate n chunks, given as interleaved (chunkX, chunkY) pairs, in parallel
+    void terrain_generate_chunks(TerrainGenerator* terrain, const int* coords, int n) {
+        if (!terrain || !coords) return;
+        terrain->generateChunks(coords, n);
+    }
+    
+    void terrain_set_thread_count(TerrainGenerator* terrain, int threadCount) {
+        if (terrain) {
+            terrain->setThreadCount(threadCount);
+        }
+    }
+    
+    void terrain_set_edge_cost_weight(TerrainGenerator* terrain, double elevationWeight) {
+        if (terrain) {
+            terrain->setEdgeCostWeight(elevationWeight);
+        }
+    }
+
+    // Select the A* heuristic (see PathHeuristic) and the landmarks per ALT table
+    void terrain_set_path_heuristic(TerrainGenerator* terrain, int heuristic, int landmarkCount) {
+        if (!terrain) return;
+        if (heuristic < PATH_HEURISTIC_MANHATTAN || heuristic > PATH_HEURISTIC_LANDMARKS) {
+            heuristic = PATH_HEURISTIC_OCTILE_CLIMB;
+        }
+        terrain->setPathHeuristic(static_cast<PathHeuristic>(heuristic), landmarkCount);
+    }
+
+    // Keep path searches requiredClearance cells from obstacles and steep
+    // cells, and charge weight per missing cell of clearance below
+    // preferredClearance (see ClearanceRule; 0 and 0 to stop). Jump point
+    // and hierarchical searches run as A* while a rule is set.
+    void terrain_set_path_clearance(TerrainGenerator* terrain, double requiredClearance,
+                                    double preferredClearance, double weight) {
+        if (!terrain) return;
+        terrain->setPathClearance(requiredClearance, preferredClearance, weight);
+    }
+    
+    // Build the clearance fields of n chunks, given as interleaved
+    // (chunkX, chunkY) pairs, in parallel ahead of the searches needing them
+    void terrain_prepare_clearance(TerrainGenerator* terrain, const int* coords, int n) {
+        if (!terrain || !coords || n <= 0) return;
+        ClearanceField::prepare(*terrain, coords, n);
+    }
+    
+    // Clearance of n world cells from obstacles and steep cells, in cells
+    // and capped at the clearance range; 0 outside the world
+    void terrain_get_clearances(TerrainGenerator* terrain, const int* xs, const int* ys, int n, float* out) {
+        if (!terrain || !xs || !ys || !out) return;
+        ClearanceField::sample(*terrain, xs, ys, n, out);
+    }
+    
+    // Load or build the landmark table for an elevation weight, which
+    // PATH_HEURISTIC_LANDMARKS searches need, and copy up to maxCount
+    // landmark positions into out as interleaved (x, y) pairs. Returns the
+    // number of landmarks, 0 if the world is too large to build a table for.
+    int terrain_prepare_landmarks(TerrainGenerator* terrain, double elevationWeight, int* out, int maxCount) {
+        if (!terrain) return 0;
+        auto table = LandmarkTable::prepare(*terrain, elevationWeight);
+        if (!table) return 0;
+        const auto& landmarks = table->getLandmarks();
+        for (int i = 0; out && i < maxCount && i < table->getCount(); i++) {
+            out[2 * i] = landmarks[i].first;
+            out[2 * i + 1] = landmarks[i].second;
+        }
+        return table->getCount();
+    }
+
+    // Select the noise kernel (see NoiseKernel); returns the kernel in use
+    int terrain_set_noise_kernel(TerrainGenerator* terrain, int kernel) {
+        if (!terrain) return NOISE_KERNEL_AUTO;
+        return terrain->setNoiseKernel(static_cast<NoiseKernel>(kernel));
+    }
+    
+    void terrain_get_elevations(TerrainGenerator* terrain, const int* xs, const int* ys, int n, float* out) {
+        if (!terrain || !xs || !ys || !out) return;
+        terrain->getElevations(xs, ys, n, out);
+    }
+    
+    void terrain_get_obstacles(TerrainGenerator* terrain, const int* xs, const int* ys, int n, unsigned char* out) {
+        if (!terrain || !xs || !ys || !out) return;
+        terrain->getObstacles(xs, ys, n, out);
+    }
+    
+    void terrain_get_region(TerrainGenerator* terrain, int x0, int y0, int w, int h, int step, float* out) {
+        if (!terrain || !out) return;
+        terrain->getRegion(x0, y0, w, h, step, out);
+    }
+    
+    // Render a first-person view of the terrain into a width x height RGB
+    // buffer, column-major; see HeightfieldRaycaster::render
+    void terrain_render_view(TerrainGenerator* terrain, double x, double y, double eyeHeight,
+                             double direction, double verticalAngle, double fov, double viewDistance,
+                             double heightScale, int width, int height, unsigned char* out) {
+        if (!terrain || !out) return;
+        ViewCamera camera = {x, y, eyeHeight, direction, verticalAngle, fov, viewDistance, heightScale};
+        HeightfieldRaycaster(*terrain).render(camera, width, height, out);
+    }
+    
+    // Sample a region of a coarse mip level; see TerrainGenerator::getRegionLod
+    void terrain_get_region_lod(TerrainGenerator* terrain, int x0, int y0, int w, int h, int level, float* out) {
+        if (!terrain || !out) return;
+        terrain->getRegionLod(x0, y0, w, h, level, out);
+    }
+    
+    // Copy the obstacle mask of a region; see TerrainGenerator::getObstacleMask
+    void terrain_get_obstacle_mask(TerrainGenerator* terrain, int x0, int y0, int w, int h, uint64_t* out) {
+        if (!terrain || !out) return;
+        terrain->getObstacleMask(x0, y0, w, h, out);
+    }
+    
+    void terrain_set_elevation(TerrainGenerator* terrain, int x, int y, float elevation) {
+        if (terrain) {
+            terrain->setElevation(x, y, elevation);
+        }
+    }
+    
+    bool terrain_is_obstacle(TerrainGenerator* terrain, int x, int y) {
+        if (!terrain) return true;
+        return terrain->isObstacle(x, y);
+    }
+    
+    void terrain_unload_distant_chunks(TerrainGenerator* terrain, int centerX, int centerY, int maxViewRadius) {
+        if (terrain) {
+            terrain->unloadDistantChunks(centerX, centerY, maxViewRadius);
+        }
+    }
+    
+    // Queue n chunks, given as interleaved (chunkX, chunkY) pairs, for
+    // background generation. Higher priorities are generated first.
+    void terrain_prefetch(TerrainGenerator* terrain, const int* coords, int n, int priority) {
+        if (!terrain || !coords || n <= 0) return;
+        terrain->prefetchChunks(coords, n, priority);
+    }
+    
+    // Drop all queued prefetch requests
+    void terrain_cancel_prefetch(TerrainGenerator* terrain) {
+        if (terrain) {
+            terrain->cancelPrefetch();
+        }
+    }
+    
+    int terrain_prefetch_pending(TerrainGenerator* terrain) {
+        if (!terrain) return 0;
+        return terrain->pendingPrefetches();
+    }
+    
+    // Select how cached chunks are stored (see ChunkFormat). Returns the
+    // format actually selected.
+    int terrain_set_chunk_format(TerrainGenerator* terrain, int format) {
+        if (!terrain) return CHUNK_FORMAT_FLOAT32;
+        if (format != CHUNK_FORMAT_UINT16 && format != CHUNK_FORMAT_UINT8) {
+            format = CHUNK_FORMAT_FLOAT32;
+        }
+        terrain->setChunkFormat(static_cast<ChunkFormat>(format));
+        return format;
+    }
+    
+    // Limit cached chunk data to budgetBytes (0 = unlimited)
+    void terrain_set_cache_budget(TerrainGenerator* terrain, uint64_t budgetBytes) {
+        if (terrain) {
+            terrain->setCacheBudget(budgetBytes);
+        }
+    }
+    
+    // Back chunk cells with huge pages (see ChunkBufferPool)
+    void terrain_set_huge_pages(TerrainGenerator* terrain, int enabled) {
+        if (terrain) {
+            terrain->setHugePages(enabled != 0);
+        }
+    }
+    
+    // Select the cell order of cached chunks (see ChunkLayout). Returns the
+    // layout actually selected.
+    int terrain_set_chunk_layout(TerrainGenerator* terrain, int layout) {
+        if (!terrain) return CHUNK_LAYOUT_LINEAR;
+        return terrain->setChunkLayout(static_cast<ChunkLayout>(layout));
+    }
+    
+    // Select the eviction policy (see CachePolicy)
+    void terrain_set_cache_policy(TerrainGenerator* terrain, int policy) {
+        if (terrain) {
+            terrain->setCachePolicy(policy == CACHE_POLICY_CLOCK ? CACHE_POLICY_CLOCK : CACHE_POLICY_LRU);
+        }
+    }
+    
+    // Pin n chunks, given as interleaved (chunkX, chunkY) pairs, replacing the
+    // previous pinned set. Pinned chunks are never evicted by the budget.
+    void terrain_pin_chunks(TerrainGenerator* terrain, const int* coords, int n) {
+        if (!terrain || (!coords && n > 0)) return;
+        terrain->pinChunks(coords, n);
+    }
+    
+    void terrain_get_cache_stats(TerrainGenerator* terrain, CacheStats* stats) {
+        if (!terrain || !stats) return;
+        *stats = terrain->getCacheStats();
+    }
+    
+    // Snapshot the counters and latency histograms (see TerrainStats). Counts
+    // are cumulative; callers wanting rates diff successive snapshots.
+    void terrain_get_stats(TerrainGenerator* terrain, TerrainStats* stats) {
+        if (!terrain || !stats) return;
+        *stats = terrain->getStats();
+    }
+    
+    void terrain_clear_chunks(TerrainGenerator* terrain) {
+        if (terrain) {
+            terrain->clearChunks();
+        }
+    }
+    
+    // Write a world rectangle to a heightfield file (format is a
+    // HeightfieldFormat); returns a HeightfieldStatus
+    int terrain_export_region(TerrainGenerator* terrain, const char* path, int x0, int y0, int w, int h,
+                              int format) {
+        if (!terrain || !path) return HEIGHTFIELD_INVALID_ARGUMENT;
+        return terrain->exportRegion(path, x0, y0, w, h, static_cast<HeightfieldFormat>(format));
+    }
+    
+    // Build chunks from a heightfield file instead of the noise; returns a
+    // HeightfieldStatus. A null path goes back to the noise.
+    int terrain_load_heightfield(TerrainGenerator* terrain, const char* path, int offsetX, int offsetY,
+                                 double valueScale, double valueOffset) {
+        if (!terrain) return HEIGHTFIELD_INVALID_ARGUMENT;
+        if (!path) {
+            terrain->clearHeightfield();
+            return HEIGHTFIELD_OK;
+        }
+        return terrain->loadHeightfield(path, offsetX, offsetY, valueScale, valueOffset);
+    }
+    
+    // Find a path with the search algorithm selected by algorithm (see
+    // PathAlgorithm). Writes up to outLen (x, y) pairs into outBuf and
+    // returns the full path length in points, or 0 if no path was found.
+    // If the return value exceeds outLen the path was truncated. For
+    // PATH_ALGORITHM_HIERARCHICAL, maxIterations limits abstract expansions;
+    // PATH_ALGORITHM_JUMP_POINT prunes exactly flat runs only (tolerance 0).
+    int terrain_find_path_with(TerrainGenerator* terrain, int algorithm, int startX, int startY,
+                               int goalX, int goalY, double elevationWeight, int maxIterations,
+                               int* outBuf, int outLen) {
+        if (!terrain) return 0;
+        return copyPath(findPathWith(*terrain, algorithm, startX, startY, goalX, goalY, elevationWeight,
+                                     0.0, maxIterations),
+                        outBuf, outLen);
+    }
+    
+    // Find a path with jump point search, pruning runs whose steps cost their
+    // base length within tolerance; see terrain_find_path_with
+    int terrain_find_path_jps(TerrainGenerator* terrain, int startX, int startY, int goalX, int goalY,
+                              double elevationWeight, double tolerance, int maxIterations,
+                              int* outBuf, int outLen) {
+        if (!terrain) return 0;
+        return copyPath(findPathWith(*terrain, PATH_ALGORITHM_JUMP_POINT, startX, startY, goalX, goalY,
+                                     elevationWeight, tolerance, maxIterations),
+                        outBuf, outLen);
+    }
+    
+    // Find a path with weighted A* / ARA* under schedule (see
+    // AnytimeSchedule), returning the best path found by the deadline. Writes
+    // up to outLen (x, y) pairs into outBuf and the path's suboptimality
+    // bound into *bound (may be NULL), and returns the full path length in
+    // points, or 0 if no path was found. Expansions over every pass count
+    // towards maxIterations.
+    int terrain_find_path_anytime(TerrainGenerator* terrain, int startX, int startY, int goalX, int goalY,
+                                  double elevationWeight, const AnytimeSchedule* schedule, int maxIterations,
+                                  int* outBuf, int outLen, double* bound) {
+        if (!terrain || !schedule) return 0;
+        
+        AnytimePathFinder pathfinder(*terrain);
+        std::vector<std::pair<int, int>> path = pathfinder.findPath(startX, startY, goalX, goalY, elevationWeight,
+                                                                    *schedule, maxIterations);
+        if (bound) {
+            *bound = pathfinder.getBound();
+        }
+        return copyPath(path, outBuf, outLen);
+    }
+    
+    // Answer n path queries concurrently on the worker pool, writing one
+    // PathResult per query. With shareGoals set, A* queries with the same
+    // goal and weight share one backward Dijkstra field and get exact
+    // shortest paths. The terrain must not be edited during the call.
+    void terrain_find_paths(TerrainGenerator* terrain, const PathQuery* queries, int n, PathResult* results,
+                            int shareGoals) {
+        if (!terrain || !queries || !results || n <= 0) return;
+        BatchPathFinder(*terrain).run(queries, n, results, shareGoals != 0);
+    }
+    
+    // Find a path with A*; see terrain_find_path_with
+    int terrain_find_path(TerrainGenerator* terrain, int startX, int startY, int goalX, int goalY,
+                          double elevationWeight, int maxIterations, int* outBuf, int outLen) {
+        return terrain_find_path_with(terrain, PATH_ALGORITHM_ASTAR, startX, startY, goalX, goalY,
+                                      elevationWeight, maxIterations, outBuf, outLen);
+    }
+    
+    // Create an incremental planner towards (goalX, goalY). Destroy it with
+    // terrain_replanner_destroy before the terrain it plans over.
+    IncrementalPathFinder* terrain_replanner_create(TerrainGenerator* terrain, int goalX, int goalY,
+                                                    double elevationWeight) {
+        if (!terrain) return nullptr;
+        IncrementalPathFinder* replanner = new IncrementalPathFinder(*terrain, elevationWeight);
+        replanner->setGoal(goalX, goalY);
+        return replanner;
+    }
+    
+    void terrain_replanner_set_goal(IncrementalPathFinder* replanner, int goalX, int goalY) {
+        if (!replanner) return;
+        replanner->setGoal(goalX, goalY);
+    }
+    
+    // Replan from (startX, startY), repairing the previous search. Output is
+    // as for terrain_find_path_with; maxIterations limits the cells expanded
+    // by this call.
+    int terrain_replanner_replan(IncrementalPathFinder* replanner, int startX, int startY,
+                                 int maxIterations, int* outBuf, int outLen) {
+        if (!replanner) return 0;
+        return copyPath(replanner->replan(startX, startY, maxIterations), outBuf, outLen);
+    }
+    
+    // Tell one planner that cells changed without going through the terrain
+    void terrain_replanner_notify_cells_changed(IncrementalPathFinder* replanner, int x0, int y0,
+                                                int width, int height) {
+        if (!replanner) return;
+        replanner->notifyCellsChanged(x0, y0, width, height);
+    }
+    
+    // Cells expanded by the planner's last replan
+    int terrain_replanner_expansions(IncrementalPathFinder* replanner) {
+        if (!replanner) return 0;
+        return replanner->getExpansions();
+    }
+    
+    // 1 if the planner's last replan ran out of expansions before finding a
+    // path; the next replan continues the search
+    int terrain_replanner_searching(IncrementalPathFinder* replanner) {
+        if (!replanner) return 0;
+        return replanner->isSearching() ? 1 : 0;
+    }
+    
+    void terrain_replanner_destroy(IncrementalPathFinder* replanner) {
+        delete replanner;
+    }
+    
+    // Record that cells changed outside terrain_set_elevation; every
+    // incremental planner repairs them on its next replan
+    void terrain_notify_cells_changed(TerrainGenerator* terrain, int x0, int y0, int width, int height) {
+        if (!terrain) return;
+        terrain->notifyCellsChanged(x0, y0, width, height);
+    }
+    
+    // Create a planner that searches on its own thread. Destroy it with
+    // terrain_planner_destroy before the terrain it plans over.
+    AsyncPathPlanner* terrain_planner_create(TerrainGenerator* terrain) {
+        if (!terrain) return nullptr;
+        return new AsyncPathPlanner(*terrain);
+    }
+    
+    // Queue a path search and return its ticket without waiting; arguments
+    // are as for terrain_find_path_with and terrain_find_path_jps. Returns 0
+    // if planner is NULL.
+    uint64_t terrain_plan_async(AsyncPathPlanner* planner, int algorithm, int startX, int startY, int goalX,
+                                int goalY, double elevationWeight, double jumpTolerance, int maxIterations) {
+        if (!planner) return 0;
+        return planner->submit(algorithm, startX, startY, goalX, goalY, elevationWeight, jumpTolerance,
+                               maxIterations);
+    }
+    
+    // Queue an anytime search (see terrain_find_path_anytime) and return its
+    // ticket; each improved path can be polled as soon as it is found
+    uint64_t terrain_plan_anytime_async(AsyncPathPlanner* planner, int startX, int startY, int goalX, int goalY,
+                                        double elevationWeight, const AnytimeSchedule* schedule,
+                                        int maxIterations) {
+        if (!planner || !schedule) return 0;
+        return planner->submit(PATH_ALGORITHM_ASTAR, startX, startY, goalX, goalY, elevationWeight, 0.0,
+                               maxIterations, schedule);
+    }
+    
+    // Queue a D* Lite replan (see terrain_replanner_replan) on the planner's
+    // thread and return its ticket. Replans towards the same goal with the
+    // same weight repair the previous one's search, which resumes where a
+    // cancelled or capped replan stopped.
+    uint64_t terrain_plan_replan_async(AsyncPathPlanner* planner, int startX, int startY, int goalX, int goalY,
+                                       double elevationWeight, int maxIterations) {
+        if (!planner) return 0;
+        return planner->submit(PATH_ALGORITHM_ASTAR, startX, startY, goalX, goalY, elevationWeight, 0.0,
+                               maxIterations, nullptr, true);
+    }
+    
+    // As terrain_plan_poll, also writing the current path's suboptimality
+    // bound to *bound (may be NULL): for anytime plans its cost is at most
+    // that many times optimal, infinite while only a partial path is known.
+    // Other plans report 0.
+    int terrain_plan_poll_bound(AsyncPathPlanner* planner, uint64_t ticket, int* status, double* bound,
+                                int* outBuf, int outLen) {
+        std::vector<std::pair<int, int>> path;
+        double pathBound = 0.0;
+        PlanStatus planStatus = planner ? planner->poll(ticket, path, pathBound) : PLAN_STATUS_UNKNOWN;
+        if (status) {
+            *status = planStatus;
+        }
+        if (bound) {
+            *bound = pathBound;
+        }
+        return copyPath(path, outBuf, outLen);
+    }
+    
+    // Report a plan's PlanStatus in *status and write up to outLen (x, y)
+    // pairs of its current path into outBuf: the final path once done, the
+    // best partial path while running. Returns the full length of that path
+    // in points; if it exceeds outLen the path was truncated.
+    int terrain_plan_poll(AsyncPathPlanner* planner, uint64_t ticket, int* status, int* outBuf, int outLen) {
+        return terrain_plan_poll_bound(planner, ticket, status, nullptr, outBuf, outLen);
+    }
+    
+    // Stop a plan if it is still searching and release its result. Call once
+    // for every ticket, finished or not.
+    void terrain_plan_cancel(AsyncPathPlanner* planner, uint64_t ticket) {
+        if (planner) {
+            planner->cancel(ticket);
+        }
+    }
+    
+    // Stops any running plan; returns once the planner thread has exited
+    void terrain_planner_destroy(AsyncPathPlanner* planner) {
+        delete planner;
+    }
+    
     void terrain_destroy(TerrainGenerator* terrain) {
         delete terrain;
     }
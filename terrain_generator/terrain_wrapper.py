@@ -1,7 +1,8 @@
 import os
 import ctypes
+import weakref
 import numpy as np
-from ctypes import c_int, c_float, c_double, c_bool, POINTER, c_void_p
+from ctypes import c_int, c_float, c_double, c_bool, c_uint8, c_uint64, c_char_p, POINTER, c_void_p, byref
 
 # Path to shared library
 _lib_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'libterrain_generator.so')
@@ -9,8 +10,128 @@ _lib_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'libterrain
 # Load the shared library
 _lib = ctypes.CDLL(_lib_path)
 
+# Noise kernels accepted by TerrainGenerator.set_noise_kernel
+NOISE_KERNEL_AUTO = 0       # Best kernel supported by this CPU
+NOISE_KERNEL_REFERENCE = 1  # Double precision scalar noise
+NOISE_KERNEL_SCALAR = 2
+NOISE_KERNEL_SSE41 = 3
+NOISE_KERNEL_AVX2 = 4
+NOISE_KERNEL_NEON = 5
+
+# Search algorithms accepted by TerrainGenerator.find_path
+PATH_ALGORITHM_ASTAR = 0         # Exact A* over every cell
+PATH_ALGORITHM_HIERARCHICAL = 1  # HPA* over cached cluster graphs, a few percent over optimal
+PATH_ALGORITHM_JUMP_POINT = 2    # A* with jump point pruning on flat terrain
+
+# Heuristics accepted by TerrainGenerator.set_path_heuristic
+PATH_HEURISTIC_MANHATTAN = 0     # Legacy estimate; overestimates diagonal steps
+PATH_HEURISTIC_OCTILE_CLIMB = 1  # Octile distance plus the weighted climb to the goal
+PATH_HEURISTIC_LANDMARKS = 2     # Also the ALT bound from precomputed landmark distances
+
+# Plan states reported by AsyncPlanner.poll
+PLAN_STATUS_UNKNOWN = -1  # No such ticket, or it was cancelled
+PLAN_STATUS_QUEUED = 0    # Waiting for the planner thread
+PLAN_STATUS_RUNNING = 1   # Searching; the path is the best partial one so far
+PLAN_STATUS_DONE = 2      # Finished with a full path
+PLAN_STATUS_FAILED = 3    # Finished without a path
+
+# Chunk storage formats accepted by TerrainGenerator.set_chunk_format
+CHUNK_FORMAT_FLOAT32 = 0  # 4 bytes per cell, exact
+CHUNK_FORMAT_UINT16 = 1   # 2 bytes per cell, quantized over each chunk's range
+CHUNK_FORMAT_UINT8 = 2    # 1 byte per cell, quantized over each chunk's range
+
+# Cell layouts accepted by TerrainGenerator.set_chunk_layout
+CHUNK_LAYOUT_LINEAR = 0  # Row-major columns, shared with numpy without a copy
+CHUNK_LAYOUT_TILED = 1   # 8x8 micro-tiles; needs a chunk size divisible by 8
+CHUNK_LAYOUT_MORTON = 2  # Z-order curve; needs a power-of-two chunk size
+
+# Chunk cache eviction policies accepted by TerrainGenerator.set_cache_policy
+CACHE_POLICY_LRU = 0    # Evict the least recently used chunks first
+CACHE_POLICY_CLOCK = 1  # Second chance: skip chunks used since the last sweep
+
+# Heightfield file formats accepted by TerrainGenerator.export_region
+HEIGHTFIELD_FORMAT_TILED = 0    # Chunk-sized float tiles, cells laid out like chunks
+HEIGHTFIELD_FORMAT_GEOTIFF = 1  # Uncompressed float32 GeoTIFF, readable by GIS tools
+
+# Failure statuses returned by the heightfield export and import calls
+HEIGHTFIELD_INVALID_ARGUMENT = -1
+HEIGHTFIELD_IO_ERROR = -2
+HEIGHTFIELD_TOO_LARGE = -3  # A GeoTIFF over 4 GiB
+HEIGHTFIELD_UNSUPPORTED = -4  # Not a tiled heightfield or an uncompressed little-endian TIFF
+
+class CacheStats(ctypes.Structure):
+    """Mirror of the C++ CacheStats struct."""
+    _fields_ = [
+        ('hits', c_uint64),
+        ('misses', c_uint64),
+        ('evictions', c_uint64),
+        ('bytes_resident', c_uint64),
+        ('chunks_resident', c_uint64),
+        ('byte_budget', c_uint64),
+    ]
+
+# Buckets in each TerrainStats latency histogram; bucket i counts durations
+# in [2**i, 2**(i+1)) microseconds
+STATS_HISTOGRAM_BUCKETS = 24
+
+class TerrainStats(ctypes.Structure):
+    """Mirror of the C++ TerrainStats struct."""
+    _fields_ = [
+        ('enabled', c_uint64),
+        ('chunk_generations', c_uint64),
+        ('chunk_generation_ns', c_uint64),
+        ('noise_evaluations', c_uint64),
+        ('cache_hits', c_uint64),
+        ('cache_misses', c_uint64),
+        ('evictions', c_uint64),
+        ('bytes_resident', c_uint64),
+        ('chunks_resident', c_uint64),
+        ('path_searches', c_uint64),
+        ('path_expansions', c_uint64),
+        ('path_ns', c_uint64),
+        ('chunk_latency', c_uint64 * STATS_HISTOGRAM_BUCKETS),
+        ('path_latency', c_uint64 * STATS_HISTOGRAM_BUCKETS),
+        ('pool_bytes', c_uint64),
+        ('pool_buffers_free', c_uint64),
+        ('pool_huge_pages', c_uint64),
+    ]
+
+class AnytimeSchedule(ctypes.Structure):
+    """Mirror of the C++ AnytimeSchedule struct."""
+    _fields_ = [
+        ('initial_epsilon', c_double),
+        ('final_epsilon', c_double),
+        ('epsilon_step', c_double),
+        ('deadline_ms', c_double),
+    ]
+
+class PathQuery(ctypes.Structure):
+    """Mirror of the C++ PathQuery struct."""
+    _fields_ = [
+        ('start_x', c_int),
+        ('start_y', c_int),
+        ('goal_x', c_int),
+        ('goal_y', c_int),
+        ('algorithm', c_int),
+        ('elevation_weight', c_double),
+        ('max_iterations', c_int),
+        ('jump_tolerance', c_double),
+    ]
+
+class PathResult(ctypes.Structure):
+    """Mirror of the C++ PathResult struct."""
+    _fields_ = [
+        ('path', POINTER(c_int)),
+        ('capacity', c_int),
+        ('length', c_int),
+        ('expansions', c_int),
+        ('cost', c_double),
+        ('latency_ms', c_double),
+        ('shared_field', c_int),
+    ]
+
 # Define argument and return types for C functions
-_lib.terrain_create.argtypes = [c_int, c_int, c_int, c_int, c_int]
+_lib.terrain_create.argtypes = [c_int, c_int, c_int, c_int, c_int, c_char_p]
 _lib.terrain_create.restype = c_void_p
 
 _lib.terrain_set_parameters.argtypes = [c_void_p, c_double, c_int, c_double, c_double, c_double]
@@ -19,23 +140,207 @@ _lib.terrain_set_parameters.restype = None
 _lib.terrain_generate_chunk.argtypes = [c_void_p, c_int, c_int, POINTER(c_float)]
 _lib.terrain_generate_chunk.restype = None
 
+_lib.terrain_generate_chunks.argtypes = [c_void_p, POINTER(c_int), c_int]
+_lib.terrain_generate_chunks.restype = None
+
+_lib.terrain_prefetch.argtypes = [c_void_p, POINTER(c_int), c_int, c_int]
+_lib.terrain_prefetch.restype = None
+
+_lib.terrain_cancel_prefetch.argtypes = [c_void_p]
+_lib.terrain_cancel_prefetch.restype = None
+
+_lib.terrain_prefetch_pending.argtypes = [c_void_p]
+_lib.terrain_prefetch_pending.restype = c_int
+
+_lib.terrain_set_thread_count.argtypes = [c_void_p, c_int]
+_lib.terrain_set_thread_count.restype = None
+
+_lib.terrain_set_edge_cost_weight.argtypes = [c_void_p, c_double]
+_lib.terrain_set_edge_cost_weight.restype = None
+
+_lib.terrain_set_path_heuristic.argtypes = [c_void_p, c_int, c_int]
+_lib.terrain_set_path_heuristic.restype = None
+
+_lib.terrain_prepare_landmarks.argtypes = [c_void_p, c_double, POINTER(c_int), c_int]
+_lib.terrain_prepare_landmarks.restype = c_int
+
+_lib.terrain_set_path_clearance.argtypes = [c_void_p, c_double, c_double, c_double]
+_lib.terrain_set_path_clearance.restype = None
+
+_lib.terrain_prepare_clearance.argtypes = [c_void_p, POINTER(c_int), c_int]
+_lib.terrain_prepare_clearance.restype = None
+
+_lib.terrain_get_clearances.argtypes = [c_void_p, POINTER(c_int), POINTER(c_int), c_int, POINTER(c_float)]
+_lib.terrain_get_clearances.restype = None
+
+_lib.terrain_export_region.argtypes = [c_void_p, c_char_p, c_int, c_int, c_int, c_int, c_int]
+_lib.terrain_export_region.restype = c_int
+
+_lib.terrain_load_heightfield.argtypes = [c_void_p, c_char_p, c_int, c_int, c_double, c_double]
+_lib.terrain_load_heightfield.restype = c_int
+
+_lib.terrain_set_noise_kernel.argtypes = [c_void_p, c_int]
+_lib.terrain_set_noise_kernel.restype = c_int
+
+_lib.terrain_acquire_chunk.argtypes = [c_void_p, c_int, c_int, POINTER(c_void_p)]
+_lib.terrain_acquire_chunk.restype = POINTER(c_float)
+
+_lib.terrain_release_chunk.argtypes = [c_void_p]
+_lib.terrain_release_chunk.restype = None
+
+_lib.terrain_set_elevation.argtypes = [c_void_p, c_int, c_int, c_float]
+_lib.terrain_set_elevation.restype = None
+
 _lib.terrain_get_elevation.argtypes = [c_void_p, c_int, c_int]
 _lib.terrain_get_elevation.restype = c_float
 
+_lib.terrain_get_elevations.argtypes = [c_void_p, POINTER(c_int), POINTER(c_int), c_int, POINTER(c_float)]
+_lib.terrain_get_elevations.restype = None
+
+_lib.terrain_get_obstacles.argtypes = [c_void_p, POINTER(c_int), POINTER(c_int), c_int, POINTER(c_uint8)]
+_lib.terrain_get_obstacles.restype = None
+
+_lib.terrain_get_region.argtypes = [c_void_p, c_int, c_int, c_int, c_int, c_int, POINTER(c_float)]
+_lib.terrain_get_region.restype = None
+
+_lib.terrain_get_region_lod.argtypes = [c_void_p, c_int, c_int, c_int, c_int, c_int, POINTER(c_float)]
+_lib.terrain_get_region_lod.restype = None
+
+_lib.terrain_render_view.argtypes = [c_void_p, c_double, c_double, c_double, c_double, c_double,
+                                     c_double, c_double, c_double, c_int, c_int, POINTER(c_uint8)]
+_lib.terrain_render_view.restype = None
+
 _lib.terrain_is_obstacle.argtypes = [c_void_p, c_int, c_int]
 _lib.terrain_is_obstacle.restype = c_bool
 
 _lib.terrain_unload_distant_chunks.argtypes = [c_void_p, c_int, c_int, c_int]
 _lib.terrain_unload_distant_chunks.restype = None
 
+_lib.terrain_set_chunk_format.argtypes = [c_void_p, c_int]
+_lib.terrain_set_chunk_format.restype = c_int
+
+_lib.terrain_get_obstacle_mask.argtypes = [c_void_p, c_int, c_int, c_int, c_int, POINTER(c_uint64)]
+_lib.terrain_get_obstacle_mask.restype = None
+
+_lib.terrain_set_cache_budget.argtypes = [c_void_p, c_uint64]
+_lib.terrain_set_cache_budget.restype = None
+
+_lib.terrain_set_cache_policy.argtypes = [c_void_p, c_int]
+_lib.terrain_set_cache_policy.restype = None
+
+_lib.terrain_set_huge_pages.argtypes = [c_void_p, c_int]
+_lib.terrain_set_huge_pages.restype = None
+
+_lib.terrain_set_chunk_layout.argtypes = [c_void_p, c_int]
+_lib.terrain_set_chunk_layout.restype = c_int
+
+_lib.terrain_pin_chunks.argtypes = [c_void_p, POINTER(c_int), c_int]
+_lib.terrain_pin_chunks.restype = None
+
+_lib.terrain_get_cache_stats.argtypes = [c_void_p, POINTER(CacheStats)]
+_lib.terrain_get_cache_stats.restype = None
+
+_lib.terrain_get_stats.argtypes = [c_void_p, POINTER(TerrainStats)]
+_lib.terrain_get_stats.restype = None
+
 _lib.terrain_clear_chunks.argtypes = [c_void_p]
 _lib.terrain_clear_chunks.restype = None
 
+_lib.terrain_find_path.argtypes = [c_void_p, c_int, c_int, c_int, c_int, c_double, c_int,
+                                   POINTER(c_int), c_int]
+_lib.terrain_find_path.restype = c_int
+
+_lib.terrain_find_path_with.argtypes = [c_void_p, c_int, c_int, c_int, c_int, c_int, c_double, c_int,
+                                        POINTER(c_int), c_int]
+_lib.terrain_find_path_with.restype = c_int
+
+_lib.terrain_find_path_jps.argtypes = [c_void_p, c_int, c_int, c_int, c_int, c_double, c_double, c_int,
+                                       POINTER(c_int), c_int]
+_lib.terrain_find_path_jps.restype = c_int
+
+_lib.terrain_find_path_anytime.argtypes = [c_void_p, c_int, c_int, c_int, c_int, c_double,
+                                            POINTER(AnytimeSchedule), c_int, POINTER(c_int), c_int,
+                                            POINTER(c_double)]
+_lib.terrain_find_path_anytime.restype = c_int
+
+_lib.terrain_find_paths.argtypes = [c_void_p, POINTER(PathQuery), c_int, POINTER(PathResult), c_int]
+_lib.terrain_find_paths.restype = None
+
+_lib.terrain_replanner_create.argtypes = [c_void_p, c_int, c_int, c_double]
+_lib.terrain_replanner_create.restype = c_void_p
+
+_lib.terrain_replanner_set_goal.argtypes = [c_void_p, c_int, c_int]
+_lib.terrain_replanner_set_goal.restype = None
+
+_lib.terrain_replanner_replan.argtypes = [c_void_p, c_int, c_int, c_int, POINTER(c_int), c_int]
+_lib.terrain_replanner_replan.restype = c_int
+
+_lib.terrain_replanner_notify_cells_changed.argtypes = [c_void_p, c_int, c_int, c_int, c_int]
+_lib.terrain_replanner_notify_cells_changed.restype = None
+
+_lib.terrain_replanner_expansions.argtypes = [c_void_p]
+_lib.terrain_replanner_expansions.restype = c_int
+
+_lib.terrain_replanner_searching.argtypes = [c_void_p]
+_lib.terrain_replanner_searching.restype = c_int
+
+_lib.terrain_replanner_destroy.argtypes = [c_void_p]
+_lib.terrain_replanner_destroy.restype = None
+
+_lib.terrain_notify_cells_changed.argtypes = [c_void_p, c_int, c_int, c_int, c_int]
+_lib.terrain_notify_cells_changed.restype = None
+
+_lib.terrain_planner_create.argtypes = [c_void_p]
+_lib.terrain_planner_create.restype = c_void_p
+
+_lib.terrain_plan_async.argtypes = [c_void_p, c_int, c_int, c_int, c_int, c_int, c_double, c_double, c_int]
+_lib.terrain_plan_async.restype = c_uint64
+
+_lib.terrain_plan_anytime_async.argtypes = [c_void_p, c_int, c_int, c_int, c_int, c_double,
+                                             POINTER(AnytimeSchedule), c_int]
+_lib.terrain_plan_anytime_async.restype = c_uint64
+
+_lib.terrain_plan_replan_async.argtypes = [c_void_p, c_int, c_int, c_int, c_int, c_double, c_int]
+_lib.terrain_plan_replan_async.restype = c_uint64
+
+_lib.terrain_plan_poll_bound.argtypes = [c_void_p, c_uint64, POINTER(c_int), POINTER(c_double),
+                                         POINTER(c_int), c_int]
+_lib.terrain_plan_poll_bound.restype = c_int
+
+_lib.terrain_plan_poll.argtypes = [c_void_p, c_uint64, POINTER(c_int), POINTER(c_int), c_int]
+_lib.terrain_plan_poll.restype = c_int
+
+_lib.terrain_plan_cancel.argtypes = [c_void_p, c_uint64]
+_lib.terrain_plan_cancel.restype = None
+
+_lib.terrain_planner_destroy.argtypes = [c_void_p]
+_lib.terrain_planner_destroy.restype = None
+
 _lib.terrain_destroy.argtypes = [c_void_p]
 _lib.terrain_destroy.restype = None
 
+def _anytime_schedule(epsilon, deadline_ms):
+    """Build an AnytimeSchedule from an epsilon or (initial, final, step) tuple."""
+    if isinstance(epsilon, (int, float)):
+        epsilon = (epsilon, epsilon, 0.0)
+    initial, final, step = epsilon
+    return AnytimeSchedule(float(initial), float(final), float(step), float(deadline_ms or 0))
+
+def _check_heightfield_status(status, path):
+    """Raise the exception matching a failed heightfield call's status."""
+    if status == HEIGHTFIELD_IO_ERROR:
+        raise OSError('cannot read or write heightfield %s' % path)
+    if status == HEIGHTFIELD_TOO_LARGE:
+        raise ValueError('region too large for a GeoTIFF: %s' % path)
+    if status == HEIGHTFIELD_UNSUPPORTED:
+        raise ValueError('unsupported heightfield format: %s' % path)
+    if status < 0:
+        raise ValueError('invalid heightfield arguments for %s' % path)
+
+
 class TerrainGenerator:
-    def __init__(self, width=15000, height=15000, max_elevation=250, chunk_size=256, seed=None):
+    def __init__(self, width=15000, height=15000, max_elevation=250, chunk_size=256, seed=None,
+                 cache_dir=None):
         """
         Initialize the terrain generator with the given parameters.
         
@@ -45,6 +350,8 @@ class TerrainGenerator:
             max_elevation (int): Maximum elevation difference
             chunk_size (int): Size of each terrain chunk
             seed (int): Random seed for terrain generation
+            cache_dir (str): Directory for the on-disk chunk store, shared by
+                every process using it; None keeps chunks in memory only
         """
         if seed is None:
             import random
@@ -55,9 +362,11 @@ class TerrainGenerator:
         self.max_elevation = max_elevation
         self.chunk_size = chunk_size
         self.seed = seed
+        self.cache_dir = cache_dir
         
         # Create the C++ terrain generator
-        self._terrain = _lib.terrain_create(width, height, max_elevation, chunk_size, seed)
+        self._terrain = _lib.terrain_create(width, height, max_elevation, chunk_size, seed,
+                                            os.fsencode(cache_dir) if cache_dir else None)
         
         # Configure default terrain parameters
         self.scale = 0.01
@@ -69,9 +378,6 @@ class TerrainGenerator:
         # Apply the default parameters
         self.set_parameters(self.scale, self.octaves, self.persistence, 
                            self.lacunarity, self.obstacle_prob)
-        
-        # Keep track of loaded chunks
-        self.chunks = {}
     
     def __del__(self):
         """Clean up resources when object is destroyed."""
@@ -114,24 +420,261 @@ class TerrainGenerator:
             chunk_y (int): Chunk y coordinate
             
         Returns:
-            numpy.ndarray: Generated chunk data (2D array with elevation values)
+            numpy.ndarray: Read-only view of the chunk data (2D array with elevation values)
+        """
+        # Borrow the chunk from the C++ cache without copying it; the C++
+        # cache owns residency, so no Python-side copy is kept
+        return self._acquire_chunk_view(chunk_x, chunk_y)
+    
+    def generate_chunks(self, chunk_coords):
+        """
+        Generate several terrain chunks in parallel on the worker pool.
+        
+        Chunks are only generated into the C++ cache; use generate_chunk
+        to access their data.
+        
+        Args:
+            chunk_coords (list): List of chunk coordinates (chunk_x, chunk_y)
+        """
+        coords = np.ascontiguousarray(chunk_coords, dtype=np.int32).reshape(-1)
+        _lib.terrain_generate_chunks(self._terrain, coords.ctypes.data_as(POINTER(c_int)), len(coords) // 2)
+    
+    def prefetch(self, chunk_coords, priority=0):
+        """
+        Queue chunks for generation on a background thread.
+        
+        Returns immediately. Chunks with a higher priority are generated
+        first, and chunks with equal priority in the order given. Chunks that
+        are already cached or out of bounds are ignored.
+        
+        Args:
+            chunk_coords (list): List of chunk coordinates (chunk_x, chunk_y)
+            priority (int): Generation priority
+        """
+        coords = np.ascontiguousarray(chunk_coords, dtype=np.int32).reshape(-1)
+        if len(coords) == 0:
+            return
+        _lib.terrain_prefetch(self._terrain, coords.ctypes.data_as(POINTER(c_int)), len(coords) // 2, priority)
+    
+    def cancel_prefetch(self):
+        """Drop all queued prefetch requests."""
+        _lib.terrain_cancel_prefetch(self._terrain)
+    
+    def prefetch_pending(self):
+        """
+        Get the number of chunks still queued for prefetching.
+        
+        Returns:
+            int: Number of queued chunks
         """
-        # Check if chunk already exists in Python-side cache
-        chunk_key = (chunk_x, chunk_y)
-        if chunk_key in self.chunks:
-            return self.chunks[chunk_key]
+        return _lib.terrain_prefetch_pending(self._terrain)
+    
+    def set_thread_count(self, thread_count):
+        """
+        Set the number of threads used by generate_chunks.
         
-        # Allocate memory for the chunk data
-        chunk_data = np.zeros((self.chunk_size, self.chunk_size), dtype=np.float32)
+        Args:
+            thread_count (int): Number of threads (0 for one per hardware thread)
+        """
+        _lib.terrain_set_thread_count(self._terrain, thread_count)
+    
+    def set_edge_cost_weight(self, elevation_weight):
+        """
+        Keep precomputed step costs with each chunk for path searches that
+        use this elevation weight.
         
-        # Get C pointer to the chunk data
-        chunk_data_ptr = chunk_data.ctypes.data_as(POINTER(c_float))
+        Searches with another weight compute costs from elevations as
+        before. The fields take 8 floats per cell, so only enable this for
+        the weight the planner actually uses.
         
-        # Generate the chunk data using C++ implementation
-        _lib.terrain_generate_chunk(self._terrain, chunk_x, chunk_y, chunk_data_ptr)
+        Args:
+            elevation_weight (float): Elevation weight to keep costs for
+                (0 to stop)
+        """
+        _lib.terrain_set_edge_cost_weight(self._terrain, elevation_weight)
+    
+    def set_path_heuristic(self, heuristic, landmark_count=8):
+        """
+        Select the heuristic A* searches estimate the remaining cost with.
         
-        # Cache the chunk data
-        self.chunks[chunk_key] = chunk_data
+        PATH_HEURISTIC_LANDMARKS adds the ALT bound: bounds on the distance
+        from a few landmarks to every block of cells, prepared per elevation
+        weight with prepare_landmarks and kept in the chunk store if there
+        is one. It expands far fewer cells around ridges and paths stay
+        optimal. Searches never build the tables; without one, or after an
+        edit that may lower step costs until it is prepared again, they use
+        the octile-plus-climb bound. Placing obstacles keeps tables valid.
+        
+        Args:
+            heuristic (int): One of the PATH_HEURISTIC_* constants
+            landmark_count (int): Landmarks per table (1 to 16)
+        """
+        _lib.terrain_set_path_heuristic(self._terrain, heuristic, landmark_count)
+    
+    def prepare_landmarks(self, elevation_weight=1.5):
+        """
+        Load or build the landmark table that PATH_HEURISTIC_LANDMARKS
+        searches with an elevation weight need, rebuilding it after edits
+        that may lower step costs. Building generates every chunk and runs
+        one full-resolution Dijkstra per landmark, a few seconds on a
+        2048x2048 world; worlds over 2^24 cells are refused.
+        
+        Args:
+            elevation_weight (float): Weight factor for elevation differences
+            
+        Returns:
+            list: Landmark positions (x, y), empty if the world is too large
+        """
+        buffer = (c_int * 32)()
+        count = _lib.terrain_prepare_landmarks(self._terrain, c_double(elevation_weight), buffer, 16)
+        return [(buffer[2 * i], buffer[2 * i + 1]) for i in range(count)]
+    
+    def set_path_clearance(self, required, preferred=0.0, weight=0.0):
+        """
+        Keep path searches away from obstacles and steep cells.
+        
+        Each chunk gets a distance field to its nearest obstacle or steep
+        cell, built the first time a search reads the chunk and cached with
+        it. Cells closer than required are impassable, and steps cost weight
+        more per cell of clearance short of preferred. Clearance is measured
+        in cells up to 16 (or the chunk size less one). Jump point and
+        hierarchical searches run as plain A* while a rule is set.
+        
+        Args:
+            required (float): Clearance every path cell needs (0 for none)
+            preferred (float): Clearance below which steps cost extra
+            weight (float): Extra cost per missing cell of clearance
+        """
+        _lib.terrain_set_path_clearance(self._terrain, required, preferred, weight)
+    
+    def prepare_clearance(self, chunks):
+        """
+        Build the clearance fields of some chunks in parallel now rather
+        than in the searches that first read them.
+        
+        Args:
+            chunks (list): Chunk coordinates (chunk_x, chunk_y)
+        """
+        coords = np.ascontiguousarray(np.asarray(chunks, dtype=np.int32).reshape(-1))
+        _lib.terrain_prepare_clearance(self._terrain, coords.ctypes.data_as(POINTER(c_int)), len(coords) // 2)
+    
+    def get_clearances(self, xs, ys):
+        """
+        Get the clearance of many world cells from obstacles and steep cells.
+        
+        Args:
+            xs (array_like): World x coordinates
+            ys (array_like): World y coordinates
+            
+        Returns:
+            numpy.ndarray: Clearance in cells (float32), capped at the
+                clearance range; 0 outside the world
+        """
+        xs = np.ascontiguousarray(xs, dtype=np.int32)
+        ys = np.ascontiguousarray(ys, dtype=np.int32)
+        clearances = np.empty(len(xs), dtype=np.float32)
+        
+        _lib.terrain_get_clearances(
+            self._terrain,
+            xs.ctypes.data_as(POINTER(c_int)),
+            ys.ctypes.data_as(POINTER(c_int)),
+            len(xs),
+            clearances.ctypes.data_as(POINTER(c_float))
+        )
+        
+        return clearances
+    
+    def export_region(self, path, x, y, width, height, format=HEIGHTFIELD_FORMAT_TILED):
+        """
+        Write a region of the world to a heightfield file.
+        
+        Rows of chunks are generated in parallel and written as they finish,
+        so memory stays bounded by a couple of chunk rows however large the
+        region is. Chunks already in the cache, edits included, are written
+        as they are. The file is written under a temporary name and renamed
+        into place when complete.
+        
+        Args:
+            path (str): Output file
+            x (int): Left edge of the region
+            y (int): Top edge of the region
+            width (int): Region width in cells
+            height (int): Region height in cells
+            format (int): One of the HEIGHTFIELD_FORMAT_* constants
+        """
+        status = _lib.terrain_export_region(self._terrain, os.fsencode(path), x, y, width, height, format)
+        _check_heightfield_status(status, path)
+    
+    def load_heightfield(self, path, offset=(0, 0), value_scale=1.0, value_offset=0.0):
+        """
+        Serve elevations from a heightfield file instead of the noise.
+        
+        Accepts files written by export_region and uncompressed little-endian
+        TIFFs of float32, int16 or uint16 samples. The file is memory mapped
+        and sampled as chunks are built; cells outside it, nodata cells and
+        NaNs become obstacles. Cached chunks, mip levels and annotations are
+        dropped, and stored chunks are keyed by the file so they are never
+        mixed with generated ones.
+        
+        Args:
+            path (str): Heightfield file
+            offset (tuple): World position (x, y) of the file's first cell
+            value_scale (float): Multiplier applied to every sample
+            value_offset (float): Added to every sample after scaling
+        """
+        status = _lib.terrain_load_heightfield(self._terrain, os.fsencode(path), offset[0], offset[1],
+                                               c_double(value_scale), c_double(value_offset))
+        _check_heightfield_status(status, path)
+    
+    def clear_heightfield(self):
+        """Go back to generating elevations from the noise."""
+        _lib.terrain_load_heightfield(self._terrain, None, 0, 0, c_double(1.0), c_double(0.0))
+    
+    def set_noise_kernel(self, kernel):
+        """
+        Select the noise kernel used for chunk generation.
+        
+        Args:
+            kernel (int): One of the NOISE_KERNEL_* constants; unsupported
+                kernels fall back to the best one for this CPU
+            
+        Returns:
+            int: The kernel actually selected
+        """
+        return _lib.terrain_set_noise_kernel(self._terrain, kernel)
+    
+    def _acquire_chunk_view(self, chunk_x, chunk_y):
+        """
+        Wrap a chunk from the C++ cache as a read-only numpy array.
+        
+        The chunk stays pinned in C++ memory until the last array referencing
+        it is garbage collected. Quantized chunks have no float cells to
+        share, so they are decoded into a new array instead.
+        
+        Args:
+            chunk_x (int): Chunk x coordinate
+            chunk_y (int): Chunk y coordinate
+            
+        Returns:
+            numpy.ndarray: Read-only 2D view of the chunk data
+        """
+        handle = c_void_p()
+        data_ptr = _lib.terrain_acquire_chunk(self._terrain, chunk_x, chunk_y, byref(handle))
+        if not data_ptr:
+            chunk_data = np.empty((self.chunk_size, self.chunk_size), dtype=np.float32)
+            _lib.terrain_generate_chunk(self._terrain, chunk_x, chunk_y,
+                                        chunk_data.ctypes.data_as(POINTER(c_float)))
+            chunk_data.flags.writeable = False
+            return chunk_data
+        
+        # Views of the numpy array reference this buffer, so releasing the pin
+        # when it is collected keeps the memory alive for as long as any view
+        buffer = (c_float * (self.chunk_size * self.chunk_size)).from_address(
+            ctypes.addressof(data_ptr.contents))
+        weakref.finalize(buffer, _lib.terrain_release_chunk, handle)
+        
+        chunk_data = np.frombuffer(buffer, dtype=np.float32).reshape(self.chunk_size, self.chunk_size)
+        chunk_data.flags.writeable = False
         
         return chunk_data
     
@@ -148,6 +691,189 @@ class TerrainGenerator:
         """
         return _lib.terrain_get_elevation(self._terrain, x, y)
     
+    def get_elevations(self, xs, ys):
+        """
+        Get the elevations at many world coordinates in a single call.
+        
+        Args:
+            xs (array_like): World x coordinates
+            ys (array_like): World y coordinates
+            
+        Returns:
+            numpy.ndarray: Elevation values (float32), one per coordinate
+        """
+        xs = np.ascontiguousarray(xs, dtype=np.int32)
+        ys = np.ascontiguousarray(ys, dtype=np.int32)
+        elevations = np.empty(len(xs), dtype=np.float32)
+        
+        _lib.terrain_get_elevations(
+            self._terrain,
+            xs.ctypes.data_as(POINTER(c_int)),
+            ys.ctypes.data_as(POINTER(c_int)),
+            len(xs),
+            elevations.ctypes.data_as(POINTER(c_float))
+        )
+        
+        return elevations
+    
+    def get_obstacles(self, xs, ys):
+        """
+        Check many world coordinates for obstacles in a single call.
+        
+        Args:
+            xs (array_like): World x coordinates
+            ys (array_like): World y coordinates
+            
+        Returns:
+            numpy.ndarray: Boolean array, True where the position is an obstacle
+        """
+        xs = np.ascontiguousarray(xs, dtype=np.int32)
+        ys = np.ascontiguousarray(ys, dtype=np.int32)
+        obstacles = np.empty(len(xs), dtype=np.uint8)
+        
+        _lib.terrain_get_obstacles(
+            self._terrain,
+            xs.ctypes.data_as(POINTER(c_int)),
+            ys.ctypes.data_as(POINTER(c_int)),
+            len(xs),
+            obstacles.ctypes.data_as(POINTER(c_uint8))
+        )
+        
+        return obstacles.astype(bool)
+    
+    def get_region(self, x0, y0, width, height, step=1):
+        """
+        Sample a rectangular region of elevations in a single call.
+        
+        Args:
+            x0 (int): World x coordinate of the first sample
+            y0 (int): World y coordinate of the first sample
+            width (int): Number of samples along x
+            height (int): Number of samples along y
+            step (int): Distance in blocks between samples
+            
+        Returns:
+            numpy.ndarray: 2D array indexed [i, j] holding the elevation at
+                (x0 + i * step, y0 + j * step); out of bounds samples are -1
+        """
+        region = np.empty((width, height), dtype=np.float32)
+        
+        _lib.terrain_get_region(
+            self._terrain,
+            int(x0), int(y0), int(width), int(height), int(step),
+            region.ctypes.data_as(POINTER(c_float))
+        )
+        
+        return region
+    
+    def get_region_lod(self, x0, y0, width, height, level):
+        """
+        Sample a rectangular region of a coarse mip level in a single call.
+        
+        Level L samples lie 2 ** L blocks apart on multiples of 2 ** L and
+        are evaluated straight from the noise, so full-resolution chunks are
+        never generated for levels above 0. Coarse levels do not show
+        set_elevation edits.
+        
+        Args:
+            x0 (int): World x coordinate, rounded down to the level's grid
+            y0 (int): World y coordinate, rounded down to the level's grid
+            width (int): Number of samples along x
+            height (int): Number of samples along y
+            level (int): Mip level (0 for full resolution)
+            
+        Returns:
+            numpy.ndarray: 2D array indexed [i, j] holding the elevation at
+                (x0 // 2 ** level + i, y0 // 2 ** level + j) on the level's
+                grid; out of bounds samples are -1
+        """
+        region = np.empty((width, height), dtype=np.float32)
+        
+        _lib.terrain_get_region_lod(
+            self._terrain,
+            int(x0), int(y0), int(width), int(height), int(level),
+            region.ctypes.data_as(POINTER(c_float))
+        )
+        
+        return region
+    
+    def render_view(self, x, y, eye_height, direction, vertical_angle, fov, view_distance,
+                    height_scale, width, height, out=None):
+        """
+        Render a first-person view of the terrain with the native raycaster.
+        
+        Columns are split across the worker threads set by
+        set_thread_count. Distant terrain is read from coarse mip levels.
+        
+        Args:
+            x (float): Camera world x coordinate
+            y (float): Camera world y coordinate
+            eye_height (float): Eye elevation
+            direction (float): Heading in radians (0 = positive x-axis)
+            vertical_angle (float): Pitch in radians, positive looks up
+            fov (float): Horizontal field of view in radians
+            view_distance (float): Farthest distance drawn, in blocks
+            height_scale (float): Blocks of height drawn per elevation unit
+            width (int): Frame width in pixels
+            height (int): Frame height in pixels
+            out (numpy.ndarray): Optional uint8 array of shape
+                (width, height, 3) to render into
+            
+        Returns:
+            numpy.ndarray: uint8 RGB array of shape (width, height, 3),
+                ready for pygame.surfarray.blit_array
+        """
+        if out is None or out.shape != (width, height, 3):
+            out = np.empty((width, height, 3), dtype=np.uint8)
+        
+        _lib.terrain_render_view(
+            self._terrain, x, y, eye_height, direction, vertical_angle, fov, view_distance,
+            height_scale, int(width), int(height), out.ctypes.data_as(POINTER(c_uint8))
+        )
+        
+        return out
+    
+    def get_obstacle_mask(self, x0, y0, width, height, packed=False):
+        """
+        Get the obstacle bitmask of a rectangular region in a single call.
+        
+        Args:
+            x0 (int): World x coordinate of the first cell
+            y0 (int): World y coordinate of the first cell
+            width (int): Number of cells along x
+            height (int): Number of cells along y
+            packed (bool): Return the raw 64-bit words instead of booleans
+            
+        Returns:
+            numpy.ndarray: Boolean array indexed [i, j], True where
+                (x0 + i, y0 + j) is an obstacle or out of bounds. If packed,
+                a uint64 array of shape (width, (height + 63) // 64) where
+                bit j % 64 of word j // 64 holds cell j of each column.
+        """
+        words = np.empty((width, (height + 63) // 64), dtype=np.uint64)
+        
+        _lib.terrain_get_obstacle_mask(
+            self._terrain,
+            int(x0), int(y0), int(width), int(height),
+            words.ctypes.data_as(POINTER(c_uint64))
+        )
+        
+        if packed:
+            return words
+        bits = np.unpackbits(words.view(np.uint8), axis=1, bitorder='little')
+        return bits[:, :height].astype(bool)
+    
+    def set_elevation(self, x, y, elevation):
+        """
+        Overwrite the elevation at the specified world coordinates.
+        
+        Args:
+            x (int): World x coordinate
+            y (int): World y coordinate
+            elevation (float): New elevation value
+        """
+        _lib.terrain_set_elevation(self._terrain, x, y, c_float(elevation))
+    
     def is_obstacle(self, x, y):
         """
         Check if the specified position is an obstacle.
@@ -200,30 +926,539 @@ class TerrainGenerator:
             center_y (int): Center world y coordinate
             max_view_radius (int): Maximum view radius in chunks
         """
-        # Unload from C++ cache
         _lib.terrain_unload_distant_chunks(self._terrain, center_x, center_y, max_view_radius)
+    
+    def set_chunk_format(self, chunk_format):
+        """
+        Select how cached chunks are stored.
         
-        # Also unload from Python-side cache
-        center_chunk_x = center_x // self.chunk_size
-        center_chunk_y = center_y // self.chunk_size
+        Quantized formats cut memory roughly in half (uint16) or to a
+        quarter (uint8) at the cost of a small elevation error; obstacles
+        are always exact. Drops every cached chunk.
         
-        chunks_to_remove = []
-        for chunk_key in self.chunks:
-            chunk_x, chunk_y = chunk_key
+        Args:
+            chunk_format (int): One of the CHUNK_FORMAT_* constants
             
-            # Calculate Manhattan distance
-            dx = abs(chunk_x - center_chunk_x)
-            dy = abs(chunk_y - center_chunk_y)
-            distance = dx + dy
+        Returns:
+            int: The format actually selected
+        """
+        return _lib.terrain_set_chunk_format(self._terrain, chunk_format)
+    
+    def set_cache_budget(self, budget_bytes):
+        """
+        Limit the memory used by cached chunks.
+        
+        When the budget is exceeded, unpinned chunks are evicted according to
+        the cache policy. Chunks still referenced by numpy views stay alive
+        until the views are collected.
+        
+        Args:
+            budget_bytes (int): Budget in bytes (0 for unlimited)
+        """
+        _lib.terrain_set_cache_budget(self._terrain, int(budget_bytes))
+    
+    def set_huge_pages(self, enabled):
+        """
+        Back chunk cells with huge pages where the system provides them.
+        
+        Chunk cells come from a pool of recycled, cache-line aligned buffers
+        in 2 MiB slabs; with huge pages each slab is one TLB entry. Chunks
+        built afterwards use the new setting.
+        
+        Args:
+            enabled (bool): Request huge pages
+        """
+        _lib.terrain_set_huge_pages(self._terrain, 1 if enabled else 0)
+    
+    def set_chunk_layout(self, layout):
+        """
+        Select how cells are arranged inside cached float32 chunks.
+        
+        Blocked layouts keep the neighbours of a cell within a few cache
+        lines, which suits searches and stencils that move in every
+        direction. Only linear chunks can be shared with numpy without a
+        copy. Drops every cached chunk; a layout the chunk size cannot use
+        falls back to linear.
+        
+        Args:
+            layout (int): One of the CHUNK_LAYOUT_* constants
             
-            if distance > max_view_radius:
-                chunks_to_remove.append(chunk_key)
+        Returns:
+            int: The layout actually selected
+        """
+        return _lib.terrain_set_chunk_layout(self._terrain, layout)
+    
+    def set_cache_policy(self, policy):
+        """
+        Select the chunk cache eviction policy.
+        
+        Args:
+            policy (int): CACHE_POLICY_LRU or CACHE_POLICY_CLOCK
+        """
+        _lib.terrain_set_cache_policy(self._terrain, policy)
+    
+    def pin_chunks(self, chunk_coords):
+        """
+        Pin chunks so the cache budget never evicts them.
+        
+        Replaces the previously pinned set; pass an empty list to unpin all.
+        
+        Args:
+            chunk_coords (list): List of chunk coordinates (chunk_x, chunk_y)
+        """
+        coords = np.ascontiguousarray(chunk_coords, dtype=np.int32).reshape(-1)
+        _lib.terrain_pin_chunks(self._terrain, coords.ctypes.data_as(POINTER(c_int)), len(coords) // 2)
+    
+    def get_cache_stats(self):
+        """
+        Get chunk cache counters.
         
-        # Remove chunks
-        for chunk_key in chunks_to_remove:
-            del self.chunks[chunk_key]
+        Returns:
+            dict: hits, misses, evictions, bytes_resident, chunks_resident
+                and byte_budget
+        """
+        stats = CacheStats()
+        _lib.terrain_get_cache_stats(self._terrain, byref(stats))
+        return {name: getattr(stats, name) for name, _ in CacheStats._fields_}
+    
+    def get_stats(self):
+        """
+        Get cumulative generation, cache and pathfinding counters.
+        
+        Diff successive snapshots for rates. All counts are zero and enabled
+        is False if the library was built with TERRAIN_STATS=0.
+        
+        Returns:
+            dict: enabled, chunk_generations, chunk_generation_ns,
+                noise_evaluations, cache_hits, cache_misses, evictions,
+                bytes_resident, chunks_resident, path_searches,
+                path_expansions and path_ns, plus chunk_latency and
+                path_latency histograms as lists of STATS_HISTOGRAM_BUCKETS
+                counts; pool_bytes, pool_buffers_free and pool_huge_pages
+                describe the chunk buffer pool and are reported either way
+        """
+        stats = TerrainStats()
+        _lib.terrain_get_stats(self._terrain, byref(stats))
+        result = {name: getattr(stats, name) for name, _ in TerrainStats._fields_}
+        result['enabled'] = bool(stats.enabled)
+        result['chunk_latency'] = list(stats.chunk_latency)
+        result['path_latency'] = list(stats.path_latency)
+        result['pool_huge_pages'] = bool(stats.pool_huge_pages)
+        return result
     
     def clear_chunks(self):
         """Clear all generated chunks from memory."""
         _lib.terrain_clear_chunks(self._terrain)
-        self.chunks.clear() 
\ No newline at end of file
+    
+    def find_path(self, start, goal, elevation_weight=1.5, max_iterations=0,
+                  algorithm=PATH_ALGORITHM_ASTAR, jump_tolerance=0.0):
+        """
+        Find a path between two positions using a native pathfinder.
+        
+        Args:
+            start (tuple): Start position (x, y)
+            goal (tuple): Goal position (x, y)
+            elevation_weight (float): Weight factor for elevation differences
+            max_iterations (int): Maximum number of node expansions (0 for unlimited);
+                for PATH_ALGORITHM_HIERARCHICAL, abstract node expansions
+            algorithm (int): One of the PATH_ALGORITHM_* constants
+            jump_tolerance (float): For PATH_ALGORITHM_JUMP_POINT, largest elevation
+                cost per step still treated as flat; 0 keeps paths optimal
+            
+        Returns:
+            list: List of positions forming the path, or None if no path is found
+        """
+        # Every point of an A* path except the goal was expanded, so a capped
+        # search can never return more than max_iterations + 1 points
+        if algorithm == PATH_ALGORITHM_ASTAR and max_iterations > 0:
+            buffer_len = max_iterations + 1
+        else:
+            buffer_len = 4096
+        while True:
+            buffer = (c_int * (2 * buffer_len))()
+            if algorithm == PATH_ALGORITHM_JUMP_POINT:
+                path_len = _lib.terrain_find_path_jps(
+                    self._terrain,
+                    int(start[0]), int(start[1]),
+                    int(goal[0]), int(goal[1]),
+                    c_double(elevation_weight),
+                    c_double(jump_tolerance),
+                    int(max_iterations),
+                    buffer,
+                    buffer_len
+                )
+            else:
+                path_len = _lib.terrain_find_path_with(
+                    self._terrain,
+                    algorithm,
+                    int(start[0]), int(start[1]),
+                    int(goal[0]), int(goal[1]),
+                    c_double(elevation_weight),
+                    int(max_iterations),
+                    buffer,
+                    buffer_len
+                )
+            
+            if path_len == 0:
+                return None
+            
+            # Retry with a buffer large enough for the whole path
+            if path_len > buffer_len:
+                buffer_len = path_len
+                continue
+            
+            return [(buffer[2 * i], buffer[2 * i + 1]) for i in range(path_len)]
+    
+    def find_path_anytime(self, start, goal, elevation_weight=1.5, epsilon=(10.0, 1.0, 3.0),
+                          deadline_ms=0, max_iterations=0):
+        """
+        Find a path with weighted A* / ARA*, improving it until a deadline.
+        
+        The first search inflates the heuristic by the initial epsilon and
+        finds a path quickly; later searches lower epsilon by the step,
+        reusing earlier work, until the final epsilon or the deadline.
+        
+        Args:
+            start (tuple): Start position (x, y)
+            goal (tuple): Goal position (x, y)
+            elevation_weight (float): Weight factor for elevation differences
+            epsilon (float or tuple): Inflation for plain weighted A*, or an
+                (initial, final, step) schedule
+            deadline_ms (float): Wall-clock budget; 0 for none. The first path
+                is always completed.
+            max_iterations (int): Maximum node expansions over all searches (0 for unlimited)
+            
+        Returns:
+            tuple: (path, bound) where path is a list of positions or None and
+                bound is how many times optimal its cost can be at most
+        """
+        schedule = _anytime_schedule(epsilon, deadline_ms)
+        bound = c_double(0.0)
+        buffer_len = 4096
+        while True:
+            buffer = (c_int * (2 * buffer_len))()
+            path_len = _lib.terrain_find_path_anytime(
+                self._terrain,
+                int(start[0]), int(start[1]),
+                int(goal[0]), int(goal[1]),
+                c_double(elevation_weight),
+                byref(schedule),
+                int(max_iterations),
+                buffer,
+                buffer_len,
+                byref(bound)
+            )
+            
+            if path_len == 0:
+                return None, bound.value
+            
+            # Retry with a buffer large enough for the whole path
+            if path_len > buffer_len:
+                buffer_len = path_len
+                continue
+            
+            return [(buffer[2 * i], buffer[2 * i + 1]) for i in range(path_len)], bound.value
+    
+    def find_paths(self, queries, elevation_weight=1.5, max_iterations=0,
+                   algorithm=PATH_ALGORITHM_ASTAR, share_goals=False, jump_tolerance=0.0):
+        """
+        Answer many path queries concurrently on the worker pool.
+        
+        Args:
+            queries (list): (start, goal) position pairs
+            elevation_weight (float): Weight factor for elevation differences
+            max_iterations (int): Maximum number of node expansions per query (0 for unlimited)
+            algorithm (int): One of the PATH_ALGORITHM_* constants
+            share_goals (bool): Answer A* queries with the same goal from one
+                backward Dijkstra search, giving exact shortest paths
+            jump_tolerance (float): For PATH_ALGORITHM_JUMP_POINT, largest elevation
+                cost per step still treated as flat; 0 keeps paths optimal
+            
+        Returns:
+            list: One dict per query with keys path (list of positions, or
+            None), cost, expansions, latency_ms and shared_field
+        """
+        n = len(queries)
+        if n == 0:
+            return []
+        
+        query_array = (PathQuery * n)()
+        result_array = (PathResult * n)()
+        buffer_len = 4096
+        buffers = []
+        for i, (start, goal) in enumerate(queries):
+            query_array[i] = PathQuery(int(start[0]), int(start[1]), int(goal[0]), int(goal[1]),
+                                       int(algorithm), float(elevation_weight), int(max_iterations),
+                                       float(jump_tolerance))
+            buffer = (c_int * (2 * buffer_len))()
+            buffers.append(buffer)
+            result_array[i].path = ctypes.cast(buffer, POINTER(c_int))
+            result_array[i].capacity = buffer_len
+        
+        _lib.terrain_find_paths(self._terrain, query_array, n, result_array, 1 if share_goals else 0)
+        
+        results = []
+        for i in range(n):
+            result = result_array[i]
+            if result.length == 0:
+                path = None
+            elif result.length > buffer_len:
+                # Rare very long path: search it again on its own
+                path = self.find_path(queries[i][0], queries[i][1], elevation_weight,
+                                      max_iterations, algorithm, jump_tolerance)
+            else:
+                buffer = buffers[i]
+                path = [(buffer[2 * j], buffer[2 * j + 1]) for j in range(result.length)]
+            results.append({
+                'path': path,
+                'cost': result.cost,
+                'expansions': result.expansions,
+                'latency_ms': result.latency_ms,
+                'shared_field': bool(result.shared_field),
+            })
+        return results
+    
+    def create_replanner(self, goal, elevation_weight=1.5):
+        """
+        Create an incremental (D* Lite) planner towards a goal.
+        
+        Args:
+            goal (tuple): Goal position (x, y)
+            elevation_weight (float): Weight factor for elevation differences
+            
+        Returns:
+            Replanner: Planner that reuses its search between calls
+        """
+        return Replanner(self, goal, elevation_weight)
+    
+    def create_planner(self):
+        """
+        Create a planner that searches on its own thread.
+        
+        Returns:
+            AsyncPlanner: Planner whose searches never block the caller
+        """
+        return AsyncPlanner(self)
+    
+    def notify_cells_changed(self, x0, y0, width, height):
+        """
+        Record that cells changed without going through set_elevation, so that
+        every replanner repairs them on its next replan.
+        
+        Args:
+            x0 (int): Left edge of the changed rectangle
+            y0 (int): Top edge of the changed rectangle
+            width (int): Width in cells
+            height (int): Height in cells
+        """
+        _lib.terrain_notify_cells_changed(self._terrain, int(x0), int(y0), int(width), int(height))
+
+
+class Replanner:
+    """
+    Incremental path planner that keeps its search state between calls.
+    
+    Replanning after the start moves, or after cells change through
+    set_elevation, notify_cells_changed or a regenerated chunk, only repairs
+    the affected part of the previous search.
+    """
+    
+    def __init__(self, terrain, goal, elevation_weight=1.5):
+        """
+        Args:
+            terrain (TerrainGenerator): Terrain to plan over; kept alive by the planner
+            goal (tuple): Goal position (x, y)
+            elevation_weight (float): Weight factor for elevation differences
+        """
+        self.terrain = terrain
+        self.goal = (int(goal[0]), int(goal[1]))
+        self.elevation_weight = elevation_weight
+        self._replanner = _lib.terrain_replanner_create(
+            terrain._terrain, self.goal[0], self.goal[1], c_double(elevation_weight))
+        self._buffer_len = 4096
+        self._buffer = (c_int * (2 * self._buffer_len))()
+    
+    def __del__(self):
+        """Clean up resources when object is destroyed."""
+        if hasattr(self, '_replanner') and self._replanner:
+            _lib.terrain_replanner_destroy(self._replanner)
+            self._replanner = None
+    
+    def set_goal(self, goal):
+        """Plan towards a new goal, discarding the previous search."""
+        self.goal = (int(goal[0]), int(goal[1]))
+        _lib.terrain_replanner_set_goal(self._replanner, self.goal[0], self.goal[1])
+    
+    def replan(self, start, max_iterations=0):
+        """
+        Find a path from start to the goal, repairing the previous search.
+        
+        Args:
+            start (tuple): Current position (x, y)
+            max_iterations (int): Maximum number of cells expanded by this call
+                (0 for unlimited); an unfinished search resumes on the next call
+            
+        Returns:
+            list: List of positions forming the path, or None if no path is
+                found yet (see searching)
+        """
+        while True:
+            path_len = _lib.terrain_replanner_replan(
+                self._replanner, int(start[0]), int(start[1]), int(max_iterations),
+                self._buffer, self._buffer_len)
+            
+            if path_len == 0:
+                return None
+            
+            # Grow the buffer and ask again; the repeat replan is nearly free
+            if path_len > self._buffer_len:
+                self._buffer_len = path_len
+                self._buffer = (c_int * (2 * self._buffer_len))()
+                continue
+            
+            return [(self._buffer[2 * i], self._buffer[2 * i + 1]) for i in range(path_len)]
+    
+    def notify_cells_changed(self, x0, y0, width, height):
+        """Tell this planner alone that cells in a rectangle changed."""
+        _lib.terrain_replanner_notify_cells_changed(
+            self._replanner, int(x0), int(y0), int(width), int(height))
+    
+    @property
+    def last_expansions(self):
+        """Cells expanded by the last replan."""
+        return _lib.terrain_replanner_expansions(self._replanner)
+    
+    @property
+    def searching(self):
+        """Whether the last replan ran out of max_iterations before finding a path."""
+        return bool(_lib.terrain_replanner_searching(self._replanner))
+
+
+class AsyncPlanner:
+    """
+    Path planner that searches on a dedicated native thread.
+    
+    Plans run one at a time in submission order. Polling a running A* plan
+    returns its best partial path so far, so a rover can start moving before
+    the search finishes; other algorithms only report their final path.
+    """
+    
+    def __init__(self, terrain):
+        """
+        Args:
+            terrain (TerrainGenerator): Terrain to plan over; kept alive by the planner
+        """
+        self.terrain = terrain
+        self._planner = _lib.terrain_planner_create(terrain._terrain)
+        self._buffer_len = 4096
+        self._buffer = (c_int * (2 * self._buffer_len))()
+    
+    def __del__(self):
+        """Stop any running plan and release the planner thread."""
+        if hasattr(self, '_planner') and self._planner:
+            _lib.terrain_planner_destroy(self._planner)
+            self._planner = None
+    
+    def submit(self, start, goal, elevation_weight=1.5, max_iterations=0,
+               algorithm=PATH_ALGORITHM_ASTAR, jump_tolerance=0.0):
+        """
+        Queue a path search and return without waiting for it.
+        
+        Args:
+            start (tuple): Start position (x, y)
+            goal (tuple): Goal position (x, y)
+            elevation_weight (float): Weight factor for elevation differences
+            max_iterations (int): As for TerrainGenerator.find_path
+            algorithm (int): One of the PATH_ALGORITHM_* constants
+            jump_tolerance (float): As for TerrainGenerator.find_path
+            
+        Returns:
+            int: Ticket for poll and cancel
+        """
+        return _lib.terrain_plan_async(
+            self._planner, algorithm,
+            int(start[0]), int(start[1]), int(goal[0]), int(goal[1]),
+            c_double(elevation_weight), c_double(jump_tolerance), int(max_iterations))
+    
+    def submit_anytime(self, start, goal, elevation_weight=1.5, epsilon=(10.0, 1.0, 3.0),
+                       deadline_ms=0, max_iterations=0):
+        """
+        Queue a weighted A* / ARA* search; see TerrainGenerator.find_path_anytime.
+        
+        Each improved path can be polled as soon as it is found, and the
+        deadline counts from when the planner thread starts the search.
+        
+        Returns:
+            int: Ticket for poll and cancel
+        """
+        schedule = _anytime_schedule(epsilon, deadline_ms)
+        return _lib.terrain_plan_anytime_async(
+            self._planner,
+            int(start[0]), int(start[1]), int(goal[0]), int(goal[1]),
+            c_double(elevation_weight), byref(schedule), int(max_iterations))
+    
+    def submit_replan(self, start, goal, elevation_weight=1.5, max_iterations=0):
+        """
+        Queue a D* Lite replan; see Replanner.replan.
+        
+        The planner thread keeps one replanner, so replans towards the same
+        goal with the same weight repair the previous one's search, and a
+        replan cancelled or out of max_iterations resumes in the next one.
+        Only the final path is reported.
+        
+        Returns:
+            int: Ticket for poll and cancel
+        """
+        return _lib.terrain_plan_replan_async(
+            self._planner,
+            int(start[0]), int(start[1]), int(goal[0]), int(goal[1]),
+            c_double(elevation_weight), int(max_iterations))
+    
+    def poll(self, ticket):
+        """
+        Get a plan's state and current path.
+        
+        Args:
+            ticket (int): Ticket returned by submit
+            
+        Returns:
+            tuple: (status, path) where status is one of the PLAN_STATUS_*
+                constants and path is the final path once done, the best
+                partial path while running, or None
+        """
+        status, path, _ = self.poll_with_bound(ticket)
+        return status, path
+    
+    def poll_with_bound(self, ticket):
+        """
+        Get a plan's state, current path and that path's suboptimality bound.
+        
+        Args:
+            ticket (int): Ticket returned by submit or submit_anytime
+            
+        Returns:
+            tuple: (status, path, bound) as for poll; bound is how many times
+                optimal the path's cost can be at most for anytime plans,
+                infinite while only a partial path is known, and 0 for plans
+                that do not track one
+        """
+        status = c_int(PLAN_STATUS_UNKNOWN)
+        bound = c_double(0.0)
+        while True:
+            path_len = _lib.terrain_plan_poll_bound(self._planner, ticket, byref(status), byref(bound),
+                                                    self._buffer, self._buffer_len)
+            if path_len <= self._buffer_len:
+                break
+            
+            # Grow the buffer and ask again
+            self._buffer_len = path_len
+            self._buffer = (c_int * (2 * self._buffer_len))()
+        
+        if path_len == 0:
+            return status.value, None, bound.value
+        path = [(self._buffer[2 * i], self._buffer[2 * i + 1]) for i in range(path_len)]
+        return status.value, path, bound.value
+    
+    def cancel(self, ticket):
+        """Stop a plan if it is still searching and release its result."""
+        _lib.terrain_plan_cancel(self._planner, ticket)